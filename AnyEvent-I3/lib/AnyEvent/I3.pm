@@ -101,12 +101,16 @@ use constant TYPE_GET_CONFIG => 9;
 use constant TYPE_SEND_TICK => 10;
 use constant TYPE_SYNC => 11;
 use constant TYPE_GET_BINDING_STATE => 12;
+use constant TYPE_GET_TRACE => 13;
+use constant TYPE_GET_LATENCY => 14;
+use constant TYPE_RUN_TRANSACTION => 15;
 
 our %EXPORT_TAGS = ( 'all' => [
     qw(i3 TYPE_RUN_COMMAND TYPE_COMMAND TYPE_GET_WORKSPACES TYPE_SUBSCRIBE TYPE_GET_OUTPUTS
        TYPE_GET_TREE TYPE_GET_MARKS TYPE_GET_BAR_CONFIG TYPE_GET_VERSION
        TYPE_GET_BINDING_MODES TYPE_GET_CONFIG TYPE_SEND_TICK TYPE_SYNC
-       TYPE_GET_BINDING_STATE)
+       TYPE_GET_BINDING_STATE TYPE_GET_TRACE TYPE_GET_LATENCY
+       TYPE_RUN_TRANSACTION)
 ] );
 
 our @EXPORT_OK = ( @{ $EXPORT_TAGS{all} } );
@@ -124,6 +128,7 @@ my %events = (
     binding => ($event_mask | 5),
     shutdown => ($event_mask | 6),
     tick => ($event_mask | 7),
+    tree_delta => ($event_mask | 8),
     _error => 0xFFFFFFFF,
 );
 
@@ -256,7 +261,7 @@ sub _handle_i3_message {
     delete $self->{callbacks}->{$type};
 }
 
-=head2 $i3->subscribe(\%callbacks)
+=head2 $i3->subscribe(\%callbacks, [ \%filters ])
 
 Subscribes to the given event types. This function awaits a hashref with the
 key being the name of the event and the value being a callback.
@@ -283,9 +288,19 @@ use it to print an appropriate message and exit cleanly or to try to reconnect.
 
     $i3->subscribe(\%callbacks)->recv;
 
+The optional second hashref contains filters for some of the event types, so
+that i3 only sends matching events (see the SUBSCRIBE message in the IPC
+documentation):
+
+    $i3->subscribe(
+        { window => sub { say "Firefox got focused" } },
+        { window => { change => [ 'focus' ], criteria => { class => '^Firefox$' } } }
+    )->recv;
+
 =cut
 sub subscribe {
-    my ($self, $callbacks) = @_;
+    my ($self, $callbacks, $filters) = @_;
+    $filters //= {};
 
     # Register callbacks for each message type
     for my $key (keys %{$callbacks}) {
@@ -298,7 +313,11 @@ sub subscribe {
         $self->{callbacks}->{$type} = $callbacks->{$key};
     }
 
-    $self->message(TYPE_SUBSCRIBE, [ keys %{$callbacks} ])
+    my @payload = map {
+        exists $filters->{$_} ? { event => $_, %{$filters->{$_}} } : $_
+    } keys %{$callbacks};
+
+    $self->message(TYPE_SUBSCRIBE, \@payload)
 }
 
 =head2 $i3->message($type, $content)
@@ -394,20 +413,24 @@ sub get_outputs {
     $self->message(TYPE_GET_OUTPUTS)
 }
 
-=head2 get_tree
+=head2 get_tree([ \%request ])
 
-Gets the layout tree from i3 (>= v4.0).
+Gets the layout tree from i3 (>= v4.0). The optional request selects the
+containers, the maximum depth and the fields to get (see the GET_TREE message
+in the IPC documentation).
 
     my $tree = i3->get_tree->recv;
     say Dumper($tree);
 
+    my $names = i3->get_tree({ max_depth => 2, fields => [ 'id', 'name' ] })->recv;
+
 =cut
 sub get_tree {
-    my ($self) = @_;
+    my ($self, $request) = @_;
 
     $self->_ensure_connection;
 
-    $self->message(TYPE_GET_TREE)
+    $self->message(TYPE_GET_TREE, $request)
 }
 
 =head2 get_marks
@@ -545,6 +568,23 @@ sub command {
     $self->message(TYPE_RUN_COMMAND, $content)
 }
 
+=head2 transaction(\@commands)
+
+Makes i3 execute the given commands as one transaction, rendering the layout
+only once afterwards. The reply contains the reply of each command.
+
+    my $replies = i3->transaction([ "workspace 2", "layout tabbed" ])->recv;
+    die "command failed" unless $replies->[1]->[0]->{success};
+
+=cut
+sub transaction {
+    my ($self, $commands) = @_;
+
+    $self->_ensure_connection;
+
+    $self->message(TYPE_RUN_TRANSACTION, $commands)
+}
+
 =head1 AUTHOR
 
 Michael Stapelberg, C<< <michael at i3wm.org> >>
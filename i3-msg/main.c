@@ -17,8 +17,11 @@
 #include "libi3.h"
 
 #include <err.h>
+#include <errno.h>
 #include <getopt.h>
 #include "ipc2.h"
+#include <inttypes.h>
+#include <poll.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -147,6 +150,156 @@ static yajl_callbacks config_callbacks = {
     .yajl_end_map = config_end_map_cb,
 };
 
+/*
+ * Checks the reply to a RUN_COMMAND message and prints the errors of failed
+ * commands to stderr.
+ *
+ */
+static void check_command_reply(const uint8_t *reply, uint32_t reply_length) {
+    yajl_handle handle = yajl_alloc(&reply_callbacks, NULL, NULL);
+    yajl_status state = yajl_parse(handle, (const unsigned char *)reply, reply_length);
+    yajl_free(handle);
+
+    switch (state) {
+        case yajl_status_ok:
+            break;
+        case yajl_status_client_canceled:
+        case yajl_status_error:
+            errx(EXIT_FAILURE, "IPC: Could not parse JSON reply.");
+    }
+}
+
+/*
+ * Appends a message (header and payload) to the given buffer, so that several
+ * messages can be sent with a single write().
+ *
+ */
+static void append_message(uint8_t **buffer, size_t *length, size_t *size,
+                           uint32_t message_type, const char *payload, uint32_t payload_length) {
+    const i3_ipc_header_t header = {
+        .magic = {'i', '3', '-', 'i', 'p', 'c'},
+        .size = payload_length,
+        .type = message_type};
+    const size_t needed = *length + sizeof(i3_ipc_header_t) + payload_length;
+    if (needed > *size) {
+        while (needed > *size) {
+            *size = (*size == 0 ? 4096 : *size * 2);
+        }
+        *buffer = srealloc(*buffer, *size);
+    }
+    memcpy(*buffer + *length, &header, sizeof(i3_ipc_header_t));
+    memcpy(*buffer + *length + sizeof(i3_ipc_header_t), payload, payload_length);
+    *length = needed;
+}
+
+/*
+ * Sends every line read from stdin as a message of the given type and prints
+ * the replies, one per line, in the same order. Messages are sent as soon as
+ * they are read, without waiting for the replies to the previous ones.
+ *
+ */
+static void run_stdin_messages(int sockfd, uint32_t message_type, bool quiet, bool raw_reply) {
+    ipc_reader_t *reader = ipc_reader_new(sockfd);
+
+    char *input = NULL;
+    size_t input_length = 0;
+    size_t input_size = 0;
+    bool input_eof = false;
+
+    uint8_t *output = NULL;
+    size_t output_length = 0;
+    size_t output_size = 0;
+
+    /* Number of messages whose reply was not received yet. */
+    uint64_t pending = 0;
+
+    while (!input_eof || pending > 0) {
+        struct pollfd fds[2] = {
+            {.fd = sockfd, .events = POLLIN},
+            {.fd = STDIN_FILENO, .events = POLLIN}};
+        if (poll(fds, (input_eof ? 1 : 2), -1) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            err(EXIT_FAILURE, "poll()");
+        }
+
+        if (!input_eof && fds[1].revents != 0) {
+            if (input_size - input_length < 4096) {
+                input_size = (input_size == 0 ? 65536 : input_size * 2);
+                input = srealloc(input, input_size);
+            }
+            const ssize_t n = read(STDIN_FILENO, input + input_length, input_size - input_length);
+            if (n == -1 && errno != EINTR && errno != EAGAIN) {
+                err(EXIT_FAILURE, "read(stdin)");
+            }
+            if (n == 0) {
+                input_eof = true;
+                /* The last line does not need to be terminated. */
+                if (input_length > 0) {
+                    input[input_length++] = '\n';
+                }
+            } else if (n > 0) {
+                input_length += n;
+            }
+
+            char *line = input;
+            char *newline;
+            while ((newline = memchr(line, '\n', input_length - (line - input))) != NULL) {
+                append_message(&output, &output_length, &output_size,
+                               message_type, line, newline - line);
+                pending++;
+                line = newline + 1;
+            }
+            input_length -= (line - input);
+            memmove(input, line, input_length);
+
+            if (output_length > 0) {
+                if (writeall(sockfd, output, output_length) == -1) {
+                    err(EXIT_FAILURE, "IPC: write()");
+                }
+                output_length = 0;
+            }
+        }
+
+        if (fds[0].revents != 0) {
+            const ssize_t n = ipc_reader_fill(reader);
+            if (n == -1) {
+                err(EXIT_FAILURE, "IPC: read()");
+            }
+
+            uint32_t reply_type;
+            uint32_t reply_length;
+            const uint8_t *reply;
+            int ret;
+            while ((ret = ipc_reader_next(reader, &reply_type, &reply_length, &reply)) == 1) {
+                if (reply_type != message_type) {
+                    errx(EXIT_FAILURE, "IPC: Received reply of type %d but expected %d", reply_type, message_type);
+                }
+                if ((reply_type == I3_IPC_REPLY_TYPE_COMMAND || reply_type == I3_IPC_REPLY_TYPE_TRANSACTION) && !raw_reply) {
+                    check_command_reply(reply, reply_length);
+                }
+                if (!quiet) {
+                    printf("%.*s\n", reply_length, reply);
+                }
+                pending--;
+            }
+            if (ret < 0) {
+                exit(1);
+            }
+            fflush(stdout);
+
+            if (n == -2 && (pending > 0 || !input_eof)) {
+                errx(EXIT_FAILURE, "IPC: unexpected EOF, %" PRIu64 " replies missing", pending);
+            }
+        }
+    }
+
+    free(input);
+    free(output);
+    ipc_reader_free(reader);
+}
+
 int main(int argc, char *argv[]) {
     char *socket_path = NULL;
     int o, option_index = 0;
@@ -155,6 +308,7 @@ int main(int argc, char *argv[]) {
     bool quiet = false;
     bool monitor = false;
     bool raw_reply = false;
+    bool from_stdin = false;
 
     static struct option long_options[] = {
         {"socket", required_argument, 0, 's'},
@@ -164,9 +318,10 @@ int main(int argc, char *argv[]) {
         {"monitor", no_argument, 0, 'm'},
         {"help", no_argument, 0, 'h'},
         {"raw", no_argument, 0, 'r'},
+        {"stdin", no_argument, 0, 'i'},
         {0, 0, 0, 0}};
 
-    char *options_string = "s:t:vhqmr";
+    char *options_string = "s:t:vhqmri";
 
     while ((o = getopt_long(argc, argv, options_string, long_options, &option_index)) != -1) {
         if (o == 's') {
@@ -177,6 +332,8 @@ int main(int argc, char *argv[]) {
                 message_type = I3_IPC_MESSAGE_TYPE_RUN_COMMAND;
             } else if (strcasecmp(optarg, "run_command") == 0) {
                 message_type = I3_IPC_MESSAGE_TYPE_RUN_COMMAND;
+            } else if (strcasecmp(optarg, "run_transaction") == 0) {
+                message_type = I3_IPC_MESSAGE_TYPE_RUN_TRANSACTION;
             } else if (strcasecmp(optarg, "get_workspaces") == 0) {
                 message_type = I3_IPC_MESSAGE_TYPE_GET_WORKSPACES;
             } else if (strcasecmp(optarg, "get_outputs") == 0) {
@@ -199,9 +356,13 @@ int main(int argc, char *argv[]) {
                 message_type = I3_IPC_MESSAGE_TYPE_SEND_TICK;
             } else if (strcasecmp(optarg, "subscribe") == 0) {
                 message_type = I3_IPC_MESSAGE_TYPE_SUBSCRIBE;
+            } else if (strcasecmp(optarg, "get_trace") == 0) {
+                message_type = I3_IPC_MESSAGE_TYPE_GET_TRACE;
+            } else if (strcasecmp(optarg, "get_latency") == 0) {
+                message_type = I3_IPC_MESSAGE_TYPE_GET_LATENCY;
             } else {
                 printf("Unknown message type\n");
-                printf("Known types: run_command, get_workspaces, get_outputs, get_tree, get_marks, get_bar_config, get_binding_modes, get_binding_state, get_version, get_config, send_tick, subscribe\n");
+                printf("Known types: run_command, run_transaction, get_workspaces, get_outputs, get_tree, get_marks, get_bar_config, get_binding_modes, get_binding_state, get_version, get_config, send_tick, subscribe, get_trace, get_latency\n");
                 exit(EXIT_FAILURE);
             }
         } else if (o == 'q') {
@@ -214,11 +375,14 @@ int main(int argc, char *argv[]) {
         } else if (o == 'h') {
             printf("i3-msg " I3_VERSION "\n");
             printf("i3-msg [-s <socket>] [-t <type>] [-m] <message>\n");
+            printf("i3-msg [-s <socket>] [-t <type>] --stdin\n");
             return 0;
         } else if (o == '?') {
             exit(EXIT_FAILURE);
         } else if (o == 'r') {
             raw_reply = true;
+        } else if (o == 'i') {
+            from_stdin = true;
         }
     }
 
@@ -227,6 +391,22 @@ int main(int argc, char *argv[]) {
         exit(EXIT_FAILURE);
     }
 
+    if (from_stdin) {
+        if (message_type == I3_IPC_MESSAGE_TYPE_SUBSCRIBE) {
+            fprintf(stderr, "The --stdin option cannot be used with -t SUBSCRIBE.\n");
+            exit(EXIT_FAILURE);
+        }
+        if (optind < argc) {
+            fprintf(stderr, "With --stdin, the messages are read from stdin only.\n");
+            exit(EXIT_FAILURE);
+        }
+
+        int sockfd = ipc_connect(socket_path);
+        run_stdin_messages(sockfd, message_type, quiet, raw_reply);
+        close(sockfd);
+        return exit_code;
+    }
+
     /* Use all arguments, separated by whitespace, as payload.
      * This way, you don’t have to do i3-msg 'mark foo', you can use
      * i3-msg mark foo */
@@ -267,19 +447,9 @@ int main(int argc, char *argv[]) {
     }
     /* For the reply of commands, have a look if that command was successful.
      * If not, nicely format the error message. */
-    if (reply_type == I3_IPC_REPLY_TYPE_COMMAND) {
+    if (reply_type == I3_IPC_REPLY_TYPE_COMMAND || reply_type == I3_IPC_REPLY_TYPE_TRANSACTION) {
         if (!raw_reply) {
-            yajl_handle handle = yajl_alloc(&reply_callbacks, NULL, NULL);
-            yajl_status state = yajl_parse(handle, (const unsigned char *)reply, reply_length);
-            yajl_free(handle);
-
-            switch (state) {
-                case yajl_status_ok:
-                    break;
-                case yajl_status_client_canceled:
-                case yajl_status_error:
-                    errx(EXIT_FAILURE, "IPC: Could not parse JSON reply.");
-            }
+            check_command_reply(reply, reply_length);
         }
 
         if (!quiet || raw_reply) {
@@ -41,6 +41,12 @@ typedef struct {
     bool click_events;
     bool click_events_init;
 
+    /**
+     * The statuslines are sent through the SHM segment (see shmstatus.h),
+     * the pipe only rings the doorbell.
+     */
+    bool shm_status;
+
     /**
      * stdin- and SIGCHLD-watchers
      */
@@ -60,6 +66,13 @@ typedef struct {
  */
 void clear_statusline(struct statusline_head *head, bool free_resources);
 
+/*
+ * Makes the next statusline rebuild all of its blocks instead of keeping the
+ * unchanged ones. Needs to be called when the font or the separator changed.
+ *
+ */
+void invalidate_status_blocks(void);
+
 /*
  * Start a child process with the specified command and reroute stdin.
  * We actually start a shell to execute the command so we don't have to care
@@ -80,6 +80,13 @@ struct status_block {
     char *name;
     char *instance;
 
+    /* The keys and values the block was built from (see child.c), used to
+     * keep the block when the next statusline contains it unchanged. */
+    char *raw;
+    size_t raw_len;
+    size_t raw_size;
+    uint32_t raw_hash;
+
     TAILQ_ENTRY(status_block) blocks;
 };
 
@@ -95,3 +102,4 @@ extern TAILQ_HEAD(statusline_head, status_block) statusline_head;
 #include "xcb.h"
 #include "configuration.h"
 #include "parse_json_header.h"
+#include "status_segment.h"
@@ -58,8 +58,12 @@ typedef struct config_t {
     bool disable_binding_mode_indicator;
     bool disable_ws;
     int ws_min_width;
+    int status_redraw_interval;
     bool strip_ws_numbers;
     bool strip_ws_name;
+    bool gradients;
+    bool dithering;
+    double dither_noise;
     char *bar_id;
     char *command;
     char *workspace_command;
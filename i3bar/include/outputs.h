@@ -65,6 +65,16 @@ struct i3_output {
     surface_t statusline_buffer;
     /* How much of statusline_buffer's horizontal space was used on last statusline render. */
     int statusline_width;
+    /* What the last statusline render drew to statusline_buffer, so that only
+     * the blocks which changed are drawn again. statusline_drawn is false if
+     * the buffer has to be drawn from scratch. */
+    bool statusline_drawn;
+    bool drawn_focus_colors;
+    uint32_t drawn_clip_left;
+    int drawn_x_dest;
+    struct drawn_block* drawn_blocks;
+    int num_drawn_blocks;
+    int drawn_blocks_size;
     /* The actual window on which we draw. */
     surface_t bar;
 
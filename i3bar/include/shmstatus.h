@@ -0,0 +1,114 @@
+/*
+ * vim:ts=4:sw=4:expandtab
+ *
+ * i3bar - an xcb-based status- and ws-bar for i3
+ * © 2010 Axel Wagner and contributors (see also: LICENSE)
+ *
+ * The format of the shared memory segment through which status generators can
+ * send their statuslines instead of writing JSON (see "shm_status" in
+ * docs/i3bar-protocol).
+ *
+ */
+#pragma once
+
+#include <config.h>
+
+#include <stdint.h>
+
+/* "i3bs" in little endian */
+#define I3BAR_SHMSTATUS_MAGIC 0x73623369
+#define I3BAR_SHMSTATUS_VERSION 1
+
+/* Number of statuslines in the ring and maximum number of blocks per
+ * statusline. */
+#define I3BAR_SHMSTATUS_SLOTS 4
+#define I3BAR_SHMSTATUS_MAX_BLOCKS 64
+
+/* Sizes of the text fields of a block, including the NUL byte. */
+#define I3BAR_SHMSTATUS_FULL_TEXT_SIZE 512
+#define I3BAR_SHMSTATUS_SHORT_TEXT_SIZE 128
+#define I3BAR_SHMSTATUS_NAME_SIZE 64
+
+/* Flags of i3bar_shmstatus_block */
+#define I3BAR_SHMSTATUS_URGENT (1 << 0)                /* "urgent": true */
+#define I3BAR_SHMSTATUS_NO_SEPARATOR (1 << 1)          /* "separator": false */
+#define I3BAR_SHMSTATUS_PANGO_MARKUP (1 << 2)          /* "markup": "pango" */
+#define I3BAR_SHMSTATUS_COLOR (1 << 3)                 /* color is set */
+#define I3BAR_SHMSTATUS_BACKGROUND (1 << 4)            /* background is set */
+#define I3BAR_SHMSTATUS_BORDER (1 << 5)                /* border is set */
+#define I3BAR_SHMSTATUS_SEPARATOR_BLOCK_WIDTH (1 << 6) /* separator_block_width is set */
+
+/**
+ * Header at the beginning of the shared memory segment. i3bar creates the
+ * segment and fills in everything but head, which belongs to the status
+ * generator.
+ *
+ */
+typedef struct i3bar_shmstatus_header {
+    uint32_t magic;
+    uint32_t version;
+
+    /* Layout of the segment, generators have to check these against the
+     * values they were compiled with. */
+    uint32_t num_slots;
+    uint32_t max_blocks;
+    uint32_t block_size;
+    uint32_t slot_size;
+    /* Byte offset of the first slot (an array of num_slots
+     * i3bar_shmstatus_slot). */
+    uint32_t slots_offset;
+
+    /* Number of statuslines published so far. The latest one is in slot
+     * (head - 1) % num_slots. The generator increments head (with release
+     * semantics) after writing the slot. */
+    uint32_t head;
+} i3bar_shmstatus_header;
+
+/**
+ * A block, with the same meaning as the keys of the same name in the JSON
+ * protocol. Strings are NUL-terminated UTF-8 and empty strings count as not
+ * set (except for full_text).
+ *
+ */
+typedef struct i3bar_shmstatus_block {
+    /* I3BAR_SHMSTATUS_* flags */
+    uint32_t flags;
+    /* 0 = left, 1 = center, 2 = right */
+    uint32_t align;
+
+    /* Colors as 0xRRGGBBAA, only used if the corresponding flag is set. */
+    uint32_t color;
+    uint32_t background;
+    uint32_t border;
+
+    uint32_t min_width;
+    /* Only used if I3BAR_SHMSTATUS_SEPARATOR_BLOCK_WIDTH is set. */
+    uint32_t separator_block_width;
+
+    /* Used as they are, a generator which does not care should set them to 1
+     * (the default of the JSON protocol). */
+    uint32_t border_top;
+    uint32_t border_right;
+    uint32_t border_bottom;
+    uint32_t border_left;
+
+    char full_text[I3BAR_SHMSTATUS_FULL_TEXT_SIZE];
+    char short_text[I3BAR_SHMSTATUS_SHORT_TEXT_SIZE];
+    char name[I3BAR_SHMSTATUS_NAME_SIZE];
+    char instance[I3BAR_SHMSTATUS_NAME_SIZE];
+} i3bar_shmstatus_block;
+
+/**
+ * A statusline.
+ *
+ * Every slot is protected by a sequence lock: the generator makes sequence odd
+ * before it changes the slot and even again afterwards. i3bar loads sequence
+ * (with acquire semantics), skips the slot while it is odd, copies the blocks
+ * and checks that sequence is still the same afterwards.
+ *
+ */
+typedef struct i3bar_shmstatus_slot {
+    uint32_t sequence;
+    uint32_t num_blocks;
+    i3bar_shmstatus_block blocks[I3BAR_SHMSTATUS_MAX_BLOCKS];
+} i3bar_shmstatus_slot;
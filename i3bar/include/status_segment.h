@@ -0,0 +1,43 @@
+/*
+ * vim:ts=4:sw=4:expandtab
+ *
+ * i3bar - an xcb-based status- and ws-bar for i3
+ * © 2010 Axel Wagner and contributors (see also: LICENSE)
+ *
+ * status_segment.c: The shared memory segment through which the status
+ *                   command can send its statuslines (see shmstatus.h for
+ *                   the format).
+ *
+ */
+#pragma once
+
+#include <config.h>
+
+#include "shmstatus.h"
+
+/* The name of the SHM segment (/i3bar-status-%pid), or NULL if there is
+ * none. Passed to the status command in I3BAR_STATUS_SHM. */
+extern char *status_segment_path;
+
+/*
+ * Creates the SHM segment for the status command. On failure, the status
+ * command can only use the JSON protocol.
+ *
+ */
+void status_segment_open(void);
+
+/*
+ * Unmaps and removes the SHM segment.
+ *
+ */
+void status_segment_close(void);
+
+/*
+ * Copies the latest statusline out of the segment, if the status command
+ * published one since the last call. *blocks points to the copy, which is
+ * valid until the next call.
+ *
+ * Returns the number of blocks, -1 if there is no new statusline.
+ *
+ */
+int status_segment_read(const i3bar_shmstatus_block **blocks);
@@ -23,6 +23,15 @@ TAILQ_HEAD(ws_head, i3_ws);
  */
 void parse_workspaces_json(const unsigned char *json, size_t size);
 
+/*
+ * Applies a workspace event to the workspace lists, so that they don't have to
+ * be requested again. Returns false if the event could not be applied (e.g.
+ * because it refers to an unknown workspace), in which case the caller needs
+ * to request all workspaces.
+ *
+ */
+bool apply_workspace_event(const unsigned char *json, size_t size);
+
 /*
  * free() all workspace data structures
  *
@@ -47,6 +47,15 @@ struct xcb_color_strings_t {
     char *binding_mode_bg;
     char *binding_mode_fg;
     char *binding_mode_border;
+    char *gradient_start;
+    char *gradient_end;
+    char *focus_gradient_start;
+    char *focus_gradient_end;
+    char *active_ws_gradient;
+    char *inactive_ws_gradient;
+    char *focus_ws_gradient;
+    char *urgent_ws_gradient;
+    char *binding_mode_gradient;
 };
 
 typedef struct xcb_colors_t xcb_colors_t;
@@ -19,6 +19,7 @@
 #include <paths.h>
 #include <signal.h>
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -59,45 +60,124 @@ i3bar_child ws_child = {0};
 yajl_handle parser;
 
 /* JSON generator for stdout */
-yajl_gen gen;
+ipc_gen *gen;
+
+/* A string value of the current block, stored in the raw buffer of the parser
+ * context. It is only copied when the block is built. */
+struct raw_string {
+    bool set;
+    size_t offset;
+    size_t len;
+};
 
 typedef struct parser_ctx {
     /* True if one of the parsed blocks was urgent */
     bool has_urgent;
 
-    /* A copy of the last JSON map key. */
+    /* A copy of the last JSON map key. The buffer is reused for every key. */
     char *last_map_key;
+    size_t last_map_key_size;
 
     /* The current block. Will be filled, then copied and put into the list of
      * blocks. */
     struct status_block block;
+
+    /* The keys and values of the current block, serialized into a buffer which
+     * is reused for every block. Unchanged blocks are recognized by comparing
+     * it with the raw data of the block shown before. */
+    char *raw;
+    size_t raw_len;
+    size_t raw_size;
+
+    struct raw_string full_text;
+    struct raw_string short_text;
+    struct raw_string color;
+    struct raw_string background;
+    struct raw_string border;
+    struct raw_string min_width_str;
+    struct raw_string name;
+    struct raw_string instance;
 } parser_ctx;
 
 parser_ctx parser_context;
 
 struct statusline_head statusline_head = TAILQ_HEAD_INITIALIZER(statusline_head);
-/* Used temporarily while reading a statusline */
-struct statusline_head statusline_buffer = TAILQ_HEAD_INITIALIZER(statusline_buffer);
+
+/* The blocks of statusline_head in order, as of the last complete statusline,
+ * and the blocks of the statusline which is currently being read. Blocks are
+ * moved from one to the other as long as they don't change, so a steady
+ * statusline does not allocate any memory. */
+static struct status_block **shown_blocks = NULL;
+static int num_shown_blocks = 0;
+static int shown_blocks_size = 0;
+static struct status_block **pending_blocks = NULL;
+static int num_pending_blocks = 0;
+static int pending_blocks_size = 0;
+
+/* Blocks which are no longer used, kept (with their raw buffer) for reuse. */
+static struct statusline_head free_blocks = TAILQ_HEAD_INITIALIZER(free_blocks);
+
+/* Set when the shown blocks cannot be kept, even if they did not change (e.g.
+ * because the font changed). */
+static bool shown_blocks_outdated = false;
 
 int child_stdin;
 
+/*
+ * Frees the fields of the given status block (but not the block itself and
+ * its raw buffer).
+ *
+ */
+static void free_block_resources(struct status_block *block) {
+    I3STRING_FREE(block->full_text);
+    I3STRING_FREE(block->short_text);
+    FREE(block->color);
+    FREE(block->name);
+    FREE(block->instance);
+    FREE(block->min_width_str);
+    FREE(block->background);
+    FREE(block->border);
+}
+
+/*
+ * Puts a block which is no longer used on the list of free blocks.
+ *
+ */
+static void recycle_block(struct status_block *block) {
+    free_block_resources(block);
+    block->raw_len = 0;
+    TAILQ_INSERT_HEAD(&free_blocks, block, blocks);
+}
+
+/*
+ * Recycles the blocks of an unfinished statusline which are not shown.
+ *
+ */
+static void drop_pending_blocks(void) {
+    for (int i = 0; i < num_pending_blocks; i++) {
+        if (i >= num_shown_blocks || pending_blocks[i] != shown_blocks[i]) {
+            recycle_block(pending_blocks[i]);
+        }
+    }
+    num_pending_blocks = 0;
+}
+
 /*
  * Remove all blocks from the given statusline.
  * If free_resources is set, the fields of each status block will be free'd.
  */
 void clear_statusline(struct statusline_head *head, bool free_resources) {
+    if (head == &statusline_head) {
+        drop_pending_blocks();
+        num_shown_blocks = 0;
+    }
+
     struct status_block *first;
     while (!TAILQ_EMPTY(head)) {
         first = TAILQ_FIRST(head);
         if (free_resources) {
-            I3STRING_FREE(first->full_text);
-            I3STRING_FREE(first->short_text);
-            FREE(first->color);
-            FREE(first->name);
-            FREE(first->instance);
-            FREE(first->min_width_str);
-            FREE(first->background);
-            FREE(first->border);
+            free_block_resources(first);
+            FREE(first->raw);
         }
 
         TAILQ_REMOVE(head, first, blocks);
@@ -105,13 +185,26 @@ void clear_statusline(struct statusline_head *head, bool free_resources) {
     }
 }
 
-static void copy_statusline(struct statusline_head *from, struct statusline_head *to) {
-    struct status_block *current;
-    TAILQ_FOREACH (current, from, blocks) {
-        struct status_block *new_block = smalloc(sizeof(struct status_block));
-        memcpy(new_block, current, sizeof(struct status_block));
-        TAILQ_INSERT_TAIL(to, new_block, blocks);
+/*
+ * Makes the next statusline rebuild all of its blocks instead of keeping the
+ * unchanged ones. Needs to be called when the font or the separator changed.
+ *
+ */
+void invalidate_status_blocks(void) {
+    shown_blocks_outdated = true;
+}
+
+/*
+ * FNV-1a hash of the raw data of a block.
+ *
+ */
+static uint32_t raw_hash(const char *raw, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (uint8_t)raw[i];
+        hash *= 16777619u;
     }
+    return hash;
 }
 
 /*
@@ -141,6 +234,9 @@ __attribute__((format(printf, 1, 2))) static void set_statusline_error(const cha
     message_block->name = sstrdup("error_message");
     message_block->color = sstrdup("#ff0000");
     message_block->no_separator = true;
+    /* There is no raw data, but draw_statusline() tells messages apart by
+     * the hash. */
+    message_block->raw_hash = raw_hash(message, strlen(message));
 
     TAILQ_INSERT_HEAD(&statusline_head, err_block, blocks);
     TAILQ_INSERT_TAIL(&statusline_head, message_block, blocks);
@@ -168,6 +264,10 @@ static void cleanup(i3bar_child *c) {
         close(c->stdin_fd);
     }
 
+    if (c == &status_child) {
+        status_segment_close();
+    }
+
     if (c->child_sig != NULL) {
         ev_child_stop(main_loop, c->child_sig);
         FREE(c->child_sig);
@@ -178,23 +278,79 @@ static void cleanup(i3bar_child *c) {
 }
 
 /*
- * The start of a new array is the start of a new status line, so we clear all
- * previous entries from the buffer.
+ * Appends the given bytes to the raw data of the current block.
+ *
+ */
+static void append_raw(parser_ctx *ctx, const void *data, size_t len) {
+    if (ctx->raw_len + len > ctx->raw_size) {
+        ctx->raw_size = (ctx->raw_size == 0 ? 256 : ctx->raw_size);
+        while (ctx->raw_len + len > ctx->raw_size) {
+            ctx->raw_size *= 2;
+        }
+        ctx->raw = srealloc(ctx->raw, ctx->raw_size);
+    }
+    memcpy(ctx->raw + ctx->raw_len, data, len);
+    ctx->raw_len += len;
+}
+
+/*
+ * Appends a JSON event (a type character and the value) to the raw data of the
+ * current block.
+ *
+ */
+static void append_raw_event(parser_ctx *ctx, char type, const void *data, size_t len) {
+    append_raw(ctx, &type, sizeof(char));
+    if (type == 'k' || type == 's') {
+        append_raw(ctx, &len, sizeof(size_t));
+    }
+    append_raw(ctx, data, len);
+}
+
+/*
+ * Returns a copy of the given string value of the current block, NULL if it
+ * was not set.
+ *
+ */
+static char *raw_string_dup(parser_ctx *ctx, struct raw_string *str) {
+    if (!str->set) {
+        return NULL;
+    }
+    char *result;
+    sasprintf(&result, "%.*s", (int)str->len, ctx->raw + str->offset);
+    return result;
+}
+
+static i3String *raw_string_to_i3string(parser_ctx *ctx, struct raw_string *str) {
+    if (!str->set) {
+        return NULL;
+    }
+    return i3string_from_markup_with_length(ctx->raw + str->offset, str->len);
+}
+
+/*
+ * The start of a new array is the start of a new status line, so we forget
+ * the blocks of an unfinished one.
  */
 static int stdin_start_array(void *context) {
-    // the blocks are still used by statusline_head, so we won't free the
-    // resources here.
-    clear_statusline(&statusline_buffer, false);
+    drop_pending_blocks();
     return 1;
 }
 
 /*
- * The start of a map is the start of a single block of the status line.
+ * Resets the current block of the parser's context to the defaults.
  *
  */
-static int stdin_start_map(void *context) {
-    parser_ctx *ctx = context;
+static void begin_block(parser_ctx *ctx) {
     memset(&(ctx->block), '\0', sizeof(struct status_block));
+    ctx->raw_len = 0;
+    ctx->full_text.set = false;
+    ctx->short_text.set = false;
+    ctx->color.set = false;
+    ctx->background.set = false;
+    ctx->border.set = false;
+    ctx->min_width_str.set = false;
+    ctx->name.set = false;
+    ctx->instance.set = false;
 
     /* Default width of the separator block. */
     if (config.separator_symbol == NULL) {
@@ -202,20 +358,35 @@ static int stdin_start_map(void *context) {
     } else {
         ctx->block.sep_block_width = logical_px(8) + separator_symbol_width;
     }
+    /* The default depends on the configuration, so a block needs to be built
+     * again when it changes. */
+    append_raw(ctx, &(ctx->block.sep_block_width), sizeof(uint32_t));
 
     /* By default we draw all four borders if a border is set. */
     ctx->block.border_top = 1;
     ctx->block.border_right = 1;
     ctx->block.border_bottom = 1;
     ctx->block.border_left = 1;
+}
 
+/*
+ * The start of a map is the start of a single block of the status line.
+ *
+ */
+static int stdin_start_map(void *context) {
+    begin_block(context);
     return 1;
 }
 
 static int stdin_map_key(void *context, const unsigned char *key, size_t len) {
     parser_ctx *ctx = context;
-    FREE(ctx->last_map_key);
-    sasprintf(&(ctx->last_map_key), "%.*s", len, key);
+    if (len + 1 > ctx->last_map_key_size) {
+        ctx->last_map_key_size = len + 1;
+        ctx->last_map_key = srealloc(ctx->last_map_key, ctx->last_map_key_size);
+    }
+    memcpy(ctx->last_map_key, key, len);
+    ctx->last_map_key[len] = '\0';
+    append_raw_event(ctx, 'k', key, len);
     return 1;
 }
 
@@ -226,6 +397,9 @@ static int stdin_boolean(void *context, int val) {
         return 0;
     }
 
+    const char raw_val = (val != 0);
+    append_raw_event(ctx, 'b', &raw_val, sizeof(char));
+
     if (strcasecmp(ctx->last_map_key, "urgent") == 0) {
         ctx->block.urgent = val;
         return 1;
@@ -245,24 +419,32 @@ static int stdin_string(void *context, const unsigned char *val, size_t len) {
         return 0;
     }
 
+    append_raw_event(ctx, 's', val, len);
+    /* The strings are only copied out of the raw data if the block changed
+     * (see stdin_end_map). */
+    const struct raw_string str = {
+        .set = true,
+        .offset = ctx->raw_len - len,
+        .len = len};
+
     if (strcasecmp(ctx->last_map_key, "full_text") == 0) {
-        ctx->block.full_text = i3string_from_markup_with_length((const char *)val, len);
+        ctx->full_text = str;
         return 1;
     }
     if (strcasecmp(ctx->last_map_key, "short_text") == 0) {
-        ctx->block.short_text = i3string_from_markup_with_length((const char *)val, len);
+        ctx->short_text = str;
         return 1;
     }
     if (strcasecmp(ctx->last_map_key, "color") == 0) {
-        sasprintf(&(ctx->block.color), "%.*s", len, val);
+        ctx->color = str;
         return 1;
     }
     if (strcasecmp(ctx->last_map_key, "background") == 0) {
-        sasprintf(&(ctx->block.background), "%.*s", len, val);
+        ctx->background = str;
         return 1;
     }
     if (strcasecmp(ctx->last_map_key, "border") == 0) {
-        sasprintf(&(ctx->block.border), "%.*s", len, val);
+        ctx->border = str;
         return 1;
     }
     if (strcasecmp(ctx->last_map_key, "markup") == 0) {
@@ -280,15 +462,15 @@ static int stdin_string(void *context, const unsigned char *val, size_t len) {
         return 1;
     }
     if (strcasecmp(ctx->last_map_key, "min_width") == 0) {
-        sasprintf(&(ctx->block.min_width_str), "%.*s", len, val);
+        ctx->min_width_str = str;
         return 1;
     }
     if (strcasecmp(ctx->last_map_key, "name") == 0) {
-        sasprintf(&(ctx->block.name), "%.*s", len, val);
+        ctx->name = str;
         return 1;
     }
     if (strcasecmp(ctx->last_map_key, "instance") == 0) {
-        sasprintf(&(ctx->block.instance), "%.*s", len, val);
+        ctx->instance = str;
         return 1;
     }
 
@@ -302,6 +484,8 @@ static int stdin_integer(void *context, long long val) {
         return 0;
     }
 
+    append_raw_event(ctx, 'i', &val, sizeof(long long));
+
     if (strcasecmp(ctx->last_map_key, "min_width") == 0) {
         ctx->block.min_width = (uint32_t)val;
         return 1;
@@ -331,21 +515,45 @@ static int stdin_integer(void *context, long long val) {
 }
 
 /*
- * When a map is finished, we have an entire status block.
- * Move it from the parser's context to the statusline buffer.
+ * Builds a new status block from the parser's context, reusing a free block if
+ * there is one.
+ *
  */
-static int stdin_end_map(void *context) {
-    parser_ctx *ctx = context;
-    struct status_block *new_block = smalloc(sizeof(struct status_block));
+static struct status_block *build_block(parser_ctx *ctx, uint32_t hash) {
+    struct status_block *new_block = TAILQ_FIRST(&free_blocks);
+    if (new_block != NULL) {
+        TAILQ_REMOVE(&free_blocks, new_block, blocks);
+    } else {
+        new_block = scalloc(1, sizeof(struct status_block));
+    }
+
+    char *raw = new_block->raw;
+    size_t raw_size = new_block->raw_size;
     memcpy(new_block, &(ctx->block), sizeof(struct status_block));
+    if (ctx->raw_len > raw_size) {
+        raw_size = ctx->raw_len;
+        raw = srealloc(raw, raw_size);
+    }
+    memcpy(raw, ctx->raw, ctx->raw_len);
+    new_block->raw = raw;
+    new_block->raw_size = raw_size;
+    new_block->raw_len = ctx->raw_len;
+    new_block->raw_hash = hash;
+
+    new_block->full_text = raw_string_to_i3string(ctx, &(ctx->full_text));
+    new_block->short_text = raw_string_to_i3string(ctx, &(ctx->short_text));
+    new_block->color = raw_string_dup(ctx, &(ctx->color));
+    new_block->background = raw_string_dup(ctx, &(ctx->background));
+    new_block->border = raw_string_dup(ctx, &(ctx->border));
+    new_block->min_width_str = raw_string_dup(ctx, &(ctx->min_width_str));
+    new_block->name = raw_string_dup(ctx, &(ctx->name));
+    new_block->instance = raw_string_dup(ctx, &(ctx->instance));
+
     /* Ensure we have a full_text set, so that when it is missing (or null),
      * i3bar doesn’t crash and the user gets an annoying message. */
     if (!new_block->full_text) {
         new_block->full_text = i3string_from_utf8("SPEC VIOLATION: full_text is NULL!");
     }
-    if (new_block->urgent) {
-        ctx->has_urgent = true;
-    }
 
     if (new_block->min_width_str) {
         i3String *text = i3string_from_utf8(new_block->min_width_str);
@@ -361,19 +569,83 @@ static int stdin_end_map(void *context) {
         i3string_set_markup(new_block->short_text, new_block->pango_markup);
     }
 
-    TAILQ_INSERT_TAIL(&statusline_buffer, new_block, blocks);
+    return new_block;
+}
+
+/*
+ * Appends the current block of the parser's context to the pending blocks.
+ * If it is the same as the block shown at its position, that block is kept,
+ * otherwise a new one is built.
+ *
+ */
+static void add_pending_block(parser_ctx *ctx) {
+    const uint32_t hash = raw_hash(ctx->raw, ctx->raw_len);
+    const int position = num_pending_blocks;
+
+    struct status_block *block = NULL;
+    if (!shown_blocks_outdated && position < num_shown_blocks) {
+        struct status_block *shown = shown_blocks[position];
+        if (shown->raw_hash == hash &&
+            shown->raw_len == ctx->raw_len &&
+            memcmp(shown->raw, ctx->raw, ctx->raw_len) == 0) {
+            block = shown;
+        }
+    }
+    if (block == NULL) {
+        block = build_block(ctx, hash);
+    }
+
+    if (block->urgent) {
+        ctx->has_urgent = true;
+    }
 
+    if (num_pending_blocks == pending_blocks_size) {
+        pending_blocks_size = (pending_blocks_size == 0 ? 16 : pending_blocks_size * 2);
+        pending_blocks = srealloc(pending_blocks, pending_blocks_size * sizeof(struct status_block *));
+    }
+    pending_blocks[num_pending_blocks++] = block;
+}
+
+/*
+ * When a map is finished, we have an entire status block.
+ */
+static int stdin_end_map(void *context) {
+    add_pending_block(context);
     return 1;
 }
 
 /*
- * When an array is finished, we have an entire statusline.
- * Copy it from the buffer to the actual statusline.
+ * Replaces the actual statusline with the pending blocks.
+ *
  */
-static int stdin_end_array(void *context) {
-    DLOG("copying statusline_buffer to statusline_head\n");
-    clear_statusline(&statusline_head, true);
-    copy_statusline(&statusline_buffer, &statusline_head);
+static void show_pending_blocks(void) {
+    DLOG("updating statusline_head (%d blocks)\n", num_pending_blocks);
+
+    /* Unlink the blocks which are kept, everything remaining in
+     * statusline_head changed or is gone. */
+    for (int i = 0; i < num_pending_blocks && i < num_shown_blocks; i++) {
+        if (pending_blocks[i] == shown_blocks[i]) {
+            TAILQ_REMOVE(&statusline_head, shown_blocks[i], blocks);
+        }
+    }
+    while (!TAILQ_EMPTY(&statusline_head)) {
+        struct status_block *first = TAILQ_FIRST(&statusline_head);
+        TAILQ_REMOVE(&statusline_head, first, blocks);
+        recycle_block(first);
+    }
+    for (int i = 0; i < num_pending_blocks; i++) {
+        TAILQ_INSERT_TAIL(&statusline_head, pending_blocks[i], blocks);
+    }
+
+    struct status_block **old_blocks = shown_blocks;
+    const int old_blocks_size = shown_blocks_size;
+    shown_blocks = pending_blocks;
+    shown_blocks_size = pending_blocks_size;
+    num_shown_blocks = num_pending_blocks;
+    pending_blocks = old_blocks;
+    pending_blocks_size = old_blocks_size;
+    num_pending_blocks = 0;
+    shown_blocks_outdated = false;
 
     DLOG("dumping statusline:\n");
     struct status_block *current;
@@ -383,6 +655,13 @@ static int stdin_end_array(void *context) {
         DLOG("color = %s\n", current->color);
     }
     DLOG("end of dump\n");
+}
+
+/*
+ * When an array is finished, we have an entire statusline.
+ */
+static int stdin_end_array(void *context) {
+    show_pending_blocks();
     return 1;
 }
 
@@ -468,6 +747,138 @@ static bool read_json_input(unsigned char *input, int length) {
     return has_urgent;
 }
 
+/*
+ * Appends a text field of a record from the SHM segment to the raw data of the
+ * current block and points the given string to it. Empty strings count as not
+ * set.
+ *
+ */
+static void append_record_string(parser_ctx *ctx, struct raw_string *str, const char *field, size_t size) {
+    const size_t len = strnlen(field, size);
+    append_raw_event(ctx, 's', field, len);
+    *str = (struct raw_string){
+        .set = (len > 0),
+        .offset = ctx->raw_len - len,
+        .len = len};
+}
+
+static void append_record_color(parser_ctx *ctx, struct raw_string *str, uint32_t color) {
+    char hex[sizeof("#rrggbbaa")];
+    snprintf(hex, sizeof(hex), "#%08x", color);
+    append_record_string(ctx, str, hex, sizeof(hex));
+}
+
+/*
+ * Replaces the statusline with the latest one in the SHM segment, keeping the
+ * unchanged blocks like read_json_input() does.
+ *
+ * Returns false if the status command did not publish a new statusline.
+ *
+ */
+static bool read_shm_input(bool *has_urgent) {
+    const i3bar_shmstatus_block *records;
+    const int num_records = status_segment_read(&records);
+    if (num_records < 0) {
+        return false;
+    }
+
+    parser_ctx *ctx = &parser_context;
+    drop_pending_blocks();
+    for (int i = 0; i < num_records; i++) {
+        const i3bar_shmstatus_block *record = &records[i];
+        begin_block(ctx);
+        /* The numeric fields, the strings are appended without the unused
+         * bytes of their fields. */
+        append_raw(ctx, record, offsetof(i3bar_shmstatus_block, full_text));
+
+        ctx->block.urgent = (record->flags & I3BAR_SHMSTATUS_URGENT);
+        ctx->block.no_separator = (record->flags & I3BAR_SHMSTATUS_NO_SEPARATOR);
+        ctx->block.pango_markup = (record->flags & I3BAR_SHMSTATUS_PANGO_MARKUP);
+        if (record->align == 1) {
+            ctx->block.align = ALIGN_CENTER;
+        } else if (record->align == 2) {
+            ctx->block.align = ALIGN_RIGHT;
+        } else {
+            ctx->block.align = ALIGN_LEFT;
+        }
+        ctx->block.min_width = record->min_width;
+        if (record->flags & I3BAR_SHMSTATUS_SEPARATOR_BLOCK_WIDTH) {
+            ctx->block.sep_block_width = record->separator_block_width;
+        }
+        ctx->block.border_top = record->border_top;
+        ctx->block.border_right = record->border_right;
+        ctx->block.border_bottom = record->border_bottom;
+        ctx->block.border_left = record->border_left;
+
+        append_record_string(ctx, &(ctx->full_text), record->full_text, sizeof(record->full_text));
+        ctx->full_text.set = true;
+        append_record_string(ctx, &(ctx->short_text), record->short_text, sizeof(record->short_text));
+        append_record_string(ctx, &(ctx->name), record->name, sizeof(record->name));
+        append_record_string(ctx, &(ctx->instance), record->instance, sizeof(record->instance));
+        if (record->flags & I3BAR_SHMSTATUS_COLOR) {
+            append_record_color(ctx, &(ctx->color), record->color);
+        }
+        if (record->flags & I3BAR_SHMSTATUS_BACKGROUND) {
+            append_record_color(ctx, &(ctx->background), record->background);
+        }
+        if (record->flags & I3BAR_SHMSTATUS_BORDER) {
+            append_record_color(ctx, &(ctx->border), record->border);
+        }
+
+        add_pending_block(ctx);
+    }
+    show_pending_blocks();
+
+    *has_urgent = ctx->has_urgent;
+    return true;
+}
+
+/* Limits the redraws caused by status updates to one per
+ * config.status_redraw_interval, see draw_status(). */
+static struct ev_timer *status_redraw_timer = NULL;
+static ev_tstamp last_status_redraw = 0;
+static bool status_redraw_unhide = false;
+
+static void status_redraw_cb(struct ev_loop *loop, ev_timer *watcher, int revents) {
+    last_status_redraw = ev_now(main_loop);
+    draw_bars(status_redraw_unhide);
+    status_redraw_unhide = false;
+}
+
+/*
+ * Redraws the bars after a status update. If the last redraw was less than
+ * config.status_redraw_interval ago, the redraw is postponed until the
+ * interval is over, drawing the status as it is by then.
+ *
+ */
+static void draw_status(bool unhide) {
+    if (config.status_redraw_interval <= 0) {
+        draw_bars(unhide);
+        return;
+    }
+
+    status_redraw_unhide |= unhide;
+    if (status_redraw_timer != NULL && ev_is_active(status_redraw_timer)) {
+        /* Already scheduled. */
+        return;
+    }
+
+    const ev_tstamp interval = config.status_redraw_interval / 1000.0;
+    const ev_tstamp wait = last_status_redraw + interval - ev_now(main_loop);
+    if (wait <= 0) {
+        status_redraw_cb(main_loop, status_redraw_timer, 0);
+        return;
+    }
+
+    if (status_redraw_timer == NULL) {
+        status_redraw_timer = smalloc(sizeof(ev_timer));
+        ev_timer_init(status_redraw_timer, status_redraw_cb, wait, 0.);
+    } else {
+        ev_timer_set(status_redraw_timer, wait, 0.);
+    }
+    ev_timer_start(main_loop, status_redraw_timer);
+}
+
 /*
  * Callbalk for stdin. We read a line from stdin and store the result
  * in statusline
@@ -480,13 +891,22 @@ static void stdin_io_cb(int fd) {
         return;
     }
     bool has_urgent = false;
+    if (status_child.shm_status) {
+        /* The input is only the doorbell, several rings are handled by
+         * reading the latest statusline once. */
+        free(buffer);
+        if (read_shm_input(&has_urgent)) {
+            draw_status(has_urgent);
+        }
+        return;
+    }
     if (status_child.version > 0) {
         has_urgent = read_json_input(buffer, rec);
     } else {
         read_flat_input((char *)buffer, rec);
     }
     free(buffer);
-    draw_bars(has_urgent);
+    draw_status(has_urgent);
 }
 
 /*
@@ -506,13 +926,25 @@ static void stdin_io_first_line_cb(int fd) {
     /* At the moment, we don’t care for the version. This might change
      * in the future, but for now, we just discard it. */
     parse_json_header(&status_child, buffer, rec, &consumed);
+    if (status_child.shm_status && status_segment_path == NULL) {
+        ELOG("status_command requested shm_status, but there is no SHM segment, expecting JSON\n");
+        status_child.shm_status = false;
+    } else if (!status_child.shm_status) {
+        status_segment_close();
+    }
     if (status_child.version > 0) {
         /* If hide-on-modifier is set, we start of by sending the status_child
          * a SIGSTOP, because the bars aren't mapped at start */
         if (config.hide_on_modifier) {
             stop_children();
         }
-        draw_bars(read_json_input(buffer + consumed, rec - consumed));
+        if (status_child.shm_status) {
+            bool has_urgent = false;
+            read_shm_input(&has_urgent);
+            draw_bars(has_urgent);
+        } else {
+            draw_bars(read_json_input(buffer + consumed, rec - consumed));
+        }
     } else {
         /* In case of plaintext, we just add a single block and change its
          * full_text pointer later. */
@@ -700,14 +1132,14 @@ static void child_write_output(void) {
         size_t size;
         ssize_t n;
 
-        yajl_gen_get_buf(gen, &output, &size);
+        ipc_gen_get_buf(gen, &output, &size);
 
         n = writeall(child_stdin, output, size);
         if (n != -1) {
             n = writeall(child_stdin, "\n", 1);
         }
 
-        yajl_gen_clear(gen);
+        ipc_gen_clear(gen);
 
         if (n == -1) {
             status_child.click_events = false;
@@ -779,13 +1211,17 @@ void start_child(char *command) {
         .yajl_end_array = stdin_end_array,
     };
     parser = yajl_alloc(&callbacks, NULL, &parser_context);
-    gen = yajl_gen_alloc(NULL);
+    gen = ipc_gen_alloc(false);
 
     int pipe_in[2];  /* pipe we read from */
     int pipe_out[2]; /* pipe we write to */
     spipe(pipe_in);
     spipe(pipe_out);
 
+    /* The segment is offered to the status command, it is removed again if
+     * the header does not ask for it. */
+    status_segment_open();
+
     status_child.pid = sfork();
     if (status_child.pid == 0) {
         /* Child-process. Reroute streams and start shell */
@@ -795,6 +1231,12 @@ void start_child(char *command) {
         dup2(pipe_in[1], STDOUT_FILENO);
         dup2(pipe_out[0], STDIN_FILENO);
 
+        if (status_segment_path != NULL) {
+            setenv("I3BAR_STATUS_SHM", status_segment_path, 1);
+        } else {
+            unsetenv("I3BAR_STATUS_SHM");
+        }
+
         setpgid(status_child.pid, 0);
         exec_shell(command);
         return;
@@ -847,7 +1289,7 @@ static void child_click_events_initialize(void) {
     DLOG_CHILD(status_child);
 
     if (!status_child.click_events_init) {
-        yajl_gen_array_open(gen);
+        ipc_gen_array_open(gen);
         child_write_output();
         status_child.click_events_init = true;
     }
@@ -864,7 +1306,7 @@ void send_block_clicked(int button, const char *name, const char *instance, int
 
     child_click_events_initialize();
 
-    yajl_gen_map_open(gen);
+    ipc_gen_map_open(gen);
 
     if (name) {
         ystr("name");
@@ -877,10 +1319,10 @@ void send_block_clicked(int button, const char *name, const char *instance, int
     }
 
     ystr("button");
-    yajl_gen_integer(gen, button);
+    ipc_gen_integer(gen, button);
 
     ystr("modifiers");
-    yajl_gen_array_open(gen);
+    ipc_gen_array_open(gen);
     if (mods & XCB_MOD_MASK_SHIFT) {
         ystr("Shift");
     }
@@ -902,33 +1344,33 @@ void send_block_clicked(int button, const char *name, const char *instance, int
     if (mods & XCB_MOD_MASK_5) {
         ystr("Mod5");
     }
-    yajl_gen_array_close(gen);
+    ipc_gen_array_close(gen);
 
     ystr("x");
-    yajl_gen_integer(gen, x);
+    ipc_gen_integer(gen, x);
 
     ystr("y");
-    yajl_gen_integer(gen, y);
+    ipc_gen_integer(gen, y);
 
     ystr("relative_x");
-    yajl_gen_integer(gen, x_rel);
+    ipc_gen_integer(gen, x_rel);
 
     ystr("relative_y");
-    yajl_gen_integer(gen, y_rel);
+    ipc_gen_integer(gen, y_rel);
 
     ystr("output_x");
-    yajl_gen_integer(gen, out_x);
+    ipc_gen_integer(gen, out_x);
 
     ystr("output_y");
-    yajl_gen_integer(gen, out_y);
+    ipc_gen_integer(gen, out_y);
 
     ystr("width");
-    yajl_gen_integer(gen, width);
+    ipc_gen_integer(gen, width);
 
     ystr("height");
-    yajl_gen_integer(gen, height);
+    ipc_gen_integer(gen, height);
 
-    yajl_gen_map_close(gen);
+    ipc_gen_map_close(gen);
     child_write_output();
 }
 
@@ -966,6 +1408,7 @@ void kill_children_at_exit(void) {
     if (is_alive(&ws_child)) {
         killpg(ws_child.pid, SIGTERM);
     }
+    status_segment_close();
 }
 
 static void cont_child(i3bar_child *c) {
@@ -263,6 +263,15 @@ static int config_string_cb(void *params_, const unsigned char *val, size_t _len
     COLOR(binding_mode_border, binding_mode_border);
     COLOR(binding_mode_bg, binding_mode_bg);
     COLOR(binding_mode_text, binding_mode_fg);
+    COLOR(gradient_start, gradient_start);
+    COLOR(gradient_end, gradient_end);
+    COLOR(focused_gradient_start, focus_gradient_start);
+    COLOR(focused_gradient_end, focus_gradient_end);
+    COLOR(focused_workspace_gradient, focus_ws_gradient);
+    COLOR(active_workspace_gradient, active_ws_gradient);
+    COLOR(inactive_workspace_gradient, inactive_ws_gradient);
+    COLOR(urgent_workspace_gradient, urgent_ws_gradient);
+    COLOR(binding_mode_gradient, binding_mode_gradient);
 
     printf("got unexpected string %.*s for cur_key = %s\n", len, val, cur_key);
 
@@ -313,6 +322,18 @@ static int config_boolean_cb(void *params_, int val) {
         return 1;
     }
 
+    if (!strcmp(cur_key, "gradients")) {
+        DLOG("gradients = %d\n", val);
+        config.gradients = val;
+        return 1;
+    }
+
+    if (!strcmp(cur_key, "dithering")) {
+        DLOG("dithering = %d\n", val);
+        config.dithering = val;
+        return 1;
+    }
+
     if (!strcmp(cur_key, "verbose")) {
         if (!config.verbose) {
             DLOG("verbose = %d\n", val);
@@ -389,6 +410,26 @@ static int config_integer_cb(void *params_, long long val) {
         return 1;
     }
 
+    if (!strcmp(cur_key, "status_redraw_interval")) {
+        DLOG("status_redraw_interval = %lld\n", val);
+        config.status_redraw_interval = val;
+        return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Parse a double value
+ *
+ */
+static int config_double_cb(void *params_, double val) {
+    if (!strcmp(cur_key, "dither_noise")) {
+        DLOG("dither_noise = %f\n", val);
+        config.dither_noise = val;
+        return 1;
+    }
+
     return 0;
 }
 
@@ -396,6 +437,7 @@ static int config_integer_cb(void *params_, long long val) {
 static yajl_callbacks outputs_callbacks = {
     .yajl_null = config_null_cb,
     .yajl_integer = config_integer_cb,
+    .yajl_double = config_double_cb,
     .yajl_boolean = config_boolean_cb,
     .yajl_string = config_string_cb,
     .yajl_end_array = config_end_array_cb,
@@ -481,5 +523,14 @@ void free_colors(struct xcb_color_strings_t *colors) {
     FREE_COLOR(binding_mode_fg);
     FREE_COLOR(binding_mode_bg);
     FREE_COLOR(binding_mode_border);
+    FREE_COLOR(gradient_start);
+    FREE_COLOR(gradient_end);
+    FREE_COLOR(focus_gradient_start);
+    FREE_COLOR(focus_gradient_end);
+    FREE_COLOR(active_ws_gradient);
+    FREE_COLOR(inactive_ws_gradient);
+    FREE_COLOR(focus_ws_gradient);
+    FREE_COLOR(urgent_ws_gradient);
+    FREE_COLOR(binding_mode_gradient);
 #undef FREE_COLOR
 }
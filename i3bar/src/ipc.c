@@ -168,7 +168,11 @@ handler_t reply_handlers[] = {
  */
 static void got_workspace_event(const unsigned char *event, size_t size) {
     DLOG("Got workspace event!\n");
-    i3_send_msg(I3_IPC_MESSAGE_TYPE_GET_WORKSPACES, NULL);
+    if (!apply_workspace_event(event, size)) {
+        i3_send_msg(I3_IPC_MESSAGE_TYPE_GET_WORKSPACES, NULL);
+        return;
+    }
+    draw_bars(false);
 }
 
 /*
@@ -238,6 +242,7 @@ static void got_bar_config_update(const unsigned char *event, size_t size) {
     /* update fonts and colors */
     init_xcb_late(config.fontname);
     init_colors(&(config.colors));
+    invalidate_status_blocks();
 
     /* restart status command process */
     if (!status_child_is_alive() || strings_differ(old_command, config.command)) {
@@ -20,6 +20,7 @@ static enum {
     KEY_STOP_SIGNAL,
     KEY_CONT_SIGNAL,
     KEY_CLICK_EVENTS,
+    KEY_SHM_STATUS,
     NO_KEY
 } current_key;
 
@@ -50,6 +51,9 @@ static int header_boolean(void *ctx, int val) {
         case KEY_CLICK_EVENTS:
             child->click_events = val;
             break;
+        case KEY_SHM_STATUS:
+            child->shm_status = val;
+            break;
         default:
             break;
     }
@@ -69,6 +73,8 @@ static int header_map_key(void *ctx, const unsigned char *stringval, size_t stri
         current_key = KEY_CONT_SIGNAL;
     } else if (CHECK_KEY("click_events")) {
         current_key = KEY_CLICK_EVENTS;
+    } else if (CHECK_KEY("shm_status")) {
+        current_key = KEY_SHM_STATUS;
     }
     return 1;
 }
@@ -77,6 +83,7 @@ static void child_init(i3bar_child *child) {
     child->version = 0;
     child->stop_signal = SIGSTOP;
     child->cont_signal = SIGCONT;
+    child->shm_status = false;
 }
 
 /*
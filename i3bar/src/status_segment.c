@@ -0,0 +1,162 @@
+/*
+ * vim:ts=4:sw=4:expandtab
+ *
+ * i3bar - an xcb-based status- and ws-bar for i3
+ * © 2010 Axel Wagner and contributors (see also: LICENSE)
+ *
+ * status_segment.c: The shared memory segment through which the status
+ *                   command can send its statuslines (see shmstatus.h for
+ *                   the format).
+ *
+ */
+#include "common.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* The name of the SHM segment (/i3bar-status-%pid), or NULL if there is
+ * none. */
+char *status_segment_path = NULL;
+
+static int segment_shm = -1;
+static uint8_t *segment = NULL;
+static size_t segment_size = 0;
+
+/* The head of the ring as of the last statusline which was read. */
+static uint32_t last_head = 0;
+
+/* The copy of the last statusline which was read. */
+static i3bar_shmstatus_block *blocks_copy = NULL;
+
+/* How often a slot is copied again when the status command changed it in the
+ * meantime. After that, the statusline is read at the next doorbell. */
+#define STATUS_SEGMENT_MAX_RETRIES 8
+
+/*
+ * Creates the SHM segment for the status command. On failure, the status
+ * command can only use the JSON protocol.
+ *
+ */
+void status_segment_open(void) {
+    status_segment_close();
+
+#if defined(__FreeBSD__)
+    sasprintf(&status_segment_path, "/tmp/i3bar-status-%d", getpid());
+#else
+    sasprintf(&status_segment_path, "/i3bar-status-%d", getpid());
+#endif
+    segment_shm = shm_open(status_segment_path, O_RDWR | O_CREAT | O_TRUNC, S_IREAD | S_IWRITE);
+    if (segment_shm == -1) {
+        ELOG("Could not shm_open SHM segment for the status command: %s\n", strerror(errno));
+        FREE(status_segment_path);
+        return;
+    }
+
+    const size_t size = sizeof(i3bar_shmstatus_header) + I3BAR_SHMSTATUS_SLOTS * sizeof(i3bar_shmstatus_slot);
+#if defined(__OpenBSD__) || defined(__APPLE__)
+    if (ftruncate(segment_shm, size) == -1) {
+        ELOG("Could not ftruncate SHM segment for the status command: %s\n", strerror(errno));
+#else
+    int ret;
+    if ((ret = posix_fallocate(segment_shm, 0, size)) != 0) {
+        ELOG("Could not ftruncate SHM segment for the status command: %s\n", strerror(ret));
+#endif
+        status_segment_close();
+        return;
+    }
+
+    segment = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, segment_shm, 0);
+    if (segment == MAP_FAILED) {
+        ELOG("Could not mmap SHM segment for the status command: %s\n", strerror(errno));
+        segment = NULL;
+        status_segment_close();
+        return;
+    }
+    segment_size = size;
+
+    /* The rest of the segment is zeroed, so head and the sequence of all
+     * slots start at 0. */
+    i3bar_shmstatus_header *header = (i3bar_shmstatus_header *)segment;
+    header->magic = I3BAR_SHMSTATUS_MAGIC;
+    header->version = I3BAR_SHMSTATUS_VERSION;
+    header->num_slots = I3BAR_SHMSTATUS_SLOTS;
+    header->max_blocks = I3BAR_SHMSTATUS_MAX_BLOCKS;
+    header->block_size = sizeof(i3bar_shmstatus_block);
+    header->slot_size = sizeof(i3bar_shmstatus_slot);
+    header->slots_offset = sizeof(i3bar_shmstatus_header);
+    last_head = 0;
+
+    if (blocks_copy == NULL) {
+        blocks_copy = smalloc(I3BAR_SHMSTATUS_MAX_BLOCKS * sizeof(i3bar_shmstatus_block));
+    }
+}
+
+/*
+ * Unmaps and removes the SHM segment.
+ *
+ */
+void status_segment_close(void) {
+    if (status_segment_path == NULL) {
+        return;
+    }
+    if (segment != NULL) {
+        munmap(segment, segment_size);
+        segment = NULL;
+        segment_size = 0;
+    }
+    close(segment_shm);
+    segment_shm = -1;
+    shm_unlink(status_segment_path);
+    FREE(status_segment_path);
+}
+
+/*
+ * Copies the latest statusline out of the segment, if the status command
+ * published one since the last call. *blocks points to the copy, which is
+ * valid until the next call.
+ *
+ * Returns the number of blocks, -1 if there is no new statusline.
+ *
+ */
+int status_segment_read(const i3bar_shmstatus_block **blocks) {
+    if (segment == NULL) {
+        return -1;
+    }
+
+    i3bar_shmstatus_header *header = (i3bar_shmstatus_header *)segment;
+    i3bar_shmstatus_slot *slots = (i3bar_shmstatus_slot *)(segment + sizeof(i3bar_shmstatus_header));
+    for (int attempt = 0; attempt < STATUS_SEGMENT_MAX_RETRIES; attempt++) {
+        const uint32_t head = __atomic_load_n(&(header->head), __ATOMIC_ACQUIRE);
+        if (head == last_head) {
+            return -1;
+        }
+
+        /* Everything in the slot is written by the status command, so the
+         * number of blocks is only trusted up to the size of the slot. */
+        i3bar_shmstatus_slot *slot = &slots[(head - 1) % I3BAR_SHMSTATUS_SLOTS];
+        const uint32_t sequence = __atomic_load_n(&(slot->sequence), __ATOMIC_ACQUIRE);
+        if (sequence & 1) {
+            continue;
+        }
+        uint32_t num_blocks = __atomic_load_n(&(slot->num_blocks), __ATOMIC_RELAXED);
+        if (num_blocks > I3BAR_SHMSTATUS_MAX_BLOCKS) {
+            num_blocks = I3BAR_SHMSTATUS_MAX_BLOCKS;
+        }
+        memcpy(blocks_copy, slot->blocks, num_blocks * sizeof(i3bar_shmstatus_block));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&(slot->sequence), __ATOMIC_RELAXED) != sequence) {
+            continue;
+        }
+
+        last_head = head;
+        *blocks = blocks_copy;
+        return num_blocks;
+    }
+
+    DLOG("Status command kept changing the latest statusline, reading it at the next doorbell\n");
+    return -1;
+}
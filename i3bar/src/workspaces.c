@@ -98,46 +98,52 @@ static int workspaces_integer_cb(void *params_, long long val) {
 }
 
 /*
- * Parse a string (name, output)
+ * Sets the canonical name and the displayed name of the given workspace.
  *
  */
-static int workspaces_string_cb(void *params_, const unsigned char *val, size_t len) {
-    struct workspaces_json_params *params = (struct workspaces_json_params *)params_;
-
-    if (!strcmp(params->cur_key, "name")) {
-        const char *ws_name = (const char *)val;
-        params->workspaces_walk->canonical_name = sstrndup(ws_name, len);
+static void set_workspace_name(i3_ws *ws, const char *ws_name, size_t len) {
+    ws->canonical_name = sstrndup(ws_name, len);
 
-        if ((config.strip_ws_numbers || config.strip_ws_name) && params->workspaces_walk->num >= 0) {
-            /* Special case: strip off the workspace number/name */
-            static char ws_num[32];
+    if ((config.strip_ws_numbers || config.strip_ws_name) && ws->num >= 0) {
+        /* Special case: strip off the workspace number/name */
+        static char ws_num[32];
 
-            snprintf(ws_num, sizeof(ws_num), "%d", params->workspaces_walk->num);
+        snprintf(ws_num, sizeof(ws_num), "%d", ws->num);
 
-            /* Calculate the length of the number str in the name */
-            size_t offset = strspn(ws_name, ws_num);
+        /* Calculate the length of the number str in the name */
+        size_t offset = strspn(ws_name, ws_num);
 
-            /* Also strip off the conventional ws name delimiter */
-            if (offset && ws_name[offset] == ':') {
-                offset += 1;
-            }
+        /* Also strip off the conventional ws name delimiter */
+        if (offset && ws_name[offset] == ':') {
+            offset += 1;
+        }
 
-            if (config.strip_ws_numbers) {
-                /* Offset may be equal to length, in which case display the number */
-                params->workspaces_walk->name = (offset < len
-                                                     ? i3string_from_markup_with_length(ws_name + offset, len - offset)
-                                                     : i3string_from_markup(ws_num));
-            } else {
-                params->workspaces_walk->name = i3string_from_markup(ws_num);
-            }
+        if (config.strip_ws_numbers) {
+            /* Offset may be equal to length, in which case display the number */
+            ws->name = (offset < len
+                            ? i3string_from_markup_with_length(ws_name + offset, len - offset)
+                            : i3string_from_markup(ws_num));
         } else {
-            /* Default case: just save the name */
-            params->workspaces_walk->name = i3string_from_markup_with_length(ws_name, len);
+            ws->name = i3string_from_markup(ws_num);
         }
+    } else {
+        /* Default case: just save the name */
+        ws->name = i3string_from_markup_with_length(ws_name, len);
+    }
+
+    /* Save its rendered width */
+    ws->name_width = predict_text_width(ws->name);
+}
+
+/*
+ * Parse a string (name, output)
+ *
+ */
+static int workspaces_string_cb(void *params_, const unsigned char *val, size_t len) {
+    struct workspaces_json_params *params = (struct workspaces_json_params *)params_;
 
-        /* Save its rendered width */
-        params->workspaces_walk->name_width =
-            predict_text_width(params->workspaces_walk->name);
+    if (!strcmp(params->cur_key, "name")) {
+        set_workspace_name(params->workspaces_walk, (const char *)val, len);
 
         DLOG("Got workspace canonical: %s, name: '%s', name_width: %d, glyphs: %zu\n",
              params->workspaces_walk->canonical_name,
@@ -269,6 +275,277 @@ void parse_workspaces_json(const unsigned char *json, size_t size) {
     FREE(params.cur_key);
 }
 
+/* The fields of a workspace container in a workspace event */
+struct workspace_event_con {
+    bool set;
+    uintptr_t id;
+    int num;
+    char *name;
+    char *output;
+    bool urgent;
+};
+
+/* A datatype to pass through the callbacks to save the state */
+struct workspace_event_params {
+    char *change;
+    char *cur_key;
+    /* The nesting depth of maps and arrays, 1 within the event itself. */
+    int depth;
+    /* The container whose fields are currently being parsed (depth 2). */
+    struct workspace_event_con *con;
+    struct workspace_event_con current;
+};
+
+static int workspace_event_boolean_cb(void *params_, int val) {
+    struct workspace_event_params *params = (struct workspace_event_params *)params_;
+
+    if (params->depth == 2 && params->con != NULL && !strcmp(params->cur_key, "urgent")) {
+        params->con->urgent = val;
+    }
+    return 1;
+}
+
+static int workspace_event_integer_cb(void *params_, long long val) {
+    struct workspace_event_params *params = (struct workspace_event_params *)params_;
+
+    if (params->depth != 2 || params->con == NULL) {
+        return 1;
+    }
+    if (!strcmp(params->cur_key, "id")) {
+        params->con->id = val;
+    } else if (!strcmp(params->cur_key, "num")) {
+        params->con->num = (int)val;
+    }
+    return 1;
+}
+
+static int workspace_event_string_cb(void *params_, const unsigned char *val, size_t len) {
+    struct workspace_event_params *params = (struct workspace_event_params *)params_;
+
+    if (params->depth == 1 && !strcmp(params->cur_key, "change")) {
+        FREE(params->change);
+        params->change = sstrndup((const char *)val, len);
+        return 1;
+    }
+    if (params->depth != 2 || params->con == NULL) {
+        return 1;
+    }
+    if (!strcmp(params->cur_key, "name")) {
+        FREE(params->con->name);
+        params->con->name = sstrndup((const char *)val, len);
+    } else if (!strcmp(params->cur_key, "output")) {
+        FREE(params->con->output);
+        params->con->output = sstrndup((const char *)val, len);
+    }
+    return 1;
+}
+
+static int workspace_event_start_map_cb(void *params_) {
+    struct workspace_event_params *params = (struct workspace_event_params *)params_;
+
+    /* Only the "current" container is needed, not its children. */
+    if (params->depth == 1 && !strcmp(params->cur_key, "current")) {
+        params->con = &(params->current);
+        params->con->set = true;
+        params->con->num = -1;
+    }
+    params->depth++;
+    return 1;
+}
+
+static int workspace_event_end_map_cb(void *params_) {
+    struct workspace_event_params *params = (struct workspace_event_params *)params_;
+
+    params->depth--;
+    if (params->depth == 1) {
+        params->con = NULL;
+    }
+    return 1;
+}
+
+static int workspace_event_start_array_cb(void *params_) {
+    struct workspace_event_params *params = (struct workspace_event_params *)params_;
+    params->depth++;
+    return 1;
+}
+
+static int workspace_event_end_array_cb(void *params_) {
+    struct workspace_event_params *params = (struct workspace_event_params *)params_;
+    params->depth--;
+    return 1;
+}
+
+static int workspace_event_map_key_cb(void *params_, const unsigned char *keyVal, size_t keyLen) {
+    struct workspace_event_params *params = (struct workspace_event_params *)params_;
+    FREE(params->cur_key);
+    sasprintf(&(params->cur_key), "%.*s", keyLen, keyVal);
+    return 1;
+}
+
+static yajl_callbacks workspace_event_callbacks = {
+    .yajl_boolean = workspace_event_boolean_cb,
+    .yajl_integer = workspace_event_integer_cb,
+    .yajl_string = workspace_event_string_cb,
+    .yajl_start_map = workspace_event_start_map_cb,
+    .yajl_end_map = workspace_event_end_map_cb,
+    .yajl_start_array = workspace_event_start_array_cb,
+    .yajl_end_array = workspace_event_end_array_cb,
+    .yajl_map_key = workspace_event_map_key_cb,
+};
+
+/*
+ * Returns the workspace with the given ID, NULL if there is none.
+ *
+ */
+static i3_ws *get_workspace_by_id(uintptr_t id) {
+    if (outputs == NULL) {
+        return NULL;
+    }
+
+    i3_output *outputs_walk;
+    SLIST_FOREACH (outputs_walk, outputs, slist) {
+        if (outputs_walk->workspaces == NULL) {
+            continue;
+        }
+        i3_ws *ws_walk;
+        TAILQ_FOREACH (ws_walk, outputs_walk->workspaces, tailq) {
+            if (ws_walk->id == id) {
+                return ws_walk;
+            }
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Inserts a new workspace into the list of its output, at the same position
+ * as i3 puts it into the tree (see con_attach()).
+ *
+ */
+static void insert_workspace(i3_ws *ws) {
+    struct ws_head *workspaces = ws->output->workspaces;
+    i3_ws *current = TAILQ_FIRST(workspaces);
+    if (ws->num == -1 || current == NULL) {
+        TAILQ_INSERT_TAIL(workspaces, ws, tailq);
+        return;
+    }
+
+    while (current != NULL && current->num != -1 && ws->num >= current->num) {
+        current = TAILQ_NEXT(current, tailq);
+    }
+    if (current != NULL) {
+        TAILQ_INSERT_BEFORE(current, ws, tailq);
+    } else {
+        TAILQ_INSERT_TAIL(workspaces, ws, tailq);
+    }
+}
+
+/*
+ * Applies the given change to the workspace lists. Returns false if it cannot
+ * be applied.
+ *
+ */
+static bool apply_workspace_change(struct workspace_event_params *params) {
+    const struct workspace_event_con *current = &(params->current);
+    if (params->change == NULL || !current->set) {
+        return false;
+    }
+
+    if (!strcmp(params->change, "init")) {
+        if (current->name == NULL || get_workspace_by_id(current->id) != NULL) {
+            return false;
+        }
+        i3_output *output = (current->output == NULL ? NULL : get_output_by_name(current->output));
+        if (output == NULL) {
+            /* Like parse_workspaces_json(), ignore workspaces on outputs we
+             * don't know. */
+            return true;
+        }
+
+        i3_ws *ws = scalloc(1, sizeof(i3_ws));
+        ws->id = current->id;
+        ws->num = current->num;
+        ws->urgent = current->urgent;
+        ws->output = output;
+        set_workspace_name(ws, current->name, strlen(current->name));
+        insert_workspace(ws);
+        DLOG("Added workspace %s on output %s\n", ws->canonical_name, output->name);
+        return true;
+    }
+
+    i3_ws *ws = get_workspace_by_id(current->id);
+    if (ws == NULL) {
+        return false;
+    }
+
+    if (!strcmp(params->change, "focus")) {
+        i3_output *outputs_walk;
+        SLIST_FOREACH (outputs_walk, outputs, slist) {
+            if (outputs_walk->workspaces == NULL) {
+                continue;
+            }
+            i3_ws *ws_walk;
+            TAILQ_FOREACH (ws_walk, outputs_walk->workspaces, tailq) {
+                ws_walk->focused = false;
+                if (outputs_walk == ws->output) {
+                    ws_walk->visible = false;
+                }
+            }
+        }
+        ws->focused = true;
+        ws->visible = true;
+        ws->urgent = current->urgent;
+        return true;
+    }
+
+    if (!strcmp(params->change, "urgent")) {
+        ws->urgent = current->urgent;
+        return true;
+    }
+
+    if (!strcmp(params->change, "empty")) {
+        TAILQ_REMOVE(ws->output->workspaces, ws, tailq);
+        I3STRING_FREE(ws->name);
+        FREE(ws->canonical_name);
+        free(ws);
+        return true;
+    }
+
+    /* Renamed or moved workspaces may change their position, so we get all
+     * of them again (as for any other change). */
+    return false;
+}
+
+/*
+ * Applies a workspace event to the workspace lists, so that they don't have to
+ * be requested again. Returns false if the event could not be applied (e.g.
+ * because it refers to an unknown workspace), in which case the caller needs
+ * to request all workspaces.
+ *
+ */
+bool apply_workspace_event(const unsigned char *json, size_t size) {
+    struct workspace_event_params params = {0};
+    yajl_handle handle = yajl_alloc(&workspace_event_callbacks, NULL, (void *)&params);
+    yajl_status state = yajl_parse(handle, json, size);
+
+    bool applied = false;
+    if (state == yajl_status_ok) {
+        applied = apply_workspace_change(&params);
+    } else {
+        unsigned char *err = yajl_get_error(handle, 1, json, size);
+        ELOG("Could not parse workspace event, error:\n%s\njson:---%.*s---\n", err, (int)size, json);
+        yajl_free_error(handle, err);
+    }
+    DLOG("Workspace event \"%s\" %s\n", params.change, (applied ? "applied" : "not applied"));
+
+    yajl_free(handle);
+    FREE(params.change);
+    FREE(params.cur_key);
+    FREE(params.current.name);
+    FREE(params.current.output);
+    return applied;
+}
+
 /*
  * free() all workspace data structures. Does not free() the heads of the tailqueues.
  *
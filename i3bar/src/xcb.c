@@ -104,6 +104,15 @@ struct xcb_colors_t {
     color_t binding_mode_bg;
     color_t binding_mode_fg;
     color_t binding_mode_border;
+    color_t gradient_start;
+    color_t gradient_end;
+    color_t focus_gradient_start;
+    color_t focus_gradient_end;
+    color_t active_ws_gradient;
+    color_t inactive_ws_gradient;
+    color_t focus_ws_gradient;
+    color_t urgent_ws_gradient;
+    color_t binding_mode_gradient;
 };
 struct xcb_colors_t colors;
 
@@ -292,13 +301,147 @@ static uint32_t adjust_statusline_length(uint32_t max_length) {
 }
 
 /*
- * Redraws the statusline to the output's statusline_buffer
+ * What draw_statusline() drew for one (non-empty) block.
+ *
+ */
+struct drawn_block {
+    /* The position and width of the block, and the width of the separator
+     * block after it (0 for the last block). */
+    uint32_t x;
+    uint32_t width;
+    uint32_t sep_block_width;
+    uint32_t sep_offset;
+
+    /* The block which was drawn. Blocks which did not change are kept across
+     * statusline updates, but a block which is no longer shown can be reused
+     * for a different one, so the hash of its contents is compared, too. The
+     * block is only dereferenced while drawing. */
+    struct status_block *block;
+    uint32_t raw_hash;
+    bool use_short;
+
+    /* The content of the block. */
+    color_t fg_color;
+    color_t bg_color;
+    color_t border_color;
+    bool has_background;
+    uint32_t border_top;
+    uint32_t border_right;
+    uint32_t border_bottom;
+    uint32_t border_left;
+    uint32_t x_offset;
+    uint32_t text_width;
+
+    /* Only valid while drawing. */
+    i3String *i3text;
+};
+
+static bool color_equal(color_t a, color_t b) {
+    return (a.red == b.red && a.green == b.green && a.blue == b.blue &&
+            a.alpha == b.alpha && a.colorpixel == b.colorpixel);
+}
+
+/*
+ * Draws the part [x, x + width) of the background gradient of the bar to a
+ * surface which is at surface_x on the bar. The gradient always spans the
+ * whole bar, so that it continues across the statusline and its pixels are
+ * only computed once per output width (see draw_util_rectangle_gradient).
+ *
+ */
+static void draw_bar_gradient(i3_output *output, surface_t *surface, bool use_focus_colors,
+                              int surface_x, double x, double width) {
+    color_t start = (use_focus_colors ? colors.focus_gradient_start : colors.gradient_start);
+    color_t end = (use_focus_colors ? colors.focus_gradient_end : colors.gradient_end);
+
+    draw_util_set_clip(surface, x, 0, width, bar_height);
+    draw_util_rectangle_gradient(surface, start, end, -surface_x, 0, output->rect.w, bar_height,
+                                 config.dithering, config.dither_noise, 0.0, 1.0);
+    draw_util_reset_clip(surface);
+}
+
+/*
+ * Returns true if the block looks the same as when it was drawn.
+ *
+ */
+static bool drawn_block_content_equal(struct drawn_block *a, struct drawn_block *b) {
+    return (a->block == b->block &&
+            a->raw_hash == b->raw_hash &&
+            a->use_short == b->use_short &&
+            color_equal(a->fg_color, b->fg_color) &&
+            color_equal(a->bg_color, b->bg_color) &&
+            color_equal(a->border_color, b->border_color) &&
+            a->has_background == b->has_background &&
+            a->border_top == b->border_top &&
+            a->border_right == b->border_right &&
+            a->border_bottom == b->border_bottom &&
+            a->border_left == b->border_left &&
+            a->x_offset == b->x_offset &&
+            a->text_width == b->text_width);
+}
+
+/* What draw_statusline() is drawing, copied to the output's drawn_blocks
+ * afterwards. Only grows, like the drawn_blocks of all outputs. */
+static struct drawn_block *frame_blocks = NULL;
+static int frame_blocks_size = 0;
+
+/*
+ * Forgets what was drawn to the output's statusline_buffer, so that the next
+ * draw_statusline() draws it from scratch. Called whenever the buffer is
+ * (re-)created.
+ *
+ */
+static void invalidate_statusline(i3_output *output) {
+    output->num_drawn_blocks = 0;
+    output->statusline_drawn = false;
+}
+
+/*
+ * Draws a block (its border, background and text) to the output's
+ * statusline_buffer.
+ *
+ */
+static void draw_block(i3_output *output, struct drawn_block *desc) {
+    if (desc->has_background) {
+        /* Draw the border. */
+        draw_util_rectangle(&output->statusline_buffer, desc->border_color,
+                            desc->x, logical_px(1),
+                            desc->width,
+                            bar_height - logical_px(2));
+
+        /* Draw the background. */
+        draw_util_rectangle(&output->statusline_buffer, desc->bg_color,
+                            desc->x + logical_px(desc->border_left),
+                            logical_px(1) + logical_px(desc->border_top),
+                            desc->width - logical_px(desc->border_right + desc->border_left),
+                            bar_height - logical_px(desc->border_bottom + desc->border_top) - logical_px(2));
+    }
+
+    draw_util_text(desc->i3text, &output->statusline_buffer, desc->fg_color, desc->bg_color,
+                   desc->x + desc->x_offset + logical_px(desc->border_left),
+                   bar_height / 2 - font.height / 2,
+                   desc->text_width - logical_px(desc->border_left + desc->border_right));
+}
+
+/*
+ * Redraws the statusline to the output's statusline_buffer. If only the
+ * content of some blocks changed since the last time (e.g. the clock), only
+ * those blocks are drawn again. x_dest is where the statusline is shown on the
+ * bar, which matters for the background gradient.
  */
-static void draw_statusline(i3_output *output, uint32_t clip_left, bool use_focus_colors) {
+static void draw_statusline(i3_output *output, uint32_t clip_left, bool use_focus_colors, int x_dest) {
     struct status_block *block;
 
     color_t bar_color = (use_focus_colors ? colors.focus_bar_bg : colors.bar_bg);
-    draw_util_clear_surface(&output->statusline_buffer, bar_color);
+
+    int num_blocks = 0;
+    TAILQ_FOREACH (block, &statusline_head, blocks) {
+        num_blocks++;
+    }
+    if (num_blocks > frame_blocks_size) {
+        frame_blocks_size = num_blocks;
+        frame_blocks = srealloc(frame_blocks, frame_blocks_size * sizeof(struct drawn_block));
+    }
+    struct drawn_block *blocks = frame_blocks;
 
     /* Use unsigned integer wraparound to clip off the left side.
      * For example, if clip_left is 75, then x will start at the very large
@@ -308,7 +451,8 @@ static void draw_statusline(i3_output *output, uint32_t clip_left, bool use_focu
      * actually rendering content to the surface. */
     uint32_t x = 0 - clip_left;
 
-    /* Draw the text of each block */
+    /* Determine what to draw for each block */
+    num_blocks = 0;
     TAILQ_FOREACH (block, &statusline_head, blocks) {
         i3String *text = block->full_text;
         struct status_block_render_desc *render = &block->full_render;
@@ -321,62 +465,118 @@ static void draw_statusline(i3_output *output, uint32_t clip_left, bool use_focu
             continue;
         }
 
-        color_t fg_color;
+        struct drawn_block *desc = &blocks[num_blocks++];
+        memset(desc, 0, sizeof(struct drawn_block));
+        desc->block = block;
+        desc->raw_hash = block->raw_hash;
+        desc->use_short = (text != block->full_text);
+        desc->i3text = text;
+
         if (block->urgent) {
-            fg_color = colors.urgent_ws_fg;
+            desc->fg_color = colors.urgent_ws_fg;
         } else if (block->color) {
-            fg_color = draw_util_hex_to_color(block->color);
+            desc->fg_color = draw_util_hex_to_color(block->color);
         } else if (use_focus_colors) {
-            fg_color = colors.focus_bar_fg;
+            desc->fg_color = colors.focus_bar_fg;
         } else {
-            fg_color = colors.bar_fg;
+            desc->fg_color = colors.bar_fg;
         }
 
-        color_t bg_color = bar_color;
-
-        int full_render_width = render->width + render->x_offset + render->x_append;
-        int has_border = block->border ? 1 : 0;
-        if (block->border || block->background || block->urgent) {
-            /* Let's determine the colors first. */
-            color_t border_color = bar_color;
-            if (block->urgent) {
-                border_color = colors.urgent_ws_border;
-                bg_color = colors.urgent_ws_bg;
-            } else {
-                if (block->border) {
-                    border_color = draw_util_hex_to_color(block->border);
-                }
-                if (block->background) {
-                    bg_color = draw_util_hex_to_color(block->background);
-                }
+        desc->bg_color = bar_color;
+        desc->border_color = bar_color;
+        desc->has_background = (block->border || block->background || block->urgent);
+        if (block->urgent) {
+            desc->border_color = colors.urgent_ws_border;
+            desc->bg_color = colors.urgent_ws_bg;
+        } else {
+            if (block->border) {
+                desc->border_color = draw_util_hex_to_color(block->border);
             }
+            if (block->background) {
+                desc->bg_color = draw_util_hex_to_color(block->background);
+            }
+        }
 
-            /* Draw the border. */
-            draw_util_rectangle(&output->statusline_buffer, border_color,
-                                x, logical_px(1),
-                                full_render_width,
-                                bar_height - logical_px(2));
-
-            /* Draw the background. */
-            draw_util_rectangle(&output->statusline_buffer, bg_color,
-                                x + has_border * logical_px(block->border_left),
-                                logical_px(1) + has_border * logical_px(block->border_top),
-                                full_render_width - has_border * logical_px(block->border_right + block->border_left),
-                                bar_height - has_border * logical_px(block->border_bottom + block->border_top) - logical_px(2));
+        if (block->border) {
+            desc->border_top = block->border_top;
+            desc->border_right = block->border_right;
+            desc->border_bottom = block->border_bottom;
+            desc->border_left = block->border_left;
         }
 
-        draw_util_text(text, &output->statusline_buffer, fg_color, bg_color,
-                       x + render->x_offset + has_border * logical_px(block->border_left),
-                       bar_height / 2 - font.height / 2,
-                       render->width - has_border * logical_px(block->border_left + block->border_right));
-        x += full_render_width;
+        desc->x = x;
+        desc->width = render->width + render->x_offset + render->x_append;
+        desc->x_offset = render->x_offset;
+        desc->text_width = render->width;
+        x += desc->width;
 
-        /* If this is not the last block, draw a separator. */
+        /* If this is not the last block, leave space for a separator. */
         if (TAILQ_NEXT(block, blocks) != NULL) {
+            desc->sep_block_width = block->sep_block_width;
+            desc->sep_offset = get_sep_offset(block);
             x += block->sep_block_width;
-            draw_separator(output, x, block, use_focus_colors);
         }
     }
+
+    /* Everything is drawn from scratch unless all blocks (and separators)
+     * are where they were drawn the last time. */
+    bool redraw_all = (!output->statusline_drawn ||
+                       output->drawn_focus_colors != use_focus_colors ||
+                       output->drawn_clip_left != clip_left ||
+                       (config.gradients && output->drawn_x_dest != x_dest) ||
+                       output->num_drawn_blocks != num_blocks);
+    for (int i = 0; i < num_blocks && !redraw_all; i++) {
+        struct drawn_block *drawn = &output->drawn_blocks[i];
+        redraw_all = (drawn->x != blocks[i].x ||
+                      drawn->width != blocks[i].width ||
+                      drawn->sep_block_width != blocks[i].sep_block_width ||
+                      drawn->sep_offset != blocks[i].sep_offset);
+    }
+
+    if (redraw_all) {
+        if (config.gradients) {
+            draw_bar_gradient(output, &output->statusline_buffer, use_focus_colors, x_dest, 0, output->rect.w);
+        } else {
+            draw_util_clear_surface(&output->statusline_buffer, bar_color);
+        }
+    }
+
+    for (int i = 0; i < num_blocks; i++) {
+        struct drawn_block *desc = &blocks[i];
+        if (!redraw_all) {
+            if (drawn_block_content_equal(desc, &output->drawn_blocks[i])) {
+                continue;
+            }
+            if (config.gradients) {
+                draw_bar_gradient(output, &output->statusline_buffer, use_focus_colors, x_dest, desc->x, desc->width);
+            } else {
+                draw_util_rectangle(&output->statusline_buffer, bar_color,
+                                    desc->x, 0, desc->width, bar_height);
+            }
+        }
+
+        draw_block(output, desc);
+
+        /* If this is not the last block, draw a separator. */
+        if (redraw_all && TAILQ_NEXT(desc->block, blocks) != NULL) {
+            draw_separator(output, desc->x + desc->width + desc->sep_block_width, desc->block, use_focus_colors);
+        }
+
+        desc->i3text = NULL;
+    }
+
+    if (num_blocks > output->drawn_blocks_size) {
+        output->drawn_blocks_size = num_blocks;
+        output->drawn_blocks = srealloc(output->drawn_blocks, output->drawn_blocks_size * sizeof(struct drawn_block));
+    }
+    if (num_blocks > 0) {
+        memcpy(output->drawn_blocks, blocks, num_blocks * sizeof(struct drawn_block));
+    }
+    output->num_drawn_blocks = num_blocks;
+    output->drawn_clip_left = clip_left;
+    output->drawn_x_dest = x_dest;
+    output->drawn_focus_colors = use_focus_colors;
+    output->statusline_drawn = true;
 }
 
 /*
@@ -487,6 +687,18 @@ void init_colors(const struct xcb_color_strings_t *new_colors) {
     PARSE_COLOR_FALLBACK(focus_bar_fg, bar_fg);
     PARSE_COLOR_FALLBACK(focus_bar_bg, bar_bg);
     PARSE_COLOR_FALLBACK(focus_sep_fg, sep_fg);
+
+    /* The gradients (see the gradients option) fall back to the flat colors,
+     * the focused ones to the regular ones. */
+    PARSE_COLOR_FALLBACK(gradient_start, bar_bg);
+    PARSE_COLOR_FALLBACK(gradient_end, bar_bg);
+    PARSE_COLOR_FALLBACK(focus_gradient_start, gradient_start);
+    PARSE_COLOR_FALLBACK(focus_gradient_end, gradient_end);
+    PARSE_COLOR_FALLBACK(active_ws_gradient, active_ws_bg);
+    PARSE_COLOR_FALLBACK(inactive_ws_gradient, inactive_ws_bg);
+    PARSE_COLOR_FALLBACK(focus_ws_gradient, focus_ws_bg);
+    PARSE_COLOR_FALLBACK(urgent_ws_gradient, urgent_ws_bg);
+    PARSE_COLOR_FALLBACK(binding_mode_gradient, binding_mode_bg);
 #undef PARSE_COLOR_FALLBACK
 
     init_tray_colors();
@@ -1743,6 +1955,7 @@ void destroy_window(i3_output *output) {
     xcb_destroy_window(xcb_connection, output->bar.id);
     xcb_free_pixmap(xcb_connection, output->buffer.id);
     xcb_free_pixmap(xcb_connection, output->statusline_buffer.id);
+    invalidate_statusline(output);
     output->bar.id = XCB_NONE;
 }
 
@@ -1956,6 +2169,7 @@ void reconfig_windows(bool redraw_bars) {
             draw_util_surface_init(xcb_connection, &walk->bar, bar_id, NULL, walk->rect.w, bar_height);
             draw_util_surface_init(xcb_connection, &walk->buffer, buffer_id, NULL, walk->rect.w, bar_height);
             draw_util_surface_init(xcb_connection, &walk->statusline_buffer, statusline_buffer_id, NULL, walk->rect.w, bar_height);
+            invalidate_statusline(walk);
 
             xcb_void_cookie_t strut_cookie = config_strut_partial(walk);
 
@@ -2038,6 +2252,7 @@ void reconfig_windows(bool redraw_bars) {
             draw_util_surface_init(xcb_connection, &(walk->bar), walk->bar.id, NULL, walk->rect.w, bar_height);
             draw_util_surface_init(xcb_connection, &(walk->buffer), walk->buffer.id, NULL, walk->rect.w, bar_height);
             draw_util_surface_init(xcb_connection, &(walk->statusline_buffer), walk->statusline_buffer.id, NULL, walk->rect.w, bar_height);
+            invalidate_statusline(walk);
 
             xcb_void_cookie_t map_cookie, umap_cookie;
             if (redraw_bars) {
@@ -2089,21 +2304,60 @@ void reconfig_windows(bool redraw_bars) {
  * Draw the button for a workspace or the current binding mode indicator.
  *
  */
-static void draw_button(surface_t *surface, color_t fg_color, color_t bg_color, color_t border_color,
-                        int x, int width, int text_width, i3String *text) {
+static void draw_button(surface_t *surface, color_t fg_color, color_t bg_color, color_t bg_gradient,
+                        color_t border_color, int x, int width, int text_width, i3String *text) {
     int height = bar_height - 2 * logical_px(1);
 
     /* Draw the border of the button. */
     draw_util_rectangle(surface, border_color, x, logical_px(1), width, height);
 
     /* Draw the inside of the button. */
-    draw_util_rectangle(surface, bg_color, x + logical_px(1), 2 * logical_px(1),
-                        width - 2 * logical_px(1), height - 2 * logical_px(1));
+    if (config.gradients && !color_equal(bg_color, bg_gradient)) {
+        draw_util_rectangle_gradient(surface, bg_color, bg_gradient, x + logical_px(1), 2 * logical_px(1),
+                                     width - 2 * logical_px(1), height - 2 * logical_px(1),
+                                     config.dithering, config.dither_noise, 0.0, 1.0);
+    } else {
+        draw_util_rectangle(surface, bg_color, x + logical_px(1), 2 * logical_px(1),
+                            width - 2 * logical_px(1), height - 2 * logical_px(1));
+    }
 
     draw_util_text(text, surface, fg_color, bg_color, x + (width - text_width) / 2,
                    bar_height / 2 - font.height / 2, text_width);
 }
 
+/*
+ * Returns true if the bars of both outputs have the same contents, so that
+ * one of them can be copied instead of drawing it again. This is only
+ * possible without workspace buttons, since every output shows its own
+ * workspaces. The statusline and the binding mode indicator are the same on
+ * all outputs.
+ *
+ */
+static bool bars_are_identical(i3_output *a, i3_output *b) {
+    return (config.disable_ws &&
+            a->rect.w == b->rect.w &&
+            output_has_focus(a) == output_has_focus(b) &&
+            get_tray_width(a->trayclients) == get_tray_width(b->trayclients));
+}
+
+/*
+ * Returns an output which was drawn before the given one (in draw_bars()) and
+ * has an identical bar, NULL if there is none.
+ *
+ */
+static i3_output *get_identical_drawn_output(i3_output *output) {
+    i3_output *outputs_walk;
+    SLIST_FOREACH (outputs_walk, outputs, slist) {
+        if (outputs_walk == output) {
+            break;
+        }
+        if (outputs_walk->active && bars_are_identical(outputs_walk, output)) {
+            return outputs_walk;
+        }
+    }
+    return NULL;
+}
+
 /*
  * Render the bars, with buttons and statusline
  *
@@ -2111,7 +2365,18 @@ static void draw_button(surface_t *surface, color_t fg_color, color_t bg_color,
 void draw_bars(bool unhide) {
     DLOG("Drawing bars...\n");
 
+    /* Bars are created before drawing any of them, because reconfig_windows()
+     * also re-creates the buffers of the other bars, which may be copied
+     * below. */
     i3_output *outputs_walk;
+    SLIST_FOREACH (outputs_walk, outputs, slist) {
+        if (outputs_walk->active && outputs_walk->bar.id == XCB_NONE) {
+            /* Oh shit, an active output without an own bar. Create it now! */
+            reconfig_windows(false);
+            break;
+        }
+    }
+
     SLIST_FOREACH (outputs_walk, outputs, slist) {
         int workspace_width = logical_px(config.padding.x);
 
@@ -2119,15 +2384,26 @@ void draw_bars(bool unhide) {
             DLOG("Output %s inactive, skipping...\n", outputs_walk->name);
             continue;
         }
-        if (outputs_walk->bar.id == XCB_NONE) {
-            /* Oh shit, an active output without an own bar. Create it now! */
-            reconfig_windows(false);
+
+        /* Without workspace buttons, outputs of the same width show the same
+         * pixels, so the bar is only drawn once and copied. */
+        i3_output *identical = get_identical_drawn_output(outputs_walk);
+        if (identical != NULL) {
+            DLOG("Copying the bar of output %s to output %s\n", identical->name, outputs_walk->name);
+            draw_util_copy_surface(&(identical->buffer), &(outputs_walk->buffer), 0, 0,
+                                   0, 0, outputs_walk->rect.w, (int16_t)bar_height);
+            outputs_walk->statusline_width = identical->statusline_width;
+            continue;
         }
 
         bool use_focus_colors = output_has_focus(outputs_walk);
 
         /* First things first: clear the backbuffer */
-        draw_util_clear_surface(&(outputs_walk->buffer), (use_focus_colors ? colors.focus_bar_bg : colors.bar_bg));
+        if (config.gradients) {
+            draw_bar_gradient(outputs_walk, &(outputs_walk->buffer), use_focus_colors, 0, 0, outputs_walk->rect.w);
+        } else {
+            draw_util_clear_surface(&(outputs_walk->buffer), (use_focus_colors ? colors.focus_bar_bg : colors.bar_bg));
+        }
 
         if (!config.disable_ws) {
             i3_ws *ws_walk;
@@ -2136,15 +2412,18 @@ void draw_bars(bool unhide) {
                      i3string_as_utf8(ws_walk->name), workspace_width, ws_walk->name_width);
                 color_t fg_color = colors.inactive_ws_fg;
                 color_t bg_color = colors.inactive_ws_bg;
+                color_t bg_gradient = colors.inactive_ws_gradient;
                 color_t border_color = colors.inactive_ws_border;
                 if (ws_walk->visible) {
                     if (!ws_walk->focused) {
                         fg_color = colors.active_ws_fg;
                         bg_color = colors.active_ws_bg;
+                        bg_gradient = colors.active_ws_gradient;
                         border_color = colors.active_ws_border;
                     } else {
                         fg_color = colors.focus_ws_fg;
                         bg_color = colors.focus_ws_bg;
+                        bg_gradient = colors.focus_ws_gradient;
                         border_color = colors.focus_ws_border;
                     }
                 }
@@ -2152,12 +2431,13 @@ void draw_bars(bool unhide) {
                     DLOG("WS %s is urgent!\n", i3string_as_utf8(ws_walk->name));
                     fg_color = colors.urgent_ws_fg;
                     bg_color = colors.urgent_ws_bg;
+                    bg_gradient = colors.urgent_ws_gradient;
                     border_color = colors.urgent_ws_border;
                     unhide = true;
                 }
 
                 int w = predict_button_width(ws_walk->name_width);
-                draw_button(&(outputs_walk->buffer), fg_color, bg_color, border_color,
+                draw_button(&(outputs_walk->buffer), fg_color, bg_color, bg_gradient, border_color,
                             workspace_width, w, ws_walk->name_width, ws_walk->name);
 
                 workspace_width += w;
@@ -2171,7 +2451,7 @@ void draw_bars(bool unhide) {
             workspace_width += logical_px(ws_spacing_px);
 
             int w = predict_button_width(binding.name_width);
-            draw_button(&(outputs_walk->buffer), colors.binding_mode_fg, colors.binding_mode_bg,
+            draw_button(&(outputs_walk->buffer), colors.binding_mode_fg, colors.binding_mode_bg, colors.binding_mode_gradient,
                         colors.binding_mode_border, workspace_width, w, binding.name_width, binding.name);
 
             unhide = true;
@@ -2202,7 +2482,7 @@ void draw_bars(bool unhide) {
             int x_dest = outputs_walk->rect.w - tray_width - logical_px((tray_width > 0) * sb_hoff_px) - visible_statusline_width;
             x_dest -= logical_px(config.padding.width);
 
-            draw_statusline(outputs_walk, clip_left, use_focus_colors);
+            draw_statusline(outputs_walk, clip_left, use_focus_colors, x_dest);
             draw_util_copy_surface(&outputs_walk->statusline_buffer, &outputs_walk->buffer, 0, 0,
                                    x_dest, 0, visible_statusline_width, (int16_t)bar_height);
 
@@ -69,6 +69,10 @@
 #include "assignments.h"
 #include "regex.h"
 #include "startup.h"
+#include "trace.h"
+#include "latency.h"
+#include "tree_delta.h"
+#include "state_snapshot.h"
 #include "scratchpad.h"
 #include "commands.h"
 #include "commands_parser.h"
@@ -332,6 +332,12 @@ void cmd_shmlog(I3_CMD, const char *argument);
  */
 void cmd_debuglog(I3_CMD, const char *argument);
 
+/**
+ * Implementation of 'trace toggle|on|off'
+ *
+ */
+void cmd_trace(I3_CMD, const char *argument);
+
 /**
  * Implementation of 'gaps inner|outer|top|right|bottom|left|horizontal|vertical current|all set|plus|minus|toggle <px>'
  *
@@ -11,8 +11,6 @@
 
 #include <config.h>
 
-#include <yajl/yajl_gen.h>
-
 /**
  * Holds an intermediate representation of the result of a call to any command.
  * When calling parse_command("floating enable, border none"), the parser will
@@ -20,7 +18,7 @@
  */
 struct CommandResultIR {
     /* The JSON generator to append a reply to (may be NULL). */
-    yajl_gen json_gen;
+    ipc_gen *json_gen;
 
     /* The IPC client connection which sent this command (may be NULL, e.g. for
        key bindings). */
@@ -48,6 +46,9 @@ struct CommandResult {
     /* the error_message is currently only set for parse errors */
     char *error_message;
     bool needs_tree_render;
+    /* The name of the first command (e.g. "focus"), pointing into the token
+     * table generated from the parser spec, or NULL if there was none. */
+    const char *command_name;
 };
 
 /**
@@ -59,13 +60,13 @@ struct CommandResult {
 char *parse_string(const char **walk, bool as_word);
 
 /**
- * Parses and executes the given command. If a caller-allocated yajl_gen is
+ * Parses and executes the given command. If a caller-allocated ipc_gen is
  * passed, a json reply will be generated in the format specified by the ipc
  * protocol. Pass NULL if no json reply is required.
  *
  * Free the returned CommandResult with command_result_free().
  */
-CommandResult *parse_command(const char *input, yajl_gen gen, ipc_client *client);
+CommandResult *parse_command(const char *input, ipc_gen *gen, ipc_client *client);
 
 /**
  * Frees a CommandResult
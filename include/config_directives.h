@@ -68,6 +68,8 @@ CFGFUN(assign, const char *workspace, bool is_number);
 CFGFUN(no_focus);
 CFGFUN(ipc_socket, const char *path);
 CFGFUN(ipc_kill_timeout, const long timeout_ms);
+CFGFUN(property_coalesce_interval, const long duration_ms);
+CFGFUN(render_batching, const char *value);
 CFGFUN(tiling_drag, const char *value);
 CFGFUN(tiling_drag_swap_modifier, const char *modifiers);
 CFGFUN(restart_state, const char *path);
@@ -100,7 +102,7 @@ CFGFUN(bar_wheel_down_cmd, const char *command);
 CFGFUN(bar_bindsym, const char *button, const char *release, const char *command);
 CFGFUN(bar_position, const char *position);
 CFGFUN(bar_i3bar_command, const char *i3bar_command);
-CFGFUN(bar_color, const char *colorclass, const char *border, const char *background, const char *text);
+CFGFUN(bar_color, const char *colorclass, const char *border, const char *background, const char *text, const char *gradient);
 CFGFUN(bar_socket_path, const char *socket_path);
 CFGFUN(bar_tray_output, const char *output);
 CFGFUN(bar_tray_padding, const long spacing_px);
@@ -110,8 +112,12 @@ CFGFUN(bar_workspace_command, const char *command);
 CFGFUN(bar_binding_mode_indicator, const char *value);
 CFGFUN(bar_workspace_buttons, const char *value);
 CFGFUN(bar_workspace_min_width, const long width);
+CFGFUN(bar_status_redraw_interval, const long duration_ms);
 CFGFUN(bar_strip_workspace_numbers, const char *value);
 CFGFUN(bar_strip_workspace_name, const char *value);
+CFGFUN(bar_gradients, const char *value);
+CFGFUN(bar_dithering, const char *value);
+CFGFUN(bar_dither_noise, const char *noise);
 CFGFUN(gradients, const char *value);
 CFGFUN(dithering, const char *value);
 CFGFUN(dither_noise, const char *noise);
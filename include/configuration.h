@@ -195,6 +195,17 @@ struct Config {
      * flag can be delayed using an urgency timer. */
     float workspace_urgency_timer;
 
+    /** Title and icon changes of a window are coalesced so that storms of
+     * property notifies (e.g. a terminal showing the running command) only
+     * lead to one update. By default, changes are coalesced within one event
+     * loop iteration. If set, changes are additionally delayed by up to this
+     * many seconds. */
+    float property_coalesce_interval;
+
+    /** If set, all queued X11 events are handled before the tree is rendered
+     * (once) instead of rendering after each event that needs it. */
+    bool render_batching;
+
     /** Behavior when a window sends a NET_ACTIVE_WINDOW message. */
     enum {
         /* Focus if the target workspace is visible, set urgency hint otherwise. */
@@ -365,6 +376,11 @@ struct Barconfig {
     /** The minimal width for workspace buttons. */
     int workspace_min_width;
 
+    /** The minimal time between two redraws caused by status updates, in
+     * milliseconds (0 redraws on every update). Configuration option is
+     * 'status_redraw_interval 33 ms'. */
+    int status_redraw_interval;
+
     /** Strip workspace numbers? Configuration option is
      * 'strip_workspace_numbers yes'. */
     bool strip_workspace_numbers;
@@ -373,6 +389,17 @@ struct Barconfig {
      * 'strip_workspace_name yes'. */
     bool strip_workspace_name;
 
+    /** Draw the background and the buttons as gradients? Configuration
+     * option is 'gradients yes'. */
+    bool gradients;
+
+    /** Dither the gradients? Configuration option is 'dithering yes'. */
+    bool dithering;
+
+    /** The amount of noise added when dithering. Configuration option is
+     * 'dither_noise 0.5'. */
+    double dither_noise;
+
     /** Hide mode button? Configuration option is 'binding_mode_indicator no'
      * but we invert the bool for the same reason as hide_workspace_buttons.*/
     bool hide_binding_mode_indicator;
@@ -394,25 +421,35 @@ struct Barconfig {
         char *focused_statusline;
         char *focused_separator;
 
+        char *gradient_start;
+        char *gradient_end;
+        char *focused_gradient_start;
+        char *focused_gradient_end;
+
         char *focused_workspace_border;
         char *focused_workspace_bg;
         char *focused_workspace_text;
+        char *focused_workspace_gradient;
 
         char *active_workspace_border;
         char *active_workspace_bg;
         char *active_workspace_text;
+        char *active_workspace_gradient;
 
         char *inactive_workspace_border;
         char *inactive_workspace_bg;
         char *inactive_workspace_text;
+        char *inactive_workspace_gradient;
 
         char *urgent_workspace_border;
         char *urgent_workspace_bg;
         char *urgent_workspace_text;
+        char *urgent_workspace_gradient;
 
         char *binding_mode_border;
         char *binding_mode_bg;
         char *binding_mode_text;
+        char *binding_mode_gradient;
     } colors;
 
     TAILQ_ENTRY(Barconfig) configs;
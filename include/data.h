@@ -514,6 +514,11 @@ struct Window {
     /** Window icon, as Cairo surface */
     cairo_surface_t *icon;
 
+    /** The icon scaled to fit into scaled_icon_size × scaled_icon_size pixels
+     * (see window_get_scaled_icon), or NULL. */
+    cairo_surface_t *scaled_icon;
+    int scaled_icon_size;
+
     /** The window has a nonrectangular shape. */
     bool shaped;
     /** The window has a nonrectangular input shape. */
@@ -732,6 +737,10 @@ struct Con {
     /** Cache for the decoration rendering */
     struct deco_render_params *deco_render_params;
 
+    /** The fields this container was last sent with in a tree_delta event,
+     * see tree_delta.c */
+    struct tree_delta_state *delta_state;
+
     /* Only workspace-containers can have floating clients */
     TAILQ_HEAD(floating_head, Con) floating_head;
 
@@ -14,9 +14,21 @@
 /**
  * Updates all the EWMH desktop properties.
  *
+ * The properties are only marked as changed here and sent by the next
+ * ewmh_flush_properties().
+ *
  */
 void ewmh_update_desktop_properties(void);
 
+/**
+ * Sends all EWMH properties which were changed since the last call. Each
+ * property is sent at most once and only if its value differs from the last
+ * value sent. Called at the end of x_push_changes() and of every event loop
+ * iteration.
+ *
+ */
+void ewmh_flush_properties(void);
+
 /**
  * Updates _NET_CURRENT_DESKTOP with the current desktop number.
  *
@@ -30,6 +42,9 @@ void ewmh_update_current_desktop(void);
  * Updates _NET_WM_DESKTOP for all windows.
  * A request will only be made if the cached value differs from the calculated value.
  *
+ * The update happens with the next ewmh_flush_properties(), so that the tree
+ * is walked at most once per event loop iteration.
+ *
  */
 void ewmh_update_wm_desktop(void);
 
@@ -50,6 +65,9 @@ void ewmh_update_visible_name(xcb_window_t window, const char *name);
 
 /**
  * Updates the _NET_CLIENT_LIST hint. Used for window listers.
+ *
+ * The list is copied and sent by the next ewmh_flush_properties(), unless it
+ * is equal to the last list sent.
  */
 void ewmh_update_client_list(xcb_window_t *list, int num_windows);
 
@@ -62,6 +80,9 @@ void ewmh_update_client_list(xcb_window_t *list, int num_windows);
  * _NET_CLIENT_LIST_STACKING has bottom-to-top stacking order. These properties
  * SHOULD be set and updated by the Window Manager.
  *
+ * The list is copied and sent by the next ewmh_flush_properties(), unless it
+ * is equal to the last list sent.
+ *
  */
 void ewmh_update_client_list_stacking(xcb_window_t *stack, int num_windows);
 
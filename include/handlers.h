@@ -47,3 +47,17 @@ void handle_event(int type, xcb_generic_event_t *event);
  *
  */
 void property_handlers_init(void);
+
+/**
+ * Handles the property changes which were queued because their handler
+ * coalesces notifies. Every window and property is handled once, using the
+ * value the property has now.
+ *
+ * Unless force is true, nothing happens while a coalescing interval is
+ * configured (the timer will call this function when the interval is over).
+ *
+ * Returns true if any change was handled, in which case the caller should
+ * check for new X11 events again.
+ *
+ */
+bool handle_coalesced_property_changes(bool force);
@@ -12,7 +12,6 @@
 #include <config.h>
 
 #include <ev.h>
-#include <yajl/yajl_gen.h>
 #include <yajl/yajl_parse.h>
 
 #include "data.h"
@@ -21,24 +20,79 @@
 
 extern char *current_socketpath;
 
+/**
+ * A serialized message (header and payload) which is queued for sending. The
+ * same chunk is shared by all clients receiving the message (e.g. all
+ * subscribers of an event) and freed once the last of them has written it.
+ *
+ */
+typedef struct ipc_chunk {
+    int refcount;
+    size_t size;
+    uint8_t data[];
+} ipc_chunk;
+
+/**
+ * An entry of a client's output queue.
+ *
+ */
+typedef struct ipc_queued_chunk {
+    ipc_chunk *chunk;
+    /* Number of bytes of the chunk which were already written. */
+    size_t offset;
+
+    TAILQ_ENTRY(ipc_queued_chunk) chunks;
+} ipc_queued_chunk;
+
+/* Number of event types, see I3_IPC_EVENT_* in ipc2.h. */
+#define IPC_EVENT_COUNT 9
+
+/**
+ * A filter of an event subscription: only events which match all of the
+ * specified conditions are sent to the client.
+ *
+ */
+typedef struct ipc_event_filter {
+    /* The values of the "change" field to send, or none to send all. */
+    int num_changes;
+    char **changes;
+
+    /* Criteria which the window of the event needs to match (only for window
+     * events), or NULL. */
+    Match *match;
+
+    TAILQ_ENTRY(ipc_event_filter) filters;
+} ipc_event_filter;
+
 typedef struct ipc_client {
     int fd;
 
-    /* The events which this client wants to receive */
-    int num_events;
-    char **events;
+    /* The events which this client wants to receive, as a bitmask of
+     * (1 << event type). */
+    uint32_t events;
+    /* The events to which this client only subscribed with filters. Such an
+     * event is only sent if one of its filters matches. */
+    uint32_t filtered_events;
+    TAILQ_HEAD(ipc_event_filters, ipc_event_filter) filters[IPC_EVENT_COUNT];
 
     /* For clients which subscribe to the tick event: whether the first tick
      * event has been sent by i3. */
     bool first_tick_sent;
 
+    /* Whether events are sent to this client in CBOR instead of JSON (see
+     * I3_IPC_MESSAGE_FLAG_CBOR). */
+    bool cbor_events;
+
     struct ev_io *read_callback;
     struct ev_io *write_callback;
     struct ev_timer *timeout;
-    uint8_t *buffer;
-    size_t buffer_size;
+
+    /* Messages which were not (completely) written yet, oldest first. */
+    TAILQ_HEAD(ipc_output_queue, ipc_queued_chunk) output_queue;
 
     TAILQ_ENTRY(ipc_client) clients;
+    /* Entries in the subscriber list of each event type. */
+    TAILQ_ENTRY(ipc_client) subscriptions[IPC_EVENT_COUNT];
 } ipc_client;
 
 /*
@@ -78,12 +132,53 @@ void ipc_new_client(EV_P_ struct ev_io *w, int revents);
  */
 ipc_client *ipc_new_client_on_fd(EV_P_ int fd);
 
+/**
+ * Writes the payload of an event to gen. data is the pointer which was passed
+ * to ipc_send_event() or ipc_send_filtered_event().
+ *
+ */
+typedef void (*ipc_event_marshaller)(ipc_gen *gen, void *data);
+
 /**
  * Sends the specified event to all IPC clients which are currently connected
  * and subscribed to this kind of event.
  *
  */
-void ipc_send_event(const char *event, uint32_t message_type, const char *payload);
+void ipc_send_event(const char *event, uint32_t message_type, ipc_event_marshaller marshal, void *data);
+
+/**
+ * Sends the specified event to all IPC clients which are subscribed to this
+ * kind of event and whose subscription filters (if any) match the given
+ * change and container. change and con may be NULL if the event has no change
+ * field or is not about a window.
+ *
+ * The payload is written by marshal(gen, data) when the first receiving
+ * client is found, once per encoding, and shared by all receiving clients.
+ *
+ */
+void ipc_send_filtered_event(const char *event, uint32_t message_type, const char *change, Con *con, ipc_event_marshaller marshal, void *data);
+
+/**
+ * An event which was generated in advance, see ipc_prepare_workspace_event().
+ *
+ */
+typedef struct ipc_prepared_event ipc_prepared_event;
+
+/**
+ * Sends an event generated by ipc_prepare_workspace_event() (if there were
+ * any subscribers for it) and frees it.
+ *
+ */
+void ipc_send_prepared_event(ipc_prepared_event *prepared);
+
+/**
+ * Returns whether any IPC client is subscribed to the given kind of event with
+ * a filter (if any) which matches the given change. Criteria on containers are
+ * not checked. Sending events does not need this, as ipc_send_filtered_event()
+ * only generates events which are received by a client.
+ *
+ */
+bool ipc_has_event_subscribers(uint32_t message_type, const char *change);
 
 /**
  * Calls to ipc_shutdown() should provide a reason for the shutdown.
@@ -102,13 +197,14 @@ typedef enum {
  */
 void ipc_shutdown(shutdown_reason_t reason, int exempt_fd);
 
-void dump_node(yajl_gen gen, Con *con, bool inplace_restart);
+void dump_node(ipc_gen *gen, Con *con, bool inplace_restart);
 
 /**
- * Generates a json workspace event. Returns a dynamically allocated yajl
- * generator. Free with yajl_gen_free().
+ * Generates a workspace event (see ipc_send_workspace_event()) to be sent
+ * with ipc_send_prepared_event() later, e.g. after current was closed.
+ *
  */
-yajl_gen ipc_marshal_workspace_event(const char *change, Con *current, Con *old);
+ipc_prepared_event *ipc_prepare_workspace_event(const char *change, Con *current, Con *old);
 
 /**
  * For the workspace events we send, along with the usual "change" field, also
@@ -133,6 +229,17 @@ void ipc_send_barconfig_update_event(Barconfig *barconfig);
  */
 void ipc_send_binding_event(const char *event_type, Binding *bind, const char *modename);
 
+/**
+ * For the mode events, we send the name of the new binding mode in "change".
+ */
+void ipc_send_mode_event(struct Mode *mode);
+
+/**
+ * Sends the output event, which only says that the outputs changed in some
+ * way.
+ */
+void ipc_send_output_event(void);
+
 /**
  * Set the maximum duration that we allow for a connection with an unwriteable
  * socket.
@@ -27,6 +27,12 @@ typedef struct i3_ipc_header {
 /** Never change this, only on major IPC breakage (don’t do that) */
 #define I3_IPC_MAGIC "i3-ipc"
 
+/** Flag which clients can set in the type of a GET_TREE, GET_WORKSPACES,
+ * GET_OUTPUTS or SUBSCRIBE message to get the reply (or, for SUBSCRIBE, the
+ * events) in CBOR instead of JSON. Messages encoded as CBOR have the flag set
+ * in their type as well. */
+#define I3_IPC_MESSAGE_FLAG_CBOR (1UL << 30)
+
 /** Deprecated: use I3_IPC_MESSAGE_TYPE_RUN_COMMAND */
 #define I3_IPC_MESSAGE_TYPE_COMMAND 0
 
@@ -69,6 +75,16 @@ typedef struct i3_ipc_header {
 /** Request the current binding state. */
 #define I3_IPC_MESSAGE_TYPE_GET_BINDING_STATE 12
 
+/** Request the recorded trace spans (Chrome trace format). */
+#define I3_IPC_MESSAGE_TYPE_GET_TRACE 13
+
+/** Request the input latency histograms. */
+#define I3_IPC_MESSAGE_TYPE_GET_LATENCY 14
+
+/** The payload of the message will be interpreted as a list of commands which
+ * are run as one transaction */
+#define I3_IPC_MESSAGE_TYPE_RUN_TRANSACTION 15
+
 /*
  * Messages from i3 to clients
  *
@@ -86,6 +102,9 @@ typedef struct i3_ipc_header {
 #define I3_IPC_REPLY_TYPE_TICK 10
 #define I3_IPC_REPLY_TYPE_SYNC 11
 #define I3_IPC_REPLY_TYPE_GET_BINDING_STATE 12
+#define I3_IPC_REPLY_TYPE_GET_TRACE 13
+#define I3_IPC_REPLY_TYPE_GET_LATENCY 14
+#define I3_IPC_REPLY_TYPE_TRANSACTION 15
 
 /*
  * Events from i3 to clients. Events have the first bit set high.
@@ -116,3 +135,7 @@ typedef struct i3_ipc_header {
 
 /** The tick event will be sent upon a tick IPC message */
 #define I3_IPC_EVENT_TICK (I3_IPC_EVENT_MASK | 7)
+
+/** The tree_delta event will be sent with the changes of the tree after
+ * rendering */
+#define I3_IPC_EVENT_TREE_DELTA (I3_IPC_EVENT_MASK | 8)
@@ -0,0 +1,55 @@
+/*
+ * vim:ts=4:sw=4:expandtab
+ *
+ * i3 - an improved tiling window manager
+ * © 2009 Michael Stapelberg and contributors (see also: LICENSE)
+ *
+ * latency.c: Measures the latency from receiving input (a binding or an IPC
+ *            command) to flushing the resulting changes to X11.
+ *
+ */
+#pragma once
+
+#include <config.h>
+
+#include <stdint.h>
+
+/**
+ * Returns the histogram name for the class of the given binding (key or
+ * button, press or release).
+ *
+ * Needs to be called before running the binding, as running it might free
+ * the binding (reload).
+ *
+ */
+const char *latency_binding_class(Binding *bind);
+
+/**
+ * Queues a latency measurement which started at start (see trace_now()). It
+ * will be stored in the histogram called name once the changes caused by the
+ * input were flushed to X11 (see latency_record_pending()).
+ *
+ */
+void latency_measure(const char *name, uint64_t start);
+
+/**
+ * Queues a latency measurement for an IPC command (see latency_measure()).
+ * The histogram is named after the command name recorded by the parser
+ * (CommandResult.command_name), so there is at most one per command of the
+ * parser spec.
+ *
+ */
+void latency_measure_command(const char *command_name, uint64_t start);
+
+/**
+ * Stores all queued measurements in their histograms. Called after flushing
+ * the connection to X11 at the end of each event loop iteration.
+ *
+ */
+void latency_record_pending(void);
+
+/**
+ * Dumps all histograms as a JSON array.
+ *
+ */
+void latency_dump_json(ipc_gen *gen);
@@ -19,6 +19,8 @@
 #include <xcb/xcb.h>
 #include <xcb/xproto.h>
 #include <xcb/xcb_keysyms.h>
+#include <yajl/yajl_gen.h>
+#include <yajl/yajl_parse.h>
 
 #include <pango/pango.h>
 #include <cairo/cairo-xcb.h>
@@ -80,6 +82,11 @@ struct Font {
 
             /** Font table for this font (may be NULL) */
             xcb_charinfo_t *table;
+
+            /** Glyph advances for fonts without a font table, one array of
+             * 256 advances per first byte, filled when first needed (NULL
+             * if there is a font table) */
+            int16_t **advances;
         } xcb;
 
         /** The pango font description */
@@ -325,6 +332,118 @@ int ipc_send_message(int sockfd, const uint32_t message_size,
 int ipc_recv_message(int sockfd, uint32_t *message_type,
                      uint32_t *reply_length, uint8_t **reply);
 
+/**
+ * A buffered reader for IPC messages, see ipc_reader_new().
+ *
+ */
+typedef struct ipc_reader_t ipc_reader_t;
+
+/**
+ * Creates a buffered reader for the IPC messages arriving on the given socket.
+ * Unlike ipc_recv_message(), the reader never blocks and reads as many
+ * messages as are available at once, which is useful when sending several
+ * messages before reading the replies (pipelining).
+ *
+ */
+ipc_reader_t *ipc_reader_new(int sockfd);
+
+/**
+ * Frees the reader (but does not close its socket).
+ *
+ */
+void ipc_reader_free(ipc_reader_t *reader);
+
+/**
+ * Reads everything which is available on the socket into the buffer, without
+ * blocking (the socket itself does not have to be non-blocking). Payloads
+ * previously returned by ipc_reader_next() are invalid afterwards.
+ *
+ * Returns -1 when read() fails, errno will remain.
+ * Returns -2 on EOF.
+ * Returns the number of bytes read otherwise (0 if nothing was available).
+ *
+ */
+ssize_t ipc_reader_fill(ipc_reader_t *reader);
+
+/**
+ * Returns the next complete message from the buffer. The payload points into
+ * the buffer of the reader and is valid until the next call of
+ * ipc_reader_fill().
+ *
+ * Returns 1 if a message was returned.
+ * Returns 0 if there is no complete message, call ipc_reader_fill() when the
+ * socket is readable again.
+ * Returns -3 when the IPC protocol is violated (invalid magic). Additionally,
+ * the error will be printed to stderr.
+ *
+ */
+int ipc_reader_next(ipc_reader_t *reader, uint32_t *message_type,
+                    uint32_t *message_length, const uint8_t **payload);
+
+/**
+ * Generator for IPC messages, which writes either JSON or the CBOR encoding
+ * (see I3_IPC_MESSAGE_FLAG_CBOR). The y() and ystr() macros of yajl_utils.h
+ * use it instead of a yajl_gen, so the same code produces both encodings.
+ *
+ */
+typedef struct ipc_gen ipc_gen;
+
+/**
+ * Allocates a generator for IPC messages, which writes the JSON encoding or,
+ * if cbor is true, the CBOR encoding (see I3_IPC_MESSAGE_FLAG_CBOR). Use it
+ * through the y() and ystr() macros of yajl_utils.h, just like a yajl_gen.
+ *
+ */
+ipc_gen *ipc_gen_alloc(bool cbor);
+
+/**
+ * Frees the generator and its buffer.
+ *
+ */
+void ipc_gen_free(ipc_gen *gen);
+
+/**
+ * Returns true if the generator writes the CBOR encoding.
+ *
+ */
+bool ipc_gen_is_cbor(ipc_gen *gen);
+
+/**
+ * Returns the message generated so far. The buffer belongs to the generator
+ * and is valid until the next call of any other ipc_gen function.
+ *
+ */
+yajl_gen_status ipc_gen_get_buf(ipc_gen *gen, const unsigned char **buf, size_t *len);
+
+/**
+ * Discards the message generated so far, so that the generator can be used
+ * for the next one.
+ *
+ */
+void ipc_gen_clear(ipc_gen *gen);
+
+/* The equivalents of yajl_gen_null() etc. */
+yajl_gen_status ipc_gen_null(ipc_gen *gen);
+yajl_gen_status ipc_gen_bool(ipc_gen *gen, int val);
+yajl_gen_status ipc_gen_integer(ipc_gen *gen, long long val);
+yajl_gen_status ipc_gen_double(ipc_gen *gen, double val);
+yajl_gen_status ipc_gen_string(ipc_gen *gen, const unsigned char *val, size_t len);
+yajl_gen_status ipc_gen_map_open(ipc_gen *gen);
+yajl_gen_status ipc_gen_map_close(ipc_gen *gen);
+yajl_gen_status ipc_gen_array_open(ipc_gen *gen);
+yajl_gen_status ipc_gen_array_close(ipc_gen *gen);
+
+/**
+ * Parses a CBOR-encoded IPC message (see I3_IPC_MESSAGE_FLAG_CBOR) and calls
+ * the given yajl callbacks for its contents, just like yajl_parse() would for
+ * the JSON encoding. This allows clients to use the same callbacks for both
+ * encodings.
+ *
+ * Returns false if the message is malformed or a callback returned 0.
+ *
+ */
+bool ipc_cbor_parse(const uint8_t *cbor, size_t cbor_length, const yajl_callbacks *callbacks, void *ctx);
+
 /**
  * Generates a configure_notify event and sends it to the given window
  * Applications need this to think they’ve configured themselves correctly.
@@ -634,10 +753,26 @@ void draw_util_rectangle(surface_t *surface, color_t color, double x, double y,
 
 /**
     i3-gradients addition: takes a start and end color to draw a gradient
+    Dithered gradients are rasterized once per size, colors and noise and then
+    painted from a cache.
 */
 
 void draw_util_rectangle_gradient(surface_t *surface, color_t startColor, color_t endColor, double x, double y, double w, double h, bool use_dithering, double dither_noise, double offsetStart, double offsetEnd);
 
+/**
+ * Restricts the following drawing operations on the surface to the given
+ * rectangle, until draw_util_reset_clip() is called. This does not apply to
+ * text drawn with core X fonts.
+ *
+ */
+void draw_util_set_clip(surface_t *surface, double x, double y, double w, double h);
+
+/**
+ * Removes the restriction set with draw_util_set_clip().
+ *
+ */
+void draw_util_reset_clip(surface_t *surface);
+
 /**
  * Clears a surface with the given color.
  *
@@ -0,0 +1,96 @@
+/*
+ * vim:ts=4:sw=4:expandtab
+ *
+ * i3 - an improved tiling window manager
+ * © 2009 Michael Stapelberg and contributors (see also: LICENSE)
+ *
+ * The format of the shared memory snapshot of the container tree, which i3
+ * publishes after rendering (see I3_STATE_PATH and docs/ipc).
+ *
+ */
+#pragma once
+
+#include <config.h>
+
+#include <stdint.h>
+
+/* "i3st" in little endian */
+#define I3_SHMSTATE_MAGIC 0x74733369
+#define I3_SHMSTATE_VERSION 1
+
+/* Flags of i3_shmstate_con */
+#define I3_SHMSTATE_FOCUSED (1 << 0)    /* the focused container */
+#define I3_SHMSTATE_ACTIVE (1 << 1)     /* first in the focus stack of its parent */
+#define I3_SHMSTATE_URGENT (1 << 2)     /* urgent or containing an urgent window */
+#define I3_SHMSTATE_FLOATING (1 << 3)   /* floating window or its floating_con */
+#define I3_SHMSTATE_FULLSCREEN (1 << 4) /* in fullscreen mode */
+#define I3_SHMSTATE_STICKY (1 << 5)     /* sticky floating window */
+
+/**
+ * Header at the beginning of the shared memory segment.
+ *
+ * The segment is protected by a sequence lock: i3 makes sequence odd before it
+ * changes anything and even again afterwards. Readers have to load sequence
+ * (with acquire semantics), retry while it is odd, copy what they need and
+ * check that sequence is still the same afterwards — otherwise, they have to
+ * retry. Readers must not trust any offset before the sequence check passed.
+ *
+ */
+typedef struct i3_shmstate_header {
+    uint32_t magic;
+    uint32_t version;
+
+    /* Sequence lock, incremented by two with every change of the snapshot. */
+    uint32_t sequence;
+
+    /* The size of the segment in bytes. It only grows; if it is larger than
+     * the size a reader mapped, the reader has to map the segment again. */
+    uint32_t size;
+
+    /* Number of containers and byte offset of the first one (an array of
+     * i3_shmstate_con). */
+    uint32_t num_cons;
+    uint32_t cons_offset;
+
+    /* Byte offset and size of the NUL-terminated (UTF-8) strings. */
+    uint32_t strings_offset;
+    uint32_t strings_size;
+} i3_shmstate_header;
+
+/**
+ * A container. The containers are in depth-first order (tiling children
+ * before floating children), so parents always come before their children.
+ *
+ */
+typedef struct i3_shmstate_con {
+    /* The container id, the same as the "id" in the IPC interface. */
+    uint64_t id;
+    /* The id of the parent container, 0 for the root container. */
+    uint64_t parent;
+    /* The id of the workspace containing the container (or the workspace
+     * itself), 0 for containers outside of workspaces. */
+    uint64_t workspace;
+
+    /* The X11 window id, 0 for containers without a window. */
+    uint32_t window;
+    /* The type, like the "type" in the IPC interface: 0 = root, 1 = output,
+     * 2 = con, 3 = floating_con, 4 = workspace, 5 = dockarea. */
+    uint32_t type;
+
+    int32_t x;
+    int32_t y;
+    uint32_t width;
+    uint32_t height;
+
+    /* I3_SHMSTATE_* flags */
+    uint32_t flags;
+
+    /* Offset of the name (the window title for windows) from strings_offset,
+     * and its length in bytes (without the NUL byte). */
+    uint32_t name_offset;
+    uint32_t name_length;
+
+    /* The workspace number, -1 for workspaces without a number and for other
+     * containers. */
+    int32_t num;
+} i3_shmstate_con;
@@ -0,0 +1,36 @@
+/*
+ * vim:ts=4:sw=4:expandtab
+ *
+ * i3 - an improved tiling window manager
+ * © 2009 Michael Stapelberg and contributors (see also: LICENSE)
+ *
+ * state_snapshot.c: Publishes a snapshot of the container tree in shared
+ *                   memory after rendering (see shmstate.h for the format).
+ *
+ */
+#pragma once
+
+#include <config.h>
+
+/* The name of the SHM segment (/i3-state-%pid), or NULL if there is none. */
+extern char *state_snapshot_path;
+
+/**
+ * Creates the SHM segment for the state snapshot. On failure, the snapshot
+ * stays disabled.
+ *
+ */
+void state_snapshot_open(void);
+
+/**
+ * Unmaps and removes the SHM segment of the state snapshot.
+ *
+ */
+void state_snapshot_close(void);
+
+/**
+ * Updates the state snapshot if the tree changed. Called after rendering the
+ * tree.
+ *
+ */
+void state_snapshot_update(void);
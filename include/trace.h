@@ -0,0 +1,79 @@
+/*
+ * vim:ts=4:sw=4:expandtab
+ *
+ * i3 - an improved tiling window manager
+ * © 2009 Michael Stapelberg and contributors (see also: LICENSE)
+ *
+ * trace.c: Records spans of the event loop (X11 event dispatch, commands,
+ *          rendering, IPC) into a ring buffer, dumped in Chrome trace format.
+ *
+ */
+#pragma once
+
+#include <config.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Whether spans are recorded. Checked inline so that tracing costs a single
+ * branch per trace point while it is disabled. */
+extern bool trace_enabled;
+
+/**
+ * A span which is being measured. Declared via TRACE_SPAN, which records it
+ * automatically when the enclosing scope is left.
+ *
+ */
+typedef struct trace_span {
+    /* Static string, e.g. "render_con". */
+    const char *name;
+    /* Optional detail (e.g. the command), copied when recording. */
+    const char *detail;
+    /* Optional numeric argument (e.g. the X11 event type), -1 if unused. */
+    int64_t arg;
+    /* Start timestamp in nanoseconds, 0 if tracing was disabled. */
+    uint64_t start;
+} trace_span;
+
+/**
+ * Returns the current CLOCK_MONOTONIC time in nanoseconds.
+ *
+ */
+uint64_t trace_now(void);
+
+/**
+ * Stores the given span (ending now) in the ring buffer.
+ *
+ */
+void trace_record(trace_span *span);
+
+static inline void trace_span_end(trace_span *span) {
+    if (span->start != 0) {
+        trace_record(span);
+    }
+}
+
+/* Measures the rest of the enclosing scope as a span called name. */
+#define TRACE_SPAN(var, name, detail, arg)                                    \
+    trace_span var __attribute__((cleanup(trace_span_end))) = {               \
+        (name), (detail), (arg), (trace_enabled ? trace_now() : 0)}
+
+/**
+ * Enables or disables tracing. The ring buffer is allocated when tracing is
+ * enabled for the first time and kept (with its contents) afterwards.
+ *
+ */
+void trace_set_enabled(bool enabled);
+
+/**
+ * Returns a human readable name for the given X11 event type.
+ *
+ */
+const char *trace_x_event_name(int type);
+
+/**
+ * Dumps all recorded spans, oldest first, as a Chrome trace format JSON object
+ * (viewable in chrome://tracing or Perfetto).
+ *
+ */
+void trace_dump_json(ipc_gen *gen);
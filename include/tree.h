@@ -58,6 +58,45 @@ bool level_down(void);
  */
 void tree_render(void);
 
+/**
+ * Enables or disables render batching. While batching is enabled,
+ * tree_render() only records that the tree needs to be rendered. Calls nest:
+ * every enable has to be paired with a disable, and the last disable renders
+ * the tree once if it was requested in the meantime.
+ *
+ */
+void tree_render_set_batching(bool enable);
+
+/**
+ * Turns render batching off entirely (rendering a pending tree) until
+ * tree_render_resume_batching() is called with the returned depth. Used by
+ * modal event loops, whose renders need to take effect right away.
+ *
+ */
+int tree_render_suspend_batching(void);
+
+/**
+ * Restores the render batching depth returned by
+ * tree_render_suspend_batching().
+ *
+ */
+void tree_render_resume_batching(int depth);
+
+/**
+ * Renders the tree right away if a render was requested while batching. Used
+ * when a client must observe the rendered state, e.g. before replying to a
+ * sync request.
+ *
+ */
+void tree_render_flush(void);
+
+/**
+ * Returns true if a render was requested while batching, i.e. the changes
+ * will be pushed to X11 once batching is disabled.
+ *
+ */
+bool tree_render_is_pending(void);
+
 /**
  * Changes focus in the given direction
  *
@@ -0,0 +1,46 @@
+/*
+ * vim:ts=4:sw=4:expandtab
+ *
+ * i3 - an improved tiling window manager
+ * © 2009 Michael Stapelberg and contributors (see also: LICENSE)
+ *
+ * tree_delta.c: Sends the changes of the container tree since the last
+ *               rendering to clients subscribed to the tree_delta event.
+ *
+ */
+#pragma once
+
+#include <config.h>
+
+#include <stdint.h>
+
+/**
+ * Starts tracking the containers (unless they are tracked already), so that
+ * the next tree_delta event contains the changes from now on. Called when a
+ * client subscribes to the tree_delta event.
+ *
+ */
+void tree_delta_start(void);
+
+/**
+ * Sends a tree_delta event with the containers which were added, removed or
+ * changed since the last call (if any). Called after rendering the tree.
+ *
+ * Containers are only tracked while there are subscribers to the tree_delta
+ * event.
+ *
+ */
+void tree_delta_send(void);
+
+/**
+ * Needs to be called when a container is freed, so that its removal is
+ * included in the next tree_delta event.
+ *
+ */
+void tree_delta_con_freed(Con *con);
+
+/**
+ * Returns the generation of the last tree_delta event.
+ *
+ */
+uint64_t tree_delta_generation(void);
@@ -107,3 +107,10 @@ void window_update_machine(i3Window *win, xcb_get_property_reply_t *prop);
  *
  */
 void window_update_icon(i3Window *win, xcb_get_property_reply_t *prop);
+
+/**
+ * Returns the window icon scaled to fit into a square of the given size. The
+ * scaled icon is cached until the icon or the size changes.
+ *
+ */
+cairo_surface_t *window_get_scaled_icon(i3Window *win, int size);
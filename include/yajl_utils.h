@@ -15,10 +15,10 @@
 #include <yajl/yajl_parse.h>
 #include <yajl/yajl_version.h>
 
-/* Shorter names for all those yajl_gen_* functions */
-#define y(x, ...) yajl_gen_##x(gen, ##__VA_ARGS__)
-#define ystr(str) yajl_gen_string(gen, (unsigned char *)str, strlen(str))
+/* Shorter names for all those ipc_gen_* functions (see libi3.h) */
+#define y(x, ...) ipc_gen_##x(gen, ##__VA_ARGS__)
+#define ystr(str) ipc_gen_string(gen, (unsigned char *)str, strlen(str))
 
-#define ygenalloc() yajl_gen_alloc(NULL)
+#define ygenalloc() ipc_gen_alloc(false)
 #define yalloc(callbacks, client) yajl_alloc(callbacks, NULL, client)
 typedef size_t ylength;
@@ -7,8 +7,10 @@
  *
  */
 #include "libi3.h"
+#include "queue.h"
 
 #include <math.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -307,83 +309,160 @@ double lerp_double(double a, double b, double t)
     return a + (b - a) * t;
 }
 
-void draw_util_rectangle_gradient(surface_t *surface, color_t startColor, color_t endColor, double x, double y, double w, double h, bool use_dithering, double noise_gain, double offsetStart, double offsetEnd) {
-    // feature ideas:
-    // - control offset?
+/*
+ * A cache of rasterized dithered gradients, most recently used first. Window
+ * decorations and bars only come in a few sizes, so the pixels of a gradient
+ * are computed once and then painted from the cache.
+ *
+ */
+typedef struct gradient_cache_entry {
+    color_t start;
+    color_t end;
+    int width;
+    int height;
+    double noise_gain;
+
+    cairo_surface_t *image;
+
+    TAILQ_ENTRY(gradient_cache_entry) entries;
+} gradient_cache_entry;
+
+static TAILQ_HEAD(gradient_cache_head, gradient_cache_entry) gradient_cache =
+    TAILQ_HEAD_INITIALIZER(gradient_cache);
+static int gradient_cache_size = 0;
 
+/* Enough for the title widths of a few layouts and the bars of a few outputs. */
+#define GRADIENT_CACHE_MAX_SIZE 32
+
+static bool same_rgb(color_t a, color_t b) {
+    return a.red == b.red && a.green == b.green && a.blue == b.blue;
+}
+
+/*
+ * Computes the pixels of a horizontal gradient with ordered dithering.
+ * Returns NULL if the image surface could not be created.
+ *
+ */
+static cairo_surface_t *rasterize_dithered_gradient(color_t startColor, color_t endColor, int width, int height, double noise_gain) {
     // TODO: implement reading these vars in the config! this is temporary!
     const int num_colors = 256;
     const int N = num_colors - 1;
 
-    if (!surface_initialized(surface)) {
-        return;
+    cairo_surface_t *image_surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    if (cairo_surface_status(image_surface) != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(image_surface);
+        return NULL;
     }
 
-    if (use_dithering) {
-        int width = floor(w);
-        int height = floor(h);
-        int stride = width * sizeof(int);
+    cairo_surface_flush(image_surface);
+    unsigned char *data = cairo_image_surface_get_data(image_surface);
+    const int stride = cairo_image_surface_get_stride(image_surface);
 
-        unsigned int *pixels = malloc(width * height * sizeof(int));
+    double r0 = startColor.red, g0 = startColor.green, b0 = startColor.blue;
+    double r1 = endColor.red, g1 = endColor.green, b1 = endColor.blue;
 
-        if (pixels == NULL) {
-            // fallback: draw gradients if we can't dither for some reason
-            goto draw_nondithered;
-        }        
+    for (int j = 0; j < height; ++j) {
+        uint32_t *pixels = (uint32_t *)(data + j * stride);
+        for (int i = 0; i < width; ++i) {
+            double t = (double)i / (double)width;
 
-        double r0 = startColor.red, g0 = startColor.green, b0 = startColor.blue;
-        double r1 = endColor.red, g1 = endColor.green, b1 = endColor.blue;
+            double r = lerp_double(r0, r1, t);
+            double g = lerp_double(g0, g1, t);
+            double b = lerp_double(b0, b1, t);
 
-        for(int j = 0; j < height; ++j) {                        
-            for(int i = 0; i < width; ++i) {
-                double t = (double)i / (double)width;            
+            // color quantization
+            double r_q = floor(r * (double)N + 0.5) / (double)N;
+            double g_q = floor(g * (double)N + 0.5) / (double)N;
+            double b_q = floor(b * (double)N + 0.5) / (double)N;
 
-                double r = lerp_double(r0, r1, t);
-                double g = lerp_double(g0, g1, t);
-                double b = lerp_double(b0, b1, t);
+            int s_x = i % THRESHOLD_MAP_DIMENSION;
+            int s_y = j % THRESHOLD_MAP_DIMENSION;
 
-                // color quantization
-                double r_q = floor(r * (double)N + 0.5) / (double)N;
-                double g_q = floor(g * (double)N + 0.5) / (double)N;
-                double b_q = floor(b * (double)N + 0.5) / (double)N;
-                
-                int s_x = i % THRESHOLD_MAP_DIMENSION;
-                int s_y = j % THRESHOLD_MAP_DIMENSION;
+            double m_s = threshold_map[s_y * THRESHOLD_MAP_DIMENSION + s_x];
 
-                double m_s = threshold_map[s_y * THRESHOLD_MAP_DIMENSION + s_x];
+            double noise = (m_s / (double)(THRESHOLD_MAP_SIZE)) - 0.5;
 
-                double noise = (m_s / (double)(THRESHOLD_MAP_SIZE)) - 0.5;
+            r_q = clamp_double(r_q + noise * noise_gain, 0.0, 1.0);
+            g_q = clamp_double(g_q + noise * noise_gain, 0.0, 1.0);
+            b_q = clamp_double(b_q + noise * noise_gain, 0.0, 1.0);
 
-                r_q = clamp_double(r_q + noise * noise_gain, 0.0, 1.0);
-                g_q = clamp_double(g_q + noise * noise_gain, 0.0, 1.0);
-                b_q = clamp_double(b_q + noise * noise_gain, 0.0, 1.0);
+            unsigned char r_c = (unsigned char)(floor(r_q * 255.0));
+            unsigned char g_c = (unsigned char)(floor(g_q * 255.0));
+            unsigned char b_c = (unsigned char)(floor(b_q * 255.0));
 
-                unsigned char r_c = (unsigned char)(floor(r_q * 255.0));
-                unsigned char g_c = (unsigned char)(floor(g_q * 255.0));
-                unsigned char b_c = (unsigned char)(floor(b_q * 255.0));
+            // pixel format is ARGB32
+            uint32_t pixel = 0xFF000000;
+            pixel |= ((uint32_t)r_c) << 16;
+            pixel |= ((uint32_t)g_c) << 8;
+            pixel |= ((uint32_t)b_c);
 
-                // pixel format is ARGB32
-                unsigned int pixel = 0xFF000000;
-                pixel |= ((unsigned int)r_c) << 16;
-                pixel |= ((unsigned int)g_c) << 8;
-                pixel |= ((unsigned int)b_c);
+            pixels[i] = pixel;
+        }
+    }
 
-                pixels[j * width + i] = pixel;
+    cairo_surface_mark_dirty(image_surface);
+    return image_surface;
+}
+
+/*
+ * Returns the rasterized dithered gradient of the given size and colors,
+ * computing it if it is not cached. The surface belongs to the cache.
+ *
+ */
+static cairo_surface_t *get_dithered_gradient(color_t startColor, color_t endColor, int width, int height, double noise_gain) {
+    gradient_cache_entry *entry;
+    TAILQ_FOREACH (entry, &gradient_cache, entries) {
+        if (entry->width == width &&
+            entry->height == height &&
+            entry->noise_gain == noise_gain &&
+            same_rgb(entry->start, startColor) &&
+            same_rgb(entry->end, endColor)) {
+            if (entry != TAILQ_FIRST(&gradient_cache)) {
+                TAILQ_REMOVE(&gradient_cache, entry, entries);
+                TAILQ_INSERT_HEAD(&gradient_cache, entry, entries);
             }
+            return entry->image;
         }
+    }
 
-        cairo_surface_t *image_surface = cairo_image_surface_create_for_data((unsigned char*)pixels,
-                                                                             CAIRO_FORMAT_ARGB32,
-                                                                             width,
-                                                                             height,
-                                                                             stride);
+    cairo_surface_t *image = rasterize_dithered_gradient(startColor, endColor, width, height, noise_gain);
+    if (image == NULL) {
+        return NULL;
+    }
 
-        if (cairo_surface_status(image_surface) != CAIRO_STATUS_SUCCESS) {
-            if (pixels) free(pixels);
-            // fallback: draw gradients if we can't dither for some reason
-            goto draw_nondithered;
-        }
+    if (gradient_cache_size == GRADIENT_CACHE_MAX_SIZE) {
+        entry = TAILQ_LAST(&gradient_cache, gradient_cache_head);
+        TAILQ_REMOVE(&gradient_cache, entry, entries);
+        cairo_surface_destroy(entry->image);
+    } else {
+        entry = smalloc(sizeof(gradient_cache_entry));
+        gradient_cache_size++;
+    }
+
+    entry->start = startColor;
+    entry->end = endColor;
+    entry->width = width;
+    entry->height = height;
+    entry->noise_gain = noise_gain;
+    entry->image = image;
+    TAILQ_INSERT_HEAD(&gradient_cache, entry, entries);
+    return image;
+}
 
+void draw_util_rectangle_gradient(surface_t *surface, color_t startColor, color_t endColor, double x, double y, double w, double h, bool use_dithering, double noise_gain, double offsetStart, double offsetEnd) {
+    // feature ideas:
+    // - control offset?
+
+    if (!surface_initialized(surface)) {
+        return;
+    }
+
+    cairo_surface_t *image_surface = NULL;
+    if (use_dithering && floor(w) > 0 && floor(h) > 0) {
+        image_surface = get_dithered_gradient(startColor, endColor, floor(w), floor(h), noise_gain);
+    }
+
+    if (image_surface != NULL) {
         cairo_save(surface->cr);
         cairo_set_operator(surface->cr, CAIRO_OPERATOR_SOURCE);
 
@@ -397,13 +476,8 @@ void draw_util_rectangle_gradient(surface_t *surface, color_t startColor, color_
 
         CAIRO_SURFACE_FLUSH(surface->surface);
         cairo_restore(surface->cr);
-
-        cairo_surface_destroy(image_surface);
-        free(pixels);
-    }
-
-    else {
-    draw_nondithered:
+    } else {
+        // fallback: draw gradients if we can't dither for some reason
         cairo_save(surface->cr);
 
         cairo_set_operator(surface->cr, CAIRO_OPERATOR_SOURCE);
@@ -411,8 +485,8 @@ void draw_util_rectangle_gradient(surface_t *surface, color_t startColor, color_
         // Create a linear gradient from top-left to bottom-right of the rectangle
         cairo_pattern_t *pattern = cairo_pattern_create_linear(x, y, x + w, y + h);
 
-        cairo_pattern_add_color_stop_rgba(pattern, offsetStart, startColor.red, startColor.green, startColor.blue, startColor.alpha); 
-        cairo_pattern_add_color_stop_rgba(pattern, offsetEnd, endColor.red, endColor.green, endColor.blue, endColor.alpha); 
+        cairo_pattern_add_color_stop_rgba(pattern, offsetStart, startColor.red, startColor.green, startColor.blue, startColor.alpha);
+        cairo_pattern_add_color_stop_rgba(pattern, offsetEnd, endColor.red, endColor.green, endColor.blue, endColor.alpha);
 
         cairo_set_source(surface->cr, pattern);
         cairo_rectangle(surface->cr, x, y, w, h);
@@ -420,10 +494,40 @@ void draw_util_rectangle_gradient(surface_t *surface, color_t startColor, color_
 
         CAIRO_SURFACE_FLUSH(surface->surface);
 
-        cairo_pattern_destroy(pattern);       
+        cairo_pattern_destroy(pattern);
         cairo_restore(surface->cr);
     }
 }
+
+/*
+ * Restricts the following drawing operations on the surface to the given
+ * rectangle, until draw_util_reset_clip() is called. This does not apply to
+ * text drawn with core X fonts.
+ *
+ */
+void draw_util_set_clip(surface_t *surface, double x, double y, double w, double h) {
+    if (!surface_initialized(surface)) {
+        return;
+    }
+
+    cairo_save(surface->cr);
+    cairo_rectangle(surface->cr, x, y, w, h);
+    cairo_clip(surface->cr);
+    cairo_new_path(surface->cr);
+}
+
+/*
+ * Removes the restriction set with draw_util_set_clip().
+ *
+ */
+void draw_util_reset_clip(surface_t *surface) {
+    if (!surface_initialized(surface)) {
+        return;
+    }
+
+    cairo_restore(surface->cr);
+}
+
 /*
  * Clears a surface with the given color.
  *
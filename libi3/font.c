@@ -6,6 +6,7 @@
  *
  */
 #include "libi3.h"
+#include "queue.h"
 
 #include <assert.h>
 #include <cairo/cairo-xcb.h>
@@ -78,6 +79,152 @@ static bool load_pango_font(i3Font *font, const char *desc) {
     return true;
 }
 
+/*
+ * Shaped Pango layouts, most recently used first. Shaping the text (itemizing
+ * it, picking the fonts and glyphs) is the expensive part of drawing it, while
+ * the same window titles and bar blocks are measured and drawn over and over
+ * again.
+ *
+ */
+typedef struct layout_cache_entry {
+    /* The key. The font is only compared by pointer, the cache is cleared
+     * when a font is freed. */
+    const PangoFontDescription *font;
+    long dpi;
+    bool pango_markup;
+    uint32_t hash;
+    char *text;
+    size_t text_len;
+
+    PangoLayout *layout;
+    /* The size of the text without ellipsizing, in Pango units and pixels. */
+    int width;
+    int pixel_width;
+
+    TAILQ_ENTRY(layout_cache_entry) entries;
+} layout_cache_entry;
+
+static TAILQ_HEAD(layout_cache_head, layout_cache_entry) layout_cache =
+    TAILQ_HEAD_INITIALIZER(layout_cache);
+static int layout_cache_size = 0;
+
+/* Enough for the titles of all visible windows and the blocks of a few bars. */
+#define LAYOUT_CACHE_MAX_SIZE 128
+
+/* A dummy surface for layouts which are measured before they are drawn. */
+static cairo_surface_t *measure_surface = NULL;
+static cairo_t *measure_cr = NULL;
+
+static uint32_t hash_text(const char *text, size_t text_len) {
+    /* FNV-1a */
+    uint32_t hash = 2166136261U;
+    for (size_t i = 0; i < text_len; i++) {
+        hash ^= (uint8_t)text[i];
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+static void free_layout_cache_entry(layout_cache_entry *entry) {
+    g_object_unref(entry->layout);
+    free(entry->text);
+    free(entry);
+}
+
+/*
+ * Frees all cached layouts.
+ *
+ */
+static void clear_layout_cache(void) {
+    while (!TAILQ_EMPTY(&layout_cache)) {
+        layout_cache_entry *entry = TAILQ_FIRST(&layout_cache);
+        TAILQ_REMOVE(&layout_cache, entry, entries);
+        free_layout_cache_entry(entry);
+    }
+    layout_cache_size = 0;
+
+    if (measure_cr != NULL) {
+        cairo_destroy(measure_cr);
+        cairo_surface_destroy(measure_surface);
+        measure_cr = NULL;
+        measure_surface = NULL;
+    }
+}
+
+/*
+ * Returns the shaped layout of the given text in the current font, creating it
+ * (with the context of cr, or a dummy one if cr is NULL) if it is not cached.
+ * The layout belongs to the cache.
+ *
+ */
+static layout_cache_entry *get_layout(const char *text, size_t text_len, bool pango_markup, cairo_t *cr) {
+    const PangoFontDescription *font = savedFont->specific.pango_desc;
+    const long dpi = get_dpi_value();
+    const uint32_t hash = hash_text(text, text_len);
+
+    layout_cache_entry *entry;
+    TAILQ_FOREACH (entry, &layout_cache, entries) {
+        if (entry->hash == hash &&
+            entry->text_len == text_len &&
+            entry->font == font &&
+            entry->dpi == dpi &&
+            entry->pango_markup == pango_markup &&
+            memcmp(entry->text, text, text_len) == 0) {
+            if (entry != TAILQ_FIRST(&layout_cache)) {
+                TAILQ_REMOVE(&layout_cache, entry, entries);
+                TAILQ_INSERT_HEAD(&layout_cache, entry, entries);
+            }
+            return entry;
+        }
+    }
+
+    if (layout_cache_size == LAYOUT_CACHE_MAX_SIZE) {
+        entry = TAILQ_LAST(&layout_cache, layout_cache_head);
+        TAILQ_REMOVE(&layout_cache, entry, entries);
+        free_layout_cache_entry(entry);
+    } else {
+        layout_cache_size++;
+    }
+
+    if (cr == NULL) {
+        if (measure_cr == NULL) {
+            /* root_visual_type is cached in load_pango_font */
+            measure_surface = cairo_xcb_surface_create(conn, root_screen->root, root_visual_type, 1, 1);
+            measure_cr = cairo_create(measure_surface);
+        }
+        cr = measure_cr;
+    }
+
+    entry = scalloc(1, sizeof(layout_cache_entry));
+    entry->font = font;
+    entry->dpi = dpi;
+    entry->pango_markup = pango_markup;
+    entry->hash = hash;
+    entry->text = smalloc(text_len + 1);
+    memcpy(entry->text, text, text_len);
+    entry->text[text_len] = '\0';
+    entry->text_len = text_len;
+
+    entry->layout = create_layout_with_dpi(cr);
+    pango_layout_set_font_description(entry->layout, font);
+    /* Only take effect once a width is set, see draw_text_pango. */
+    pango_layout_set_wrap(entry->layout, PANGO_WRAP_CHAR);
+    pango_layout_set_ellipsize(entry->layout, PANGO_ELLIPSIZE_END);
+
+    if (pango_markup) {
+        pango_layout_set_markup(entry->layout, text, text_len);
+    } else {
+        pango_layout_set_text(entry->layout, text, text_len);
+    }
+
+    pango_cairo_update_layout(cr, entry->layout);
+    pango_layout_get_size(entry->layout, &(entry->width), NULL);
+    pango_layout_get_pixel_size(entry->layout, &(entry->pixel_width), NULL);
+
+    TAILQ_INSERT_HEAD(&layout_cache, entry, entries);
+    return entry;
+}
+
 /*
  * Draws text using Pango rendering.
  *
@@ -85,22 +232,16 @@ static bool load_pango_font(i3Font *font, const char *desc) {
 static void draw_text_pango(const char *text, size_t text_len,
                             xcb_drawable_t drawable, cairo_surface_t *surface,
                             int x, int y, int max_width, bool pango_markup) {
-    /* Create the Pango layout */
-    /* root_visual_type is cached in load_pango_font */
     cairo_t *cr = cairo_create(surface);
-    PangoLayout *layout = create_layout_with_dpi(cr);
+    layout_cache_entry *entry = get_layout(text, text_len, pango_markup, cr);
+    PangoLayout *layout = entry->layout;
     gint height;
 
-    pango_layout_set_font_description(layout, savedFont->specific.pango_desc);
-    pango_layout_set_width(layout, max_width * PANGO_SCALE);
-    pango_layout_set_wrap(layout, PANGO_WRAP_CHAR);
-    pango_layout_set_ellipsize(layout, PANGO_ELLIPSIZE_END);
-
-    if (pango_markup) {
-        pango_layout_set_markup(layout, text, text_len);
-    } else {
-        pango_layout_set_text(layout, text, text_len);
-    }
+    /* Changing the width makes Pango lay out the text again, so the width is
+     * only set when the text has to be ellipsized. Text which fits looks the
+     * same either way. */
+    const int width = max_width * PANGO_SCALE;
+    pango_layout_set_width(layout, (width >= 0 && entry->width > width ? width : -1));
 
     /* Do the drawing */
     cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
@@ -113,7 +254,6 @@ static void draw_text_pango(const char *text, size_t text_len,
     pango_cairo_show_layout(cr, layout);
 
     /* Free resources */
-    g_object_unref(layout);
     cairo_destroy(cr);
 }
 
@@ -122,31 +262,7 @@ static void draw_text_pango(const char *text, size_t text_len,
  *
  */
 static int predict_text_width_pango(const char *text, size_t text_len, bool pango_markup) {
-    /* Create a dummy Pango layout */
-    /* root_visual_type is cached in load_pango_font */
-    cairo_surface_t *surface = cairo_xcb_surface_create(conn, root_screen->root, root_visual_type, 1, 1);
-    cairo_t *cr = cairo_create(surface);
-    PangoLayout *layout = create_layout_with_dpi(cr);
-
-    /* Get the font width */
-    gint width;
-    pango_layout_set_font_description(layout, savedFont->specific.pango_desc);
-
-    if (pango_markup) {
-        pango_layout_set_markup(layout, text, text_len);
-    } else {
-        pango_layout_set_text(layout, text, text_len);
-    }
-
-    pango_cairo_update_layout(cr, layout);
-    pango_layout_get_pixel_size(layout, &width, NULL);
-
-    /* Free resources */
-    g_object_unref(layout);
-    cairo_destroy(cr);
-    cairo_surface_destroy(surface);
-
-    return width;
+    return get_layout(text, text_len, pango_markup, NULL)->pixel_width;
 }
 
 /*
@@ -236,8 +352,11 @@ i3Font load_font(const char *pattern, const bool fallback) {
     /* Get the font table, if possible */
     if (xcb_query_font_char_infos_length(font.specific.xcb.info) == 0) {
         font.specific.xcb.table = NULL;
+        /* The advances are filled lazily, see predict_text_width_xcb */
+        font.specific.xcb.advances = scalloc(256, sizeof(int16_t *));
     } else {
         font.specific.xcb.table = xcb_query_font_char_infos(font.specific.xcb.info);
+        font.specific.xcb.advances = NULL;
     }
 
     /* Calculate the font height */
@@ -276,9 +395,17 @@ void free_font(void) {
             /* Close the font and free the info */
             xcb_close_font(conn, savedFont->specific.xcb.id);
             free(savedFont->specific.xcb.info);
+            if (savedFont->specific.xcb.advances != NULL) {
+                for (int row = 0; row < 256; row++) {
+                    free(savedFont->specific.xcb.advances[row]);
+                }
+                free(savedFont->specific.xcb.advances);
+            }
             break;
         }
         case FONT_TYPE_PANGO:
+            /* The cached layouts refer to the font description */
+            clear_layout_cache();
             /* Free the font description */
             pango_font_description_free(savedFont->specific.pango_desc);
             break;
@@ -383,7 +510,67 @@ void draw_text(i3String *text, xcb_drawable_t drawable, xcb_gcontext_t gc,
     }
 }
 
-static int xcb_query_text_width(const xcb_char2b_t *text, size_t text_len) {
+/*
+ * Returns the metrics of the given glyph from the font table, or NULL if the
+ * font does not define it.
+ *
+ */
+static xcb_charinfo_t *table_lookup(int row, int col) {
+    xcb_query_font_reply_t *font_info = savedFont->specific.xcb.info;
+    xcb_charinfo_t *font_table = savedFont->specific.xcb.table;
+
+    if (row < font_info->min_byte1 ||
+        row > font_info->max_byte1 ||
+        col < font_info->min_char_or_byte2 ||
+        col > font_info->max_char_or_byte2) {
+        return NULL;
+    }
+
+    /* Don't you ask me, how this one works… (Merovius) */
+    xcb_charinfo_t *info = &font_table[((row - font_info->min_byte1) *
+                                        (font_info->max_char_or_byte2 - font_info->min_char_or_byte2 + 1)) +
+                                       (col - font_info->min_char_or_byte2)];
+
+    if (info->character_width != 0 ||
+        (info->right_side_bearing |
+         info->left_side_bearing |
+         info->ascent |
+         info->descent) != 0) {
+        return info;
+    }
+    return NULL;
+}
+
+/*
+ * Fills the advances of the 256 glyphs starting with the given first byte, for
+ * fonts without a font table. Glyphs are queried from the server all at once,
+ * so that this costs a single round trip per row and font.
+ *
+ */
+static int16_t *fill_advances_row(int row) {
+    xcb_query_font_reply_t *font_info = savedFont->specific.xcb.info;
+    int16_t *advances = smalloc(256 * sizeof(int16_t));
+
+    /* Without a font table, all glyphs usually have the same metrics. Glyphs
+     * outside of the font are drawn as the default character, if that one is
+     * inside. */
+    if (font_info->min_bounds.character_width == font_info->max_bounds.character_width) {
+        const int default_row = font_info->default_char >> 8;
+        const int default_col = font_info->default_char & 0xFF;
+        const bool default_inside = (default_row >= font_info->min_byte1 &&
+                                     default_row <= font_info->max_byte1 &&
+                                     default_col >= font_info->min_char_or_byte2 &&
+                                     default_col <= font_info->max_char_or_byte2);
+        for (int col = 0; col < 256; col++) {
+            const bool inside = (row >= font_info->min_byte1 &&
+                                 row <= font_info->max_byte1 &&
+                                 col >= font_info->min_char_or_byte2 &&
+                                 col <= font_info->max_char_or_byte2);
+            advances[col] = (inside || default_inside ? font_info->max_bounds.character_width : 0);
+        }
+        return advances;
+    }
+
     /* Make the user know we’re using the slow path, but only once. */
     static bool first_invocation = true;
     if (first_invocation) {
@@ -391,24 +578,27 @@ static int xcb_query_text_width(const xcb_char2b_t *text, size_t text_len) {
         first_invocation = false;
     }
 
-    /* Query the text width */
-    xcb_generic_error_t *error;
-    xcb_query_text_extents_cookie_t cookie = xcb_query_text_extents(conn,
-                                                                    savedFont->specific.xcb.id, text_len, (xcb_char2b_t *)text);
-    xcb_query_text_extents_reply_t *reply = xcb_query_text_extents_reply(conn,
-                                                                         cookie, &error);
-    if (reply == NULL) {
-        /* We return a safe estimate because a rendering error is better than
-         * a crash. Plus, the user will see the error in their log. */
-        fprintf(stderr, "Could not get text extents (X error code %d)\n",
-                error->error_code);
-        free(error);
-        return savedFont->specific.xcb.info->max_bounds.character_width * text_len;
+    xcb_query_text_extents_cookie_t cookies[256];
+    for (int col = 0; col < 256; col++) {
+        xcb_char2b_t glyph = {.byte1 = row, .byte2 = col};
+        cookies[col] = xcb_query_text_extents(conn, savedFont->specific.xcb.id, 1, &glyph);
     }
-
-    int width = reply->overall_width;
-    free(reply);
-    return width;
+    for (int col = 0; col < 256; col++) {
+        xcb_generic_error_t *error;
+        xcb_query_text_extents_reply_t *reply = xcb_query_text_extents_reply(conn, cookies[col], &error);
+        if (reply == NULL) {
+            /* We use a safe estimate because a rendering error is better than
+             * a crash. Plus, the user will see the error in their log. */
+            fprintf(stderr, "Could not get text extents (X error code %d)\n",
+                    error->error_code);
+            free(error);
+            advances[col] = font_info->max_bounds.character_width;
+            continue;
+        }
+        advances[col] = reply->overall_width;
+        free(reply);
+    }
+    return advances;
 }
 
 static int predict_text_width_xcb(const xcb_char2b_t *input, size_t text_len) {
@@ -416,41 +606,28 @@ static int predict_text_width_xcb(const xcb_char2b_t *input, size_t text_len) {
         return 0;
     }
 
-    int width;
+    int width = 0;
     if (savedFont->specific.xcb.table == NULL) {
-        /* If we don't have a font table, fall back to querying the server */
-        width = xcb_query_text_width(input, text_len);
+        /* Without a font table, the advances are cached per first byte. */
+        int16_t **advances = savedFont->specific.xcb.advances;
+        for (size_t i = 0; i < text_len; i++) {
+            const int row = input[i].byte1;
+            if (advances[row] == NULL) {
+                advances[row] = fill_advances_row(row);
+            }
+            width += advances[row][input[i].byte2];
+        }
     } else {
-        /* Save some pointers for convenience */
-        xcb_query_font_reply_t *font_info = savedFont->specific.xcb.info;
-        xcb_charinfo_t *font_table = savedFont->specific.xcb.table;
+        /* The server draws the default character for glyphs which the font
+         * does not define. */
+        const uint16_t default_char = savedFont->specific.xcb.info->default_char;
+        xcb_charinfo_t *default_info = table_lookup(default_char >> 8, default_char & 0xFF);
+        const int default_width = (default_info != NULL ? default_info->character_width : 0);
 
         /* Calculate the width using the font table */
-        width = 0;
         for (size_t i = 0; i < text_len; i++) {
-            xcb_charinfo_t *info;
-            int row = input[i].byte1;
-            int col = input[i].byte2;
-
-            if (row < font_info->min_byte1 ||
-                row > font_info->max_byte1 ||
-                col < font_info->min_char_or_byte2 ||
-                col > font_info->max_char_or_byte2) {
-                continue;
-            }
-
-            /* Don't you ask me, how this one works… (Merovius) */
-            info = &font_table[((row - font_info->min_byte1) *
-                                (font_info->max_char_or_byte2 - font_info->min_char_or_byte2 + 1)) +
-                               (col - font_info->min_char_or_byte2)];
-
-            if (info->character_width != 0 ||
-                (info->right_side_bearing |
-                 info->left_side_bearing |
-                 info->ascent |
-                 info->descent) != 0) {
-                width += info->character_width;
-            }
+            xcb_charinfo_t *info = table_lookup(input[i].byte1, input[i].byte2);
+            width += (info != NULL ? info->character_width : default_width);
         }
     }
 
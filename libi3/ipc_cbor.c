@@ -0,0 +1,755 @@
+/*
+ * vim:ts=4:sw=4:expandtab
+ *
+ * i3 - an improved tiling window manager
+ * © 2009 Michael Stapelberg and contributors (see also: LICENSE)
+ *
+ * ipc_cbor.c: The generator for IPC messages, which writes either JSON or
+ *             the CBOR encoding (see I3_IPC_MESSAGE_FLAG_CBOR in ipc2.h), and
+ *             the CBOR decoder. Maps and arrays are encoded with indefinite
+ *             length and the whole message is a stringref namespace (tags 256
+ *             and 25), so that repeated keys and values are only sent once.
+ *
+ */
+#include "libi3.h"
+
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* CBOR major types */
+#define CBOR_UINT 0
+#define CBOR_NEGINT 1
+#define CBOR_BYTES 2
+#define CBOR_TEXT 3
+#define CBOR_ARRAY 4
+#define CBOR_MAP 5
+#define CBOR_TAG 6
+#define CBOR_SIMPLE 7
+
+/* Additional information of the initial byte */
+#define CBOR_INDEFINITE 31
+#define CBOR_FALSE 20
+#define CBOR_TRUE 21
+#define CBOR_NULL 22
+#define CBOR_UNDEFINED 23
+#define CBOR_HALF 25
+#define CBOR_FLOAT 26
+#define CBOR_DOUBLE 27
+#define CBOR_BREAK 0xff
+
+#define CBOR_TAG_STRINGREF 25
+#define CBOR_TAG_STRINGREF_NAMESPACE 256
+
+/* Maximum nesting depth accepted by the decoder. */
+#define CBOR_MAX_DEPTH 512
+
+/*
+ * Returns the minimum length of a string to be added to a stringref namespace
+ * which already contains the given number of strings: only strings which are
+ * longer than a reference to them are added.
+ *
+ */
+static size_t stringref_min_length(size_t num_strings) {
+    if (num_strings < 24) {
+        return 3;
+    } else if (num_strings < 256) {
+        return 4;
+    } else if (num_strings < 65536) {
+        return 5;
+    } else if (num_strings < 4294967296ULL) {
+        return 7;
+    }
+    return 11;
+}
+
+/*******************************************************************************
+ * Encoder
+ ******************************************************************************/
+
+struct encoded_string {
+    /* Position of the string in the output buffer */
+    size_t offset;
+    size_t length;
+    uint32_t hash;
+};
+
+struct cbor_encoder {
+    uint8_t *buf;
+    size_t len;
+    size_t size;
+
+    /* The strings of the stringref namespace, in order of their index. */
+    struct encoded_string *strings;
+    size_t num_strings;
+
+    /* Hash table of the strings (index + 1, or 0 for an empty bucket). The
+     * number of buckets is a power of two. */
+    uint32_t *buckets;
+    size_t num_buckets;
+};
+
+static uint32_t hash_string(const unsigned char *str, size_t length) {
+    /* FNV-1a */
+    uint32_t hash = 2166136261U;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= str[i];
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+static void cbor_put_bytes(struct cbor_encoder *enc, const void *bytes, size_t length) {
+    if (enc->len + length > enc->size) {
+        while (enc->len + length > enc->size) {
+            enc->size *= 2;
+        }
+        enc->buf = srealloc(enc->buf, enc->size);
+    }
+    memcpy(enc->buf + enc->len, bytes, length);
+    enc->len += length;
+}
+
+static void cbor_put_byte(struct cbor_encoder *enc, uint8_t byte) {
+    cbor_put_bytes(enc, &byte, 1);
+}
+
+/*
+ * Writes the initial byte of a data item with the given major type, followed
+ * by the argument (the value, length or count) in the shortest form.
+ *
+ */
+static void cbor_put_head(struct cbor_encoder *enc, uint8_t major, uint64_t value) {
+    uint8_t head[9];
+    size_t length;
+    if (value < 24) {
+        head[0] = (major << 5) | value;
+        length = 1;
+    } else if (value <= UINT8_MAX) {
+        head[0] = (major << 5) | 24;
+        length = 2;
+    } else if (value <= UINT16_MAX) {
+        head[0] = (major << 5) | 25;
+        length = 3;
+    } else if (value <= UINT32_MAX) {
+        head[0] = (major << 5) | 26;
+        length = 5;
+    } else {
+        head[0] = (major << 5) | 27;
+        length = 9;
+    }
+    for (size_t i = length - 1; i > 0; i--) {
+        head[i] = value & 0xff;
+        value >>= 8;
+    }
+    cbor_put_bytes(enc, head, length);
+}
+
+static void cbor_rehash(struct cbor_encoder *enc) {
+    enc->num_buckets = (enc->num_buckets == 0 ? 64 : enc->num_buckets * 2);
+    free(enc->buckets);
+    enc->buckets = scalloc(enc->num_buckets, sizeof(uint32_t));
+
+    const size_t mask = enc->num_buckets - 1;
+    for (size_t i = 0; i < enc->num_strings; i++) {
+        size_t bucket = enc->strings[i].hash & mask;
+        while (enc->buckets[bucket] != 0) {
+            bucket = (bucket + 1) & mask;
+        }
+        enc->buckets[bucket] = i + 1;
+    }
+}
+
+/*
+ * Writes a text string, or a reference to it if it is already part of the
+ * stringref namespace.
+ *
+ */
+static void cbor_put_string(struct cbor_encoder *enc, const unsigned char *str, size_t length) {
+    /* Shorter strings are never part of the namespace. */
+    if (length < stringref_min_length(0)) {
+        cbor_put_head(enc, CBOR_TEXT, length);
+        cbor_put_bytes(enc, str, length);
+        return;
+    }
+
+    const uint32_t hash = hash_string(str, length);
+    const size_t mask = enc->num_buckets - 1;
+    size_t bucket = hash & mask;
+    while (enc->num_buckets > 0 && enc->buckets[bucket] != 0) {
+        const struct encoded_string *known = &(enc->strings[enc->buckets[bucket] - 1]);
+        if (known->hash == hash && known->length == length &&
+            memcmp(enc->buf + known->offset, str, length) == 0) {
+            cbor_put_head(enc, CBOR_TAG, CBOR_TAG_STRINGREF);
+            cbor_put_head(enc, CBOR_UINT, enc->buckets[bucket] - 1);
+            return;
+        }
+        bucket = (bucket + 1) & mask;
+    }
+
+    cbor_put_head(enc, CBOR_TEXT, length);
+    const size_t offset = enc->len;
+    cbor_put_bytes(enc, str, length);
+
+    /* The decoder adds every string which is long enough, so the encoder has
+     * to do the same to agree on the indices. */
+    if (length < stringref_min_length(enc->num_strings)) {
+        return;
+    }
+    enc->strings = srealloc(enc->strings, (enc->num_strings + 1) * sizeof(struct encoded_string));
+    enc->strings[enc->num_strings++] = (struct encoded_string){
+        .offset = offset,
+        .length = length,
+        .hash = hash};
+    if (enc->num_strings * 2 > enc->num_buckets) {
+        cbor_rehash(enc);
+    } else {
+        enc->buckets[bucket] = enc->num_strings;
+    }
+}
+
+/*
+ * Starts a new message: empties the buffer and the stringref namespace and
+ * writes the namespace tag which encloses the whole message.
+ *
+ */
+static void cbor_reset(struct cbor_encoder *enc) {
+    enc->len = 0;
+    enc->num_strings = 0;
+    if (enc->num_buckets > 0) {
+        memset(enc->buckets, 0, enc->num_buckets * sizeof(uint32_t));
+    }
+    cbor_put_head(enc, CBOR_TAG, CBOR_TAG_STRINGREF_NAMESPACE);
+}
+
+/*******************************************************************************
+ * Generator
+ ******************************************************************************/
+
+struct ipc_gen_ops {
+    yajl_gen_status (*null)(ipc_gen *gen);
+    yajl_gen_status (*boolean)(ipc_gen *gen, int val);
+    yajl_gen_status (*integer)(ipc_gen *gen, long long val);
+    yajl_gen_status (*dbl)(ipc_gen *gen, double val);
+    yajl_gen_status (*string)(ipc_gen *gen, const unsigned char *val, size_t len);
+    yajl_gen_status (*map_open)(ipc_gen *gen);
+    yajl_gen_status (*map_close)(ipc_gen *gen);
+    yajl_gen_status (*array_open)(ipc_gen *gen);
+    yajl_gen_status (*array_close)(ipc_gen *gen);
+    yajl_gen_status (*get_buf)(ipc_gen *gen, const unsigned char **buf, size_t *len);
+    void (*clear)(ipc_gen *gen);
+};
+
+struct ipc_gen {
+    const struct ipc_gen_ops *ops;
+    /* Only the member of the encoding in use is initialized. */
+    yajl_gen json;
+    struct cbor_encoder cbor;
+};
+
+static yajl_gen_status json_null(ipc_gen *gen) {
+    return yajl_gen_null(gen->json);
+}
+
+static yajl_gen_status json_bool(ipc_gen *gen, int val) {
+    return yajl_gen_bool(gen->json, val);
+}
+
+static yajl_gen_status json_integer(ipc_gen *gen, long long val) {
+    return yajl_gen_integer(gen->json, val);
+}
+
+static yajl_gen_status json_double(ipc_gen *gen, double val) {
+    return yajl_gen_double(gen->json, val);
+}
+
+static yajl_gen_status json_string(ipc_gen *gen, const unsigned char *val, size_t len) {
+    return yajl_gen_string(gen->json, val, len);
+}
+
+static yajl_gen_status json_map_open(ipc_gen *gen) {
+    return yajl_gen_map_open(gen->json);
+}
+
+static yajl_gen_status json_map_close(ipc_gen *gen) {
+    return yajl_gen_map_close(gen->json);
+}
+
+static yajl_gen_status json_array_open(ipc_gen *gen) {
+    return yajl_gen_array_open(gen->json);
+}
+
+static yajl_gen_status json_array_close(ipc_gen *gen) {
+    return yajl_gen_array_close(gen->json);
+}
+
+static yajl_gen_status json_get_buf(ipc_gen *gen, const unsigned char **buf, size_t *len) {
+    return yajl_gen_get_buf(gen->json, buf, len);
+}
+
+static void json_clear(ipc_gen *gen) {
+    yajl_gen_clear(gen->json);
+}
+
+static const struct ipc_gen_ops json_ops = {
+    .null = json_null,
+    .boolean = json_bool,
+    .integer = json_integer,
+    .dbl = json_double,
+    .string = json_string,
+    .map_open = json_map_open,
+    .map_close = json_map_close,
+    .array_open = json_array_open,
+    .array_close = json_array_close,
+    .get_buf = json_get_buf,
+    .clear = json_clear,
+};
+
+static yajl_gen_status cbor_null(ipc_gen *gen) {
+    cbor_put_byte(&(gen->cbor), (CBOR_SIMPLE << 5) | CBOR_NULL);
+    return yajl_gen_status_ok;
+}
+
+static yajl_gen_status cbor_bool(ipc_gen *gen, int val) {
+    cbor_put_byte(&(gen->cbor), (CBOR_SIMPLE << 5) | (val ? CBOR_TRUE : CBOR_FALSE));
+    return yajl_gen_status_ok;
+}
+
+static yajl_gen_status cbor_integer(ipc_gen *gen, long long val) {
+    if (val >= 0) {
+        cbor_put_head(&(gen->cbor), CBOR_UINT, (uint64_t)val);
+    } else {
+        cbor_put_head(&(gen->cbor), CBOR_NEGINT, (uint64_t)(-(val + 1)));
+    }
+    return yajl_gen_status_ok;
+}
+
+static yajl_gen_status cbor_double(ipc_gen *gen, double val) {
+    uint64_t bits;
+    memcpy(&bits, &val, sizeof(bits));
+    uint8_t bytes[9];
+    bytes[0] = (CBOR_SIMPLE << 5) | CBOR_DOUBLE;
+    for (int i = 8; i > 0; i--) {
+        bytes[i] = bits & 0xff;
+        bits >>= 8;
+    }
+    cbor_put_bytes(&(gen->cbor), bytes, sizeof(bytes));
+    return yajl_gen_status_ok;
+}
+
+static yajl_gen_status cbor_string(ipc_gen *gen, const unsigned char *val, size_t len) {
+    cbor_put_string(&(gen->cbor), val, len);
+    return yajl_gen_status_ok;
+}
+
+static yajl_gen_status cbor_map_open(ipc_gen *gen) {
+    cbor_put_byte(&(gen->cbor), (CBOR_MAP << 5) | CBOR_INDEFINITE);
+    return yajl_gen_status_ok;
+}
+
+static yajl_gen_status cbor_array_open(ipc_gen *gen) {
+    cbor_put_byte(&(gen->cbor), (CBOR_ARRAY << 5) | CBOR_INDEFINITE);
+    return yajl_gen_status_ok;
+}
+
+static yajl_gen_status cbor_close(ipc_gen *gen) {
+    cbor_put_byte(&(gen->cbor), CBOR_BREAK);
+    return yajl_gen_status_ok;
+}
+
+static yajl_gen_status cbor_get_buf(ipc_gen *gen, const unsigned char **buf, size_t *len) {
+    *buf = gen->cbor.buf;
+    *len = gen->cbor.len;
+    return yajl_gen_status_ok;
+}
+
+static void cbor_clear(ipc_gen *gen) {
+    cbor_reset(&(gen->cbor));
+}
+
+static const struct ipc_gen_ops cbor_ops = {
+    .null = cbor_null,
+    .boolean = cbor_bool,
+    .integer = cbor_integer,
+    .dbl = cbor_double,
+    .string = cbor_string,
+    .map_open = cbor_map_open,
+    .map_close = cbor_close,
+    .array_open = cbor_array_open,
+    .array_close = cbor_close,
+    .get_buf = cbor_get_buf,
+    .clear = cbor_clear,
+};
+
+/*
+ * Allocates a generator for IPC messages, which writes the JSON encoding or,
+ * if cbor is true, the CBOR encoding (see I3_IPC_MESSAGE_FLAG_CBOR). Use it
+ * through the y() and ystr() macros of yajl_utils.h, just like a yajl_gen.
+ *
+ */
+ipc_gen *ipc_gen_alloc(bool cbor) {
+    ipc_gen *gen = scalloc(1, sizeof(ipc_gen));
+    if (cbor) {
+        gen->ops = &cbor_ops;
+        gen->cbor.size = 1024;
+        gen->cbor.buf = smalloc(gen->cbor.size);
+        cbor_reset(&(gen->cbor));
+    } else {
+        gen->ops = &json_ops;
+        gen->json = yajl_gen_alloc(NULL);
+    }
+    return gen;
+}
+
+/*
+ * Frees the generator and its buffer.
+ *
+ */
+void ipc_gen_free(ipc_gen *gen) {
+    if (gen == NULL) {
+        return;
+    }
+    if (gen->ops == &cbor_ops) {
+        free(gen->cbor.buf);
+        free(gen->cbor.strings);
+        free(gen->cbor.buckets);
+    } else {
+        yajl_gen_free(gen->json);
+    }
+    free(gen);
+}
+
+/*
+ * Returns true if the generator writes the CBOR encoding.
+ *
+ */
+bool ipc_gen_is_cbor(ipc_gen *gen) {
+    return gen->ops == &cbor_ops;
+}
+
+/*
+ * Returns the message generated so far. The buffer belongs to the generator
+ * and is valid until the next call of any other ipc_gen function.
+ *
+ */
+yajl_gen_status ipc_gen_get_buf(ipc_gen *gen, const unsigned char **buf, size_t *len) {
+    return gen->ops->get_buf(gen, buf, len);
+}
+
+/*
+ * Discards the message generated so far, so that the generator can be used
+ * for the next one.
+ *
+ */
+void ipc_gen_clear(ipc_gen *gen) {
+    gen->ops->clear(gen);
+}
+
+yajl_gen_status ipc_gen_null(ipc_gen *gen) {
+    return gen->ops->null(gen);
+}
+
+yajl_gen_status ipc_gen_bool(ipc_gen *gen, int val) {
+    return gen->ops->boolean(gen, val);
+}
+
+yajl_gen_status ipc_gen_integer(ipc_gen *gen, long long val) {
+    return gen->ops->integer(gen, val);
+}
+
+yajl_gen_status ipc_gen_double(ipc_gen *gen, double val) {
+    return gen->ops->dbl(gen, val);
+}
+
+yajl_gen_status ipc_gen_string(ipc_gen *gen, const unsigned char *val, size_t len) {
+    return gen->ops->string(gen, val, len);
+}
+
+yajl_gen_status ipc_gen_map_open(ipc_gen *gen) {
+    return gen->ops->map_open(gen);
+}
+
+yajl_gen_status ipc_gen_map_close(ipc_gen *gen) {
+    return gen->ops->map_close(gen);
+}
+
+yajl_gen_status ipc_gen_array_open(ipc_gen *gen) {
+    return gen->ops->array_open(gen);
+}
+
+yajl_gen_status ipc_gen_array_close(ipc_gen *gen) {
+    return gen->ops->array_close(gen);
+}
+
+/*******************************************************************************
+ * Decoder
+ ******************************************************************************/
+
+struct decoded_string {
+    const unsigned char *str;
+    size_t length;
+};
+
+struct cbor_namespace {
+    struct decoded_string *strings;
+    size_t num_strings;
+};
+
+struct cbor_decoder {
+    const uint8_t *data;
+    size_t length;
+    size_t pos;
+
+    const yajl_callbacks *callbacks;
+    void *ctx;
+};
+
+/* Calls the given callback (if set) and stops decoding if it returns 0. */
+#define CALLBACK(name, ...)                                     \
+    do {                                                        \
+        if (dec->callbacks->name != NULL &&                     \
+            !dec->callbacks->name(dec->ctx, ##__VA_ARGS__)) {   \
+            return false;                                       \
+        }                                                       \
+    } while (0)
+
+/*
+ * Reads the initial byte and argument of the next data item. For indefinite
+ * lengths, value is not set.
+ *
+ */
+static bool cbor_read_head(struct cbor_decoder *dec, uint8_t *major, uint8_t *info, uint64_t *value) {
+    if (dec->pos >= dec->length) {
+        return false;
+    }
+    const uint8_t initial = dec->data[dec->pos++];
+    *major = initial >> 5;
+    *info = initial & 0x1f;
+
+    size_t length;
+    if (*info < 24) {
+        *value = *info;
+        return true;
+    } else if (*info == CBOR_INDEFINITE) {
+        return true;
+    } else if (*info > 27) {
+        return false;
+    }
+
+    length = 1 << (*info - 24);
+    if (dec->length - dec->pos < length) {
+        return false;
+    }
+    *value = 0;
+    for (size_t i = 0; i < length; i++) {
+        *value = (*value << 8) | dec->data[dec->pos++];
+    }
+    return true;
+}
+
+static bool cbor_emit_integer(struct cbor_decoder *dec, long long value) {
+    /* Like yajl, prefer the yajl_number callback if it is set. */
+    if (dec->callbacks->yajl_number != NULL) {
+        char number[32];
+        const int length = snprintf(number, sizeof(number), "%lld", value);
+        CALLBACK(yajl_number, number, length);
+    } else {
+        CALLBACK(yajl_integer, value);
+    }
+    return true;
+}
+
+static bool cbor_emit_double(struct cbor_decoder *dec, double value) {
+    if (dec->callbacks->yajl_number != NULL) {
+        char number[32];
+        const int length = snprintf(number, sizeof(number), "%.17g", value);
+        CALLBACK(yajl_number, number, length);
+    } else {
+        CALLBACK(yajl_double, value);
+    }
+    return true;
+}
+
+static bool cbor_emit_string(struct cbor_decoder *dec, const unsigned char *str, size_t length, bool is_key) {
+    if (is_key) {
+        CALLBACK(yajl_map_key, str, length);
+    } else {
+        CALLBACK(yajl_string, str, length);
+    }
+    return true;
+}
+
+static double cbor_half_to_double(uint16_t half) {
+    const int exponent = (half >> 10) & 0x1f;
+    const int mantissa = half & 0x3ff;
+    double value;
+    if (exponent == 0) {
+        value = ldexp(mantissa, -24);
+    } else if (exponent != 31) {
+        value = ldexp(mantissa + 1024, exponent - 25);
+    } else {
+        value = (mantissa == 0 ? INFINITY : NAN);
+    }
+    return (half & 0x8000 ? -value : value);
+}
+
+static bool cbor_decode_item(struct cbor_decoder *dec, struct cbor_namespace *ns, int depth, bool is_key);
+
+/*
+ * Decodes the elements of an array or the entries of a map, count being the
+ * number of elements or entries (ignored for indefinite lengths).
+ *
+ */
+static bool cbor_decode_container(struct cbor_decoder *dec, struct cbor_namespace *ns, int depth, bool map, bool indefinite, uint64_t count) {
+    for (uint64_t i = 0; indefinite || i < count; i++) {
+        if (indefinite) {
+            if (dec->pos >= dec->length) {
+                return false;
+            }
+            if (dec->data[dec->pos] == CBOR_BREAK) {
+                dec->pos++;
+                break;
+            }
+        }
+        if (map && !cbor_decode_item(dec, ns, depth + 1, true)) {
+            return false;
+        }
+        if (!cbor_decode_item(dec, ns, depth + 1, false)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool cbor_decode_item(struct cbor_decoder *dec, struct cbor_namespace *ns, int depth, bool is_key) {
+    if (depth > CBOR_MAX_DEPTH) {
+        return false;
+    }
+
+    uint8_t major, info;
+    uint64_t value = 0;
+    if (!cbor_read_head(dec, &major, &info, &value)) {
+        return false;
+    }
+    if (info == CBOR_INDEFINITE && major != CBOR_ARRAY && major != CBOR_MAP) {
+        /* Indefinite-length strings are never sent by i3. */
+        return false;
+    }
+    if (is_key && major != CBOR_TEXT && major != CBOR_BYTES && major != CBOR_TAG) {
+        return false;
+    }
+
+    switch (major) {
+        case CBOR_UINT:
+            if (value > LLONG_MAX) {
+                return cbor_emit_double(dec, (double)value);
+            }
+            return cbor_emit_integer(dec, (long long)value);
+        case CBOR_NEGINT:
+            if (value > LLONG_MAX) {
+                return cbor_emit_double(dec, -1.0 - (double)value);
+            }
+            return cbor_emit_integer(dec, -1 - (long long)value);
+        case CBOR_BYTES:
+        case CBOR_TEXT: {
+            if (dec->length - dec->pos < value) {
+                return false;
+            }
+            const unsigned char *str = dec->data + dec->pos;
+            dec->pos += value;
+            if (ns != NULL && value >= stringref_min_length(ns->num_strings)) {
+                ns->strings = srealloc(ns->strings, (ns->num_strings + 1) * sizeof(struct decoded_string));
+                ns->strings[ns->num_strings++] = (struct decoded_string){
+                    .str = str,
+                    .length = value};
+            }
+            return cbor_emit_string(dec, str, value, is_key);
+        }
+        case CBOR_ARRAY:
+            CALLBACK(yajl_start_array);
+            if (!cbor_decode_container(dec, ns, depth, false, info == CBOR_INDEFINITE, value)) {
+                return false;
+            }
+            CALLBACK(yajl_end_array);
+            return true;
+        case CBOR_MAP:
+            CALLBACK(yajl_start_map);
+            if (!cbor_decode_container(dec, ns, depth, true, info == CBOR_INDEFINITE, value)) {
+                return false;
+            }
+            CALLBACK(yajl_end_map);
+            return true;
+        case CBOR_TAG:
+            if (value == CBOR_TAG_STRINGREF) {
+                uint8_t index_major, index_info;
+                uint64_t index = 0;
+                if (ns == NULL ||
+                    !cbor_read_head(dec, &index_major, &index_info, &index) ||
+                    index_major != CBOR_UINT || index_info == CBOR_INDEFINITE ||
+                    index >= ns->num_strings) {
+                    return false;
+                }
+                return cbor_emit_string(dec, ns->strings[index].str, ns->strings[index].length, is_key);
+            }
+            if (value == CBOR_TAG_STRINGREF_NAMESPACE) {
+                struct cbor_namespace inner = {0};
+                const bool result = cbor_decode_item(dec, &inner, depth + 1, is_key);
+                free(inner.strings);
+                return result;
+            }
+            /* Other tags carry no meaning for JSON, only decode their item. */
+            return cbor_decode_item(dec, ns, depth + 1, is_key);
+        case CBOR_SIMPLE:
+            if (is_key) {
+                return false;
+            }
+            switch (info) {
+                case CBOR_FALSE:
+                case CBOR_TRUE:
+                    CALLBACK(yajl_boolean, info == CBOR_TRUE);
+                    return true;
+                case CBOR_NULL:
+                case CBOR_UNDEFINED:
+                    CALLBACK(yajl_null);
+                    return true;
+                case CBOR_HALF:
+                    return cbor_emit_double(dec, cbor_half_to_double(value));
+                case CBOR_FLOAT: {
+                    const uint32_t bits = value;
+                    float f;
+                    memcpy(&f, &bits, sizeof(f));
+                    return cbor_emit_double(dec, f);
+                }
+                case CBOR_DOUBLE: {
+                    double d;
+                    memcpy(&d, &value, sizeof(d));
+                    return cbor_emit_double(dec, d);
+                }
+                default:
+                    return false;
+            }
+    }
+    return false;
+}
+
+/*
+ * Parses a CBOR-encoded IPC message (see I3_IPC_MESSAGE_FLAG_CBOR) and calls
+ * the given yajl callbacks for its contents, just like yajl_parse() would for
+ * the JSON encoding. This allows clients to use the same callbacks for both
+ * encodings.
+ *
+ * Returns false if the message is malformed or a callback returned 0.
+ *
+ */
+bool ipc_cbor_parse(const uint8_t *cbor, size_t cbor_length, const yajl_callbacks *callbacks, void *ctx) {
+    struct cbor_decoder dec = {
+        .data = cbor,
+        .length = cbor_length,
+        .pos = 0,
+        .callbacks = callbacks,
+        .ctx = ctx};
+    return cbor_decode_item(&dec, NULL, 0, false) && dec.pos == dec.length;
+}
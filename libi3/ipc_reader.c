@@ -0,0 +1,162 @@
+/*
+ * vim:ts=4:sw=4:expandtab
+ *
+ * i3 - an improved tiling window manager
+ * © 2009 Michael Stapelberg and contributors (see also: LICENSE)
+ *
+ */
+#include "libi3.h"
+
+#include <errno.h>
+#include "ipc2.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+
+struct ipc_reader_t {
+    int fd;
+
+    uint8_t *buffer;
+    size_t size;
+    /* Number of bytes in the buffer and offset of the first one which was not
+     * returned by ipc_reader_next() yet. */
+    size_t length;
+    size_t offset;
+};
+
+/* Initial size of the buffer, the buffer grows for larger messages. */
+#define IPC_READER_BUFFER_SIZE 65536
+
+/*
+ * Creates a buffered reader for the IPC messages arriving on the given socket.
+ *
+ */
+ipc_reader_t *ipc_reader_new(int sockfd) {
+    ipc_reader_t *reader = scalloc(1, sizeof(ipc_reader_t));
+    reader->fd = sockfd;
+    reader->size = IPC_READER_BUFFER_SIZE;
+    reader->buffer = smalloc(reader->size);
+    return reader;
+}
+
+/*
+ * Frees the reader (but does not close its socket).
+ *
+ */
+void ipc_reader_free(ipc_reader_t *reader) {
+    if (reader == NULL) {
+        return;
+    }
+    free(reader->buffer);
+    free(reader);
+}
+
+/*
+ * Returns the number of bytes needed for the first message in the buffer to
+ * be complete, 0 if the message is complete.
+ *
+ */
+static size_t ipc_reader_missing(ipc_reader_t *reader) {
+    const size_t available = reader->length - reader->offset;
+    if (available < sizeof(i3_ipc_header_t)) {
+        return sizeof(i3_ipc_header_t) - available;
+    }
+    uint32_t size;
+    memcpy(&size, reader->buffer + reader->offset + offsetof(i3_ipc_header_t, size), sizeof(uint32_t));
+    if (available < sizeof(i3_ipc_header_t) + size) {
+        return sizeof(i3_ipc_header_t) + size - available;
+    }
+    return 0;
+}
+
+/*
+ * Reads everything which is available on the socket into the buffer, without
+ * blocking (the socket itself does not have to be non-blocking). Payloads
+ * previously returned by ipc_reader_next() are invalid afterwards.
+ *
+ * Returns -1 when read() fails, errno will remain.
+ * Returns -2 on EOF.
+ * Returns the number of bytes read otherwise (0 if nothing was available).
+ *
+ */
+ssize_t ipc_reader_fill(ipc_reader_t *reader) {
+    /* Drop the messages which were returned already. */
+    if (reader->offset > 0) {
+        memmove(reader->buffer, reader->buffer + reader->offset, reader->length - reader->offset);
+        reader->length -= reader->offset;
+        reader->offset = 0;
+    }
+
+    ssize_t total = 0;
+    while (true) {
+        /* Make room for at least the rest of the current message. */
+        const size_t missing = ipc_reader_missing(reader);
+        if (reader->length + missing > reader->size) {
+            while (reader->length + missing > reader->size) {
+                reader->size *= 2;
+            }
+            reader->buffer = srealloc(reader->buffer, reader->size);
+        } else if (reader->length == reader->size) {
+            reader->size *= 2;
+            reader->buffer = srealloc(reader->buffer, reader->size);
+        }
+
+        const ssize_t n = recv(reader->fd, reader->buffer + reader->length,
+                               reader->size - reader->length, MSG_DONTWAIT);
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return total;
+            }
+            return -1;
+        }
+        if (n == 0) {
+            return -2;
+        }
+        reader->length += n;
+        total += n;
+    }
+}
+
+/*
+ * Returns the next complete message from the buffer. The payload points into
+ * the buffer of the reader and is valid until the next call of
+ * ipc_reader_fill().
+ *
+ * Returns 1 if a message was returned.
+ * Returns 0 if there is no complete message, call ipc_reader_fill() when the
+ * socket is readable again.
+ * Returns -3 when the IPC protocol is violated (invalid magic). Additionally,
+ * the error will be printed to stderr.
+ *
+ */
+int ipc_reader_next(ipc_reader_t *reader, uint32_t *message_type,
+                    uint32_t *message_length, const uint8_t **payload) {
+    if (reader->length - reader->offset < sizeof(i3_ipc_header_t)) {
+        return 0;
+    }
+
+    const uint8_t *walk = reader->buffer + reader->offset;
+    if (memcmp(walk, I3_IPC_MAGIC, strlen(I3_IPC_MAGIC)) != 0) {
+        ELOG("IPC: invalid magic in header, got \"%.*s\", want \"%s\"\n",
+             (int)strlen(I3_IPC_MAGIC), walk, I3_IPC_MAGIC);
+        return -3;
+    }
+    if (ipc_reader_missing(reader) > 0) {
+        return 0;
+    }
+
+    i3_ipc_header_t header;
+    memcpy(&header, walk, sizeof(i3_ipc_header_t));
+    if (message_type != NULL) {
+        *message_type = header.type;
+    }
+    *message_length = header.size;
+    *payload = walk + sizeof(i3_ipc_header_t);
+    reader->offset += sizeof(i3_ipc_header_t) + header.size;
+    return 1;
+}
@@ -21,6 +21,7 @@ state INITIAL:
   'reload' -> call cmd_reload()
   'shmlog' -> SHMLOG
   'debuglog' -> DEBUGLOG
+  'trace' -> TRACE
   'border' -> BORDER
   'layout' -> LAYOUT
   'append_layout' -> APPEND_LAYOUT
@@ -104,6 +105,11 @@ state DEBUGLOG:
   argument = 'toggle', 'on', 'off'
     -> call cmd_debuglog($argument)
 
+# trace toggle|on|off
+state TRACE:
+  argument = 'toggle', 'on', 'off'
+    -> call cmd_trace($argument)
+
 # border normal|pixel [<n>]
 # border none|1pixel|toggle
 state BORDER:
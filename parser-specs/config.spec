@@ -56,6 +56,8 @@ state INITIAL:
   'ipc_kill_timeout'                       -> IPC_KILL_TIMEOUT
   'restart_state'                          -> RESTART_STATE
   'popup_during_fullscreen'                -> POPUP_DURING_FULLSCREEN
+  'property_coalesce_interval'             -> PROPERTY_COALESCE_INTERVAL
+  'render_batching'                        -> RENDER_BATCHING
   'tiling_drag'                            -> TILING_DRAG
   'gradients'                           -> GRADIENTS
   'dithering'                              -> DITHERING
@@ -381,6 +383,22 @@ state IPC_KILL_TIMEOUT:
   timeout = number
       -> call cfg_ipc_kill_timeout(&timeout)
 
+# property_coalesce_interval <duration> [ms]
+state PROPERTY_COALESCE_INTERVAL:
+  duration_ms = number
+      -> PROPERTY_COALESCE_INTERVAL_MS
+
+state PROPERTY_COALESCE_INTERVAL_MS:
+  'ms'
+      ->
+  end
+      -> call cfg_property_coalesce_interval(&duration_ms)
+
+# render_batching yes|no
+state RENDER_BATCHING:
+  value = word
+      -> call cfg_render_batching($value)
+
 # restart_state <path> (for testcases)
 state RESTART_STATE:
   path = string
@@ -608,8 +626,12 @@ state BAR:
   'binding_mode_indicator' -> BAR_BINDING_MODE_INDICATOR
   'workspace_buttons'      -> BAR_WORKSPACE_BUTTONS
   'workspace_min_width'    -> BAR_WORKSPACE_MIN_WIDTH
+  'status_redraw_interval' -> BAR_STATUS_REDRAW_INTERVAL
   'strip_workspace_numbers' -> BAR_STRIP_WORKSPACE_NUMBERS
   'strip_workspace_name' -> BAR_STRIP_WORKSPACE_NAME
+  'gradients'              -> BAR_GRADIENTS
+  'dithering'              -> BAR_DITHERING
+  'dither_noise'           -> BAR_DITHER_NOISE
   'verbose'                -> BAR_VERBOSE
   'height'                 -> BAR_HEIGHT
   'padding'                -> BAR_PADDING
@@ -728,6 +750,17 @@ state BAR_WORKSPACE_MIN_WIDTH_PX:
   end
       -> call cfg_bar_workspace_min_width(&width); BAR
 
+# status_redraw_interval <duration> [ms]
+state BAR_STATUS_REDRAW_INTERVAL:
+  duration_ms = number
+      -> BAR_STATUS_REDRAW_INTERVAL_MS
+
+state BAR_STATUS_REDRAW_INTERVAL_MS:
+  'ms'
+      ->
+  end
+      -> call cfg_bar_status_redraw_interval(&duration_ms); BAR
+
 state BAR_STRIP_WORKSPACE_NUMBERS:
   value = word
       -> call cfg_bar_strip_workspace_numbers($value); BAR
@@ -736,6 +769,18 @@ state BAR_STRIP_WORKSPACE_NAME:
   value = word
       -> call cfg_bar_strip_workspace_name($value); BAR
 
+state BAR_GRADIENTS:
+  value = word
+      -> call cfg_bar_gradients($value); BAR
+
+state BAR_DITHERING:
+  value = word
+      -> call cfg_bar_dithering($value); BAR
+
+state BAR_DITHER_NOISE:
+  noise = word
+      -> call cfg_bar_dither_noise($noise); BAR
+
 state BAR_VERBOSE:
   value = word
       -> call cfg_bar_verbose($value); BAR
@@ -788,7 +833,7 @@ state BAR_COLORS:
   end ->
   '#' -> BAR_COLORS_IGNORE_LINE
   'set' -> BAR_COLORS_IGNORE_LINE
-  colorclass = 'background', 'statusline', 'separator', 'focused_background', 'focused_statusline', 'focused_separator'
+  colorclass = 'background', 'statusline', 'separator', 'focused_background', 'focused_statusline', 'focused_separator', 'gradient_start', 'gradient_end', 'focused_gradient_start', 'focused_gradient_end'
       -> BAR_COLORS_SINGLE
   colorclass = 'focused_workspace', 'active_workspace', 'inactive_workspace', 'urgent_workspace', 'binding_mode'
       -> BAR_COLORS_BORDER
@@ -814,6 +859,12 @@ state BAR_COLORS_BACKGROUND:
 
 state BAR_COLORS_TEXT:
   end
-      -> call cfg_bar_color($colorclass, $border, $background, NULL); BAR_COLORS
+      -> call cfg_bar_color($colorclass, $border, $background, NULL, NULL); BAR_COLORS
   text = word
-      -> call cfg_bar_color($colorclass, $border, $background, $text); BAR_COLORS
+      -> BAR_COLORS_GRADIENT
+
+state BAR_COLORS_GRADIENT:
+  end
+      -> call cfg_bar_color($colorclass, $border, $background, $text, NULL); BAR_COLORS
+  gradient = word
+      -> call cfg_bar_color($colorclass, $border, $background, $text, $gradient); BAR_COLORS
@@ -662,12 +662,7 @@ void switch_mode(const char *new_mode) {
             }
         }
 
-        char *event_msg;
-        sasprintf(&event_msg, "{\"change\":\"%s\", \"pango_markup\":%s}",
-                  mode->name, (mode->pango_markup ? "true" : "false"));
-
-        ipc_send_event("mode", I3_IPC_EVENT_MODE, event_msg);
-        FREE(event_msg);
+        ipc_send_mode_event(mode);
 
         return;
     }
@@ -182,11 +182,14 @@ static void route_click(Con *con, xcb_button_press_event_t *event, const click_d
 
     /* if the user has bound an action to this click, it should override the
      * default behavior. */
+    const uint64_t start = trace_now();
     Binding *bind = get_binding_from_xcb_event((xcb_generic_event_t *)event);
     if (bind && ((dest == CLICK_DECORATION && !bind->exclude_titlebar) ||
                  (dest == CLICK_INSIDE && bind->whole_window) ||
                  (dest == CLICK_BORDER && bind->border))) {
+        const char *latency_class = latency_binding_class(bind);
         CommandResult *result = run_binding(bind, con);
+        latency_measure(latency_class, start);
 
         /* ASYNC_POINTER eats the event */
         xcb_allow_events(conn, XCB_ALLOW_ASYNC_POINTER, event->time);
@@ -388,10 +391,13 @@ void handle_button_press(xcb_button_press_event_t *event) {
          * if --whole-window was set as that's the equivalent for a normal
          * window. */
         if (event->event == root) {
+            const uint64_t start = trace_now();
             Binding *bind = get_binding_from_xcb_event((xcb_generic_event_t *)event);
             if (bind != NULL && bind->whole_window) {
+                const char *latency_class = latency_binding_class(bind);
                 CommandResult *result = run_binding(bind, NULL);
                 command_result_free(result);
+                latency_measure(latency_class, start);
             }
         }
 
@@ -15,8 +15,8 @@
 #include <unistd.h>
 
 // Macros to make the YAJL API a bit easier to use.
-#define y(x, ...) (cmd_output->json_gen != NULL ? yajl_gen_##x(cmd_output->json_gen, ##__VA_ARGS__) : 0)
-#define ystr(str) (cmd_output->json_gen != NULL ? yajl_gen_string(cmd_output->json_gen, (unsigned char *)str, strlen(str)) : 0)
+#define y(x, ...) (cmd_output->json_gen != NULL ? ipc_gen_##x(cmd_output->json_gen, ##__VA_ARGS__) : 0)
+#define ystr(str) (cmd_output->json_gen != NULL ? ipc_gen_string(cmd_output->json_gen, (unsigned char *)str, strlen(str)) : 0)
 #define ysuccess(success)                   \
     do {                                    \
         if (cmd_output->json_gen != NULL) { \
@@ -2404,6 +2404,19 @@ void cmd_debuglog(I3_CMD, const char *argument) {
     ysuccess(true);
 }
 
+/*
+ * Implementation of 'trace toggle|on|off'
+ *
+ */
+void cmd_trace(I3_CMD, const char *argument) {
+    if (!strcmp(argument, "toggle")) {
+        trace_set_enabled(!trace_enabled);
+    } else {
+        trace_set_enabled(!strcmp(argument, "on"));
+    }
+    ysuccess(true);
+}
+
 static int *gaps_inner(gaps_t *gaps) {
     return &(gaps->inner);
 }
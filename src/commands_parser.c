@@ -26,8 +26,8 @@
 #include "all.h"
 
 // Macros to make the YAJL API a bit easier to use.
-#define y(x, ...) (command_output.json_gen != NULL ? yajl_gen_##x(command_output.json_gen, ##__VA_ARGS__) : 0)
-#define ystr(str) (command_output.json_gen != NULL ? yajl_gen_string(command_output.json_gen, (unsigned char *)str, strlen(str)) : 0)
+#define y(x, ...) (command_output.json_gen != NULL ? ipc_gen_##x(command_output.json_gen, ##__VA_ARGS__) : 0)
+#define ystr(str) (command_output.json_gen != NULL ? ipc_gen_string(command_output.json_gen, (unsigned char *)str, strlen(str)) : 0)
 
 /*******************************************************************************
  * The data structures used for parsing. Essentially the current state and a
@@ -244,20 +244,23 @@ char *parse_string(const char **walk, bool as_word) {
 }
 
 /*
- * Parses and executes the given command. If a caller-allocated yajl_gen is
+ * Parses and executes the given command. If a caller-allocated ipc_gen is
  * passed, a json reply will be generated in the format specified by the ipc
  * protocol. Pass NULL if no json reply is required.
  *
  * Free the returned CommandResult with command_result_free().
  */
-CommandResult *parse_command(const char *input, yajl_gen gen, ipc_client *client) {
+CommandResult *parse_command(const char *input, ipc_gen *gen, ipc_client *client) {
+#ifndef TEST_PARSER
+    TRACE_SPAN(span, "command", input, -1);
+#endif
     DLOG("COMMAND: *%.4000s*\n", input);
     state = INITIAL;
     CommandResult *result = scalloc(1, sizeof(CommandResult));
 
     command_output.client = client;
 
-    /* A YAJL JSON generator used for formatting replies. */
+    /* A JSON generator used for formatting replies. */
     command_output.json_gen = gen;
 
     y(array_open);
@@ -295,6 +298,12 @@ CommandResult *parse_command(const char *input, yajl_gen gen, ipc_client *client
                     if (token->identifier != NULL) {
                         push_string(&stack, token->identifier, sstrdup(token->name + 1));
                     }
+                    /* Every literal of the initial state but the opening
+                     * bracket of criteria is a command name. */
+                    if (state == INITIAL && result->command_name == NULL &&
+                        strcmp(token->name, "'[") != 0) {
+                        result->command_name = token->name + 1;
+                    }
                     walk += strlen(token->name) - 1;
                     next_state(token);
                     token_handled = true;
@@ -499,12 +508,12 @@ int main(int argc, char *argv[]) {
         fprintf(stderr, "Syntax: %s <command>\n", argv[0]);
         return 1;
     }
-    yajl_gen gen = yajl_gen_alloc(NULL);
+    ipc_gen *gen = ipc_gen_alloc(false);
 
     CommandResult *result = parse_command(argv[1], gen, NULL);
 
     command_result_free(result);
 
-    yajl_gen_free(gen);
+    ipc_gen_free(gen);
 }
 #endif
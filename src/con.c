@@ -78,6 +78,7 @@ Con *con_new(Con *parent, i3Window *window) {
  *
  */
 void con_free(Con *con) {
+    tree_delta_con_freed(con);
     free(con->name);
     FREE(con->deco_render_params);
     TAILQ_REMOVE(&all_cons, con, all_cons);
@@ -2225,15 +2226,10 @@ static void con_on_remove_child(Con *con) {
     if (con->type == CT_WORKSPACE) {
         if (TAILQ_EMPTY(&(con->focus_head)) && !workspace_is_visible(con)) {
             LOG("Closing old workspace (%p / %s), it is empty\n", con, con->name);
-            yajl_gen gen = ipc_marshal_workspace_event("empty", con, NULL);
+            /* The event needs to be serialized before closing the workspace. */
+            ipc_prepared_event *event = ipc_prepare_workspace_event("empty", con, NULL);
             tree_close_internal(con, DONT_KILL_WINDOW, false);
-
-            const unsigned char *payload;
-            ylength length;
-            y(get_buf, &payload, &length);
-            ipc_send_event("workspace", I3_IPC_EVENT_WORKSPACE, (const char *)payload);
-
-            y(free);
+            ipc_send_prepared_event(event);
         }
         return;
     }
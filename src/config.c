@@ -131,6 +131,15 @@ static void free_configuration(void) {
         FREE(barconfig->colors.binding_mode_border);
         FREE(barconfig->colors.binding_mode_bg);
         FREE(barconfig->colors.binding_mode_text);
+        FREE(barconfig->colors.gradient_start);
+        FREE(barconfig->colors.gradient_end);
+        FREE(barconfig->colors.focused_gradient_start);
+        FREE(barconfig->colors.focused_gradient_end);
+        FREE(barconfig->colors.focused_workspace_gradient);
+        FREE(barconfig->colors.active_workspace_gradient);
+        FREE(barconfig->colors.inactive_workspace_gradient);
+        FREE(barconfig->colors.urgent_workspace_gradient);
+        FREE(barconfig->colors.binding_mode_gradient);
         TAILQ_REMOVE(&barconfigs, barconfig, configs);
         FREE(barconfig);
     }
@@ -735,6 +735,14 @@ CFGFUN(ipc_kill_timeout, const long timeout_ms) {
     ipc_set_kill_timeout(timeout_ms / 1000.0);
 }
 
+CFGFUN(property_coalesce_interval, const long duration_ms) {
+    config.property_coalesce_interval = duration_ms / 1000.0;
+}
+
+CFGFUN(render_batching, const char *value) {
+    config.render_batching = boolstr(value);
+}
+
 CFGFUN(tiling_drag, const char *value) {
     if (strcmp(value, "modifier") == 0) {
         config.tiling_drag = TILING_DRAG_MODIFIER;
@@ -887,21 +895,24 @@ CFGFUN(bar_i3bar_command, const char *i3bar_command) {
     current_bar->i3bar_command = sstrdup(i3bar_command);
 }
 
-CFGFUN(bar_color, const char *colorclass, const char *border, const char *background, const char *text) {
-#define APPLY_COLORS(classname)                                           \
-    do {                                                                  \
-        if (strcmp(colorclass, #classname) == 0) {                        \
-            if (text != NULL) {                                           \
-                /* New syntax: border, background, text */                \
-                current_bar->colors.classname##_border = sstrdup(border); \
-                current_bar->colors.classname##_bg = sstrdup(background); \
-                current_bar->colors.classname##_text = sstrdup(text);     \
-            } else {                                                      \
-                /* Old syntax: text, background */                        \
-                current_bar->colors.classname##_bg = sstrdup(background); \
-                current_bar->colors.classname##_text = sstrdup(border);   \
-            }                                                             \
-        }                                                                 \
+CFGFUN(bar_color, const char *colorclass, const char *border, const char *background, const char *text, const char *gradient) {
+#define APPLY_COLORS(classname)                                                   \
+    do {                                                                          \
+        if (strcmp(colorclass, #classname) == 0) {                                \
+            if (text != NULL) {                                                   \
+                /* New syntax: border, background, text [gradient] */             \
+                current_bar->colors.classname##_border = sstrdup(border);         \
+                current_bar->colors.classname##_bg = sstrdup(background);         \
+                current_bar->colors.classname##_text = sstrdup(text);             \
+                if (gradient != NULL) {                                           \
+                    current_bar->colors.classname##_gradient = sstrdup(gradient); \
+                }                                                                 \
+            } else {                                                              \
+                /* Old syntax: text, background */                                \
+                current_bar->colors.classname##_bg = sstrdup(background);         \
+                current_bar->colors.classname##_text = sstrdup(border);           \
+            }                                                                     \
+        }                                                                         \
     } while (0)
 
     APPLY_COLORS(focused_workspace);
@@ -939,6 +950,14 @@ CFGFUN(bar_color_single, const char *colorclass, const char *color) {
         current_bar->colors.focused_background = sstrdup(color);
     } else if (strcmp(colorclass, "focused_separator") == 0) {
         current_bar->colors.focused_separator = sstrdup(color);
+    } else if (strcmp(colorclass, "gradient_start") == 0) {
+        current_bar->colors.gradient_start = sstrdup(color);
+    } else if (strcmp(colorclass, "gradient_end") == 0) {
+        current_bar->colors.gradient_end = sstrdup(color);
+    } else if (strcmp(colorclass, "focused_gradient_start") == 0) {
+        current_bar->colors.focused_gradient_start = sstrdup(color);
+    } else if (strcmp(colorclass, "focused_gradient_end") == 0) {
+        current_bar->colors.focused_gradient_end = sstrdup(color);
     } else {
         current_bar->colors.focused_statusline = sstrdup(color);
     }
@@ -966,6 +985,22 @@ CFGFUN(bar_workspace_min_width, const long width) {
     current_bar->workspace_min_width = width;
 }
 
+CFGFUN(bar_status_redraw_interval, const long duration_ms) {
+    current_bar->status_redraw_interval = duration_ms;
+}
+
+CFGFUN(bar_gradients, const char *value) {
+    current_bar->gradients = boolstr(value);
+}
+
+CFGFUN(bar_dithering, const char *value) {
+    current_bar->dithering = boolstr(value);
+}
+
+CFGFUN(bar_dither_noise, const char *noise) {
+    current_bar->dither_noise = atof(noise);
+}
+
 CFGFUN(bar_strip_workspace_numbers, const char *value) {
     current_bar->strip_workspace_numbers = boolstr(value);
 }
@@ -980,6 +1015,7 @@ CFGFUN(bar_start) {
     TAILQ_INIT(&(current_bar->tray_outputs));
     current_bar->tray_padding = 2;
     current_bar->modifier = XCB_KEY_BUT_MASK_MOD_4;
+    current_bar->dither_noise = 0.5;
 }
 
 CFGFUN(bar_finish) {
@@ -18,6 +18,51 @@ xcb_window_t ewmh_window;
         TAILQ_FOREACH (ws, &(output_get_content(output)->nodes_head), nodes) \
             if (!con_is_internal(ws))
 
+/* Properties which were changed since the last ewmh_flush_properties(). */
+typedef enum {
+    EWMH_DIRTY_DESKTOPS = (1 << 0),
+    EWMH_DIRTY_WM_DESKTOP = (1 << 1),
+    EWMH_DIRTY_CLIENT_LIST = (1 << 2),
+    EWMH_DIRTY_CLIENT_LIST_STACKING = (1 << 3),
+} ewmh_dirty_t;
+
+static int dirty = 0;
+
+/* A window list property (_NET_CLIENT_LIST, _NET_CLIENT_LIST_STACKING): the
+ * value to be sent with the next flush and the value which was last sent. */
+struct window_list_property {
+    xcb_window_t *pending;
+    int num_pending;
+
+    xcb_window_t *sent;
+    int num_sent;
+    bool ever_sent;
+};
+
+static struct window_list_property client_list;
+static struct window_list_property client_list_stacking;
+
+/*
+ * Sends the given property to the root window unless the last value sent for
+ * it is the same. last/last_len hold the last value and are updated.
+ *
+ */
+static void change_root_property_if_changed(xcb_atom_t property, xcb_atom_t type, uint8_t format,
+                                            const void *data, uint32_t data_len,
+                                            void **last, uint32_t *last_len) {
+    const size_t size = data_len * (format / 8);
+    if (*last != NULL && *last_len == data_len && memcmp(*last, data, size) == 0) {
+        return;
+    }
+
+    xcb_change_property(conn, XCB_PROP_MODE_REPLACE, root, property, type, format, data_len, data);
+
+    FREE(*last);
+    *last = smalloc(size > 0 ? size : 1);
+    memcpy(*last, data, size);
+    *last_len = data_len;
+}
+
 /*
  * Updates _NET_CURRENT_DESKTOP with the current desktop number.
  *
@@ -27,6 +72,13 @@ xcb_window_t ewmh_window;
  */
 void ewmh_update_current_desktop(void) {
     static uint32_t old_idx = NET_WM_DESKTOP_NONE;
+
+    /* The index might refer to a desktop which was not announced yet, so
+     * update it together with the other desktop properties. */
+    if (dirty & EWMH_DIRTY_DESKTOPS) {
+        return;
+    }
+
     const uint32_t idx = ewmh_get_workspace_index(focused);
 
     if (idx == old_idx || idx == NET_WM_DESKTOP_NONE) {
@@ -64,6 +116,8 @@ static void ewmh_update_number_of_desktops(void) {
  * list of NULL-terminated strings in UTF-8 encoding"
  */
 static void ewmh_update_desktop_names(void) {
+    static void *last_names = NULL;
+    static uint32_t last_length = 0;
     Con *output, *ws;
     int msg_length = 0;
 
@@ -82,8 +136,8 @@ static void ewmh_update_desktop_names(void) {
         }
     }
 
-    xcb_change_property(conn, XCB_PROP_MODE_REPLACE, root,
-                        A__NET_DESKTOP_NAMES, A_UTF8_STRING, 8, msg_length, desktop_names);
+    change_root_property_if_changed(A__NET_DESKTOP_NAMES, A_UTF8_STRING, 8,
+                                    desktop_names, msg_length, &last_names, &last_length);
 }
 
 /*
@@ -91,6 +145,8 @@ static void ewmh_update_desktop_names(void) {
  * define the top left corner of each desktop's viewport.
  */
 static void ewmh_update_desktop_viewport(void) {
+    static void *last_viewports = NULL;
+    static uint32_t last_length = 0;
     Con *output, *ws;
     int num_desktops = 0;
     /* count number of desktops */
@@ -107,20 +163,19 @@ static void ewmh_update_desktop_viewport(void) {
         viewports[current_position++] = output->rect.y;
     }
 
-    xcb_change_property(conn, XCB_PROP_MODE_REPLACE, root,
-                        A__NET_DESKTOP_VIEWPORT, XCB_ATOM_CARDINAL, 32, current_position, &viewports);
+    change_root_property_if_changed(A__NET_DESKTOP_VIEWPORT, XCB_ATOM_CARDINAL, 32,
+                                    viewports, current_position, &last_viewports, &last_length);
 }
 
 /*
  * Updates all the EWMH desktop properties.
  *
+ * The properties are only marked as changed here and sent by the next
+ * ewmh_flush_properties().
+ *
  */
 void ewmh_update_desktop_properties(void) {
-    ewmh_update_number_of_desktops();
-    ewmh_update_desktop_viewport();
-    ewmh_update_current_desktop();
-    ewmh_update_desktop_names();
-    ewmh_update_wm_desktop();
+    dirty |= EWMH_DIRTY_DESKTOPS | EWMH_DIRTY_WM_DESKTOP;
 }
 
 static void ewmh_update_wm_desktop_recursively(Con *con, const uint32_t desktop) {
@@ -182,8 +237,15 @@ static void ewmh_update_wm_desktop_recursively(Con *con, const uint32_t desktop)
  * Updates _NET_WM_DESKTOP for all windows.
  * A request will only be made if the cached value differs from the calculated value.
  *
+ * The update happens with the next ewmh_flush_properties(), so that the tree
+ * is walked at most once per event loop iteration.
+ *
  */
 void ewmh_update_wm_desktop(void) {
+    dirty |= EWMH_DIRTY_WM_DESKTOP;
+}
+
+static void ewmh_flush_wm_desktop(void) {
     uint32_t desktop = 0;
 
     Con *output;
@@ -242,36 +304,101 @@ void ewmh_update_workarea(void) {
     xcb_delete_property(conn, root, A__NET_WORKAREA);
 }
 
-/*
- * Updates the _NET_CLIENT_LIST hint.
- *
- */
-void ewmh_update_client_list(xcb_window_t *list, int num_windows) {
+static void window_list_set(struct window_list_property *prop, xcb_window_t *list, int num_windows) {
+    if (num_windows != prop->num_pending) {
+        prop->pending = srealloc(prop->pending, sizeof(xcb_window_t) * num_windows);
+        prop->num_pending = num_windows;
+    }
+    if (num_windows > 0) {
+        memcpy(prop->pending, list, sizeof(xcb_window_t) * num_windows);
+    }
+}
+
+static void window_list_flush(struct window_list_property *prop, xcb_atom_t atom) {
+    if (prop->ever_sent &&
+        prop->num_pending == prop->num_sent &&
+        (prop->num_sent == 0 || memcmp(prop->pending, prop->sent, sizeof(xcb_window_t) * prop->num_sent) == 0)) {
+        return;
+    }
+
     xcb_change_property(
         conn,
         XCB_PROP_MODE_REPLACE,
         root,
-        A__NET_CLIENT_LIST,
+        atom,
         XCB_ATOM_WINDOW,
         32,
-        num_windows,
-        list);
+        prop->num_pending,
+        prop->pending);
+
+    if (prop->num_sent != prop->num_pending) {
+        prop->sent = srealloc(prop->sent, sizeof(xcb_window_t) * prop->num_pending);
+        prop->num_sent = prop->num_pending;
+    }
+    if (prop->num_sent > 0) {
+        memcpy(prop->sent, prop->pending, sizeof(xcb_window_t) * prop->num_sent);
+    }
+    prop->ever_sent = true;
+}
+
+/*
+ * Updates the _NET_CLIENT_LIST hint.
+ *
+ * The list is copied and sent by the next ewmh_flush_properties(), unless it
+ * is equal to the last list sent.
+ *
+ */
+void ewmh_update_client_list(xcb_window_t *list, int num_windows) {
+    window_list_set(&client_list, list, num_windows);
+    dirty |= EWMH_DIRTY_CLIENT_LIST;
 }
 
 /*
  * Updates the _NET_CLIENT_LIST_STACKING hint.
  *
+ * The list is copied and sent by the next ewmh_flush_properties(), unless it
+ * is equal to the last list sent.
+ *
  */
 void ewmh_update_client_list_stacking(xcb_window_t *stack, int num_windows) {
-    xcb_change_property(
-        conn,
-        XCB_PROP_MODE_REPLACE,
-        root,
-        A__NET_CLIENT_LIST_STACKING,
-        XCB_ATOM_WINDOW,
-        32,
-        num_windows,
-        stack);
+    window_list_set(&client_list_stacking, stack, num_windows);
+    dirty |= EWMH_DIRTY_CLIENT_LIST_STACKING;
+}
+
+/*
+ * Sends all EWMH properties which were changed since the last call. Each
+ * property is sent at most once and only if its value differs from the last
+ * value sent. Called at the end of x_push_changes() and of every event loop
+ * iteration.
+ *
+ */
+void ewmh_flush_properties(void) {
+    if (dirty == 0) {
+        return;
+    }
+
+    /* Reset first: the functions below might mark properties again. */
+    const int flush = dirty;
+    dirty = 0;
+
+    if (flush & EWMH_DIRTY_DESKTOPS) {
+        ewmh_update_number_of_desktops();
+        ewmh_update_desktop_viewport();
+        ewmh_update_current_desktop();
+        ewmh_update_desktop_names();
+    }
+
+    if (flush & EWMH_DIRTY_WM_DESKTOP) {
+        ewmh_flush_wm_desktop();
+    }
+
+    if (flush & EWMH_DIRTY_CLIENT_LIST_STACKING) {
+        window_list_flush(&client_list_stacking, A__NET_CLIENT_LIST_STACKING);
+    }
+
+    if (flush & EWMH_DIRTY_CLIENT_LIST) {
+        window_list_flush(&client_list, A__NET_CLIENT_LIST);
+    }
 }
 
 /*
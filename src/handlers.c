@@ -473,7 +473,7 @@ static void handle_screen_change(xcb_generic_event_t *e) {
 
     scratchpad_fix_resolution();
 
-    ipc_send_event("output", I3_IPC_EVENT_OUTPUT, "{\"change\":\"unspecified\"}");
+    ipc_send_output_event();
 }
 
 /*
@@ -815,6 +815,10 @@ static void handle_client_message(xcb_client_message_event_t *event) {
     } else if (event->type == A_I3_SYNC) {
         xcb_window_t window = event->data.data32[0];
         uint32_t rnd = event->data.data32[1];
+        /* Clients expect all their previous requests to be handled when
+         * receiving the sync reply. */
+        handle_coalesced_property_changes(true);
+        tree_render_flush();
         sync_respond(window, rnd);
     } else if (event->type == A__NET_REQUEST_FRAME_EXTENTS) {
         /*
@@ -1196,7 +1200,7 @@ static void handle_configure_notify(xcb_configure_notify_event_t *event) {
     }
     randr_query_outputs();
 
-    ipc_send_event("output", I3_IPC_EVENT_OUTPUT, "{\"change\":\"unspecified\"}");
+    ipc_send_output_event();
 }
 
 /*
@@ -1339,23 +1343,27 @@ struct property_handler_t {
     xcb_atom_t atom;
     uint32_t long_len;
     cb_property_handler_t cb;
+    /* Whether notifies for this property are coalesced, see
+     * handle_coalesced_property_changes(). Only the final value matters for
+     * these properties, so intermediate values can safely be skipped. */
+    bool coalesce;
 };
 
 static struct property_handler_t property_handlers[] = {
-    {0, 128, handle_windowname_change},
-    {0, UINT_MAX, handle_hints},
-    {0, 128, handle_windowname_change_legacy},
-    {0, UINT_MAX, handle_normal_hints},
-    {0, UINT_MAX, handle_clientleader_change},
-    {0, UINT_MAX, handle_transient_for},
-    {0, 128, handle_windowrole_change},
-    {0, 128, handle_class_change},
-    {0, UINT_MAX, handle_strut_partial_change},
-    {0, UINT_MAX, handle_window_type},
-    {0, UINT_MAX, handle_i3_floating},
-    {0, 128, handle_machine_change},
-    {0, 5 * sizeof(uint64_t), handle_motif_hints_change},
-    {0, UINT_MAX, handle_windowicon_change}};
+    {0, 128, handle_windowname_change, true},
+    {0, UINT_MAX, handle_hints, false},
+    {0, 128, handle_windowname_change_legacy, true},
+    {0, UINT_MAX, handle_normal_hints, false},
+    {0, UINT_MAX, handle_clientleader_change, false},
+    {0, UINT_MAX, handle_transient_for, false},
+    {0, 128, handle_windowrole_change, false},
+    {0, 128, handle_class_change, false},
+    {0, UINT_MAX, handle_strut_partial_change, false},
+    {0, UINT_MAX, handle_window_type, false},
+    {0, UINT_MAX, handle_i3_floating, false},
+    {0, 128, handle_machine_change, false},
+    {0, 5 * sizeof(uint64_t), handle_motif_hints_change, false},
+    {0, UINT_MAX, handle_windowicon_change, true}};
 #define NUM_HANDLERS (sizeof(property_handlers) / sizeof(struct property_handler_t))
 
 /*
@@ -1382,26 +1390,17 @@ void property_handlers_init(void) {
     property_handlers[13].atom = A__NET_WM_ICON;
 }
 
-static void property_notify(uint8_t state, xcb_window_t window, xcb_atom_t atom) {
-    struct property_handler_t *handler = NULL;
+/*
+ * Fetches the current value of the given property and passes it to the
+ * handler. The window is looked up again, so this is safe to call for windows
+ * which have been unmanaged in the meantime.
+ *
+ */
+static void property_dispatch(struct property_handler_t *handler, uint8_t state, xcb_window_t window, xcb_atom_t atom) {
     xcb_get_property_reply_t *propr = NULL;
     xcb_generic_error_t *err = NULL;
     Con *con;
 
-    for (size_t c = 0; c < NUM_HANDLERS; c++) {
-        if (property_handlers[c].atom != atom) {
-            continue;
-        }
-
-        handler = &property_handlers[c];
-        break;
-    }
-
-    if (handler == NULL) {
-        /* DLOG("Unhandled property notify for atom %d (0x%08x)\n", atom, atom); */
-        return;
-    }
-
     if ((con = con_by_window_id(window)) == NULL || con->window == NULL) {
         DLOG("Received property for atom %d for unknown client\n", atom);
         return;
@@ -1423,6 +1422,119 @@ static void property_notify(uint8_t state, xcb_window_t window, xcb_atom_t atom)
     }
 }
 
+/* Property notifies for handlers with coalesce set are queued here (at most
+ * one entry per window and atom) instead of being handled right away. */
+typedef struct pending_property {
+    struct property_handler_t *handler;
+    xcb_window_t window;
+    xcb_atom_t atom;
+    uint8_t state;
+
+    TAILQ_ENTRY(pending_property) pending;
+} pending_property;
+
+static TAILQ_HEAD(pending_properties_head, pending_property) pending_properties =
+    TAILQ_HEAD_INITIALIZER(pending_properties);
+
+static struct ev_timer *coalesce_timer = NULL;
+
+static void coalesce_timer_cb(EV_P_ ev_timer *w, int revents) {
+    handle_coalesced_property_changes(true);
+}
+
+static void queue_property_change(struct property_handler_t *handler, uint8_t state, xcb_window_t window, xcb_atom_t atom) {
+    pending_property *current;
+    TAILQ_FOREACH (current, &pending_properties, pending) {
+        if (current->window == window && current->atom == atom) {
+            /* Only the latest state matters, the value is fetched once the
+             * change is handled. */
+            current->state = state;
+            return;
+        }
+    }
+
+    current = scalloc(1, sizeof(pending_property));
+    current->handler = handler;
+    current->window = window;
+    current->atom = atom;
+    current->state = state;
+    TAILQ_INSERT_TAIL(&pending_properties, current, pending);
+
+    if (config.property_coalesce_interval <= 0) {
+        /* Handled at the end of this event loop iteration. */
+        return;
+    }
+
+    if (coalesce_timer == NULL) {
+        coalesce_timer = scalloc(1, sizeof(struct ev_timer));
+        ev_timer_init(coalesce_timer, coalesce_timer_cb, config.property_coalesce_interval, 0.);
+    }
+    if (!ev_is_active(coalesce_timer)) {
+        ev_timer_set(coalesce_timer, config.property_coalesce_interval, 0.);
+        ev_timer_start(main_loop, coalesce_timer);
+    }
+}
+
+/*
+ * Handles the property changes which were queued because their handler
+ * coalesces notifies. Every window and property is handled once, using the
+ * value the property has now.
+ *
+ * Unless force is true, nothing happens while a coalescing interval is
+ * configured (the timer will call this function when the interval is over).
+ *
+ * Returns true if any change was handled, in which case the caller should
+ * check for new X11 events again.
+ *
+ */
+bool handle_coalesced_property_changes(bool force) {
+    if (TAILQ_EMPTY(&pending_properties)) {
+        return false;
+    }
+
+    if (!force && coalesce_timer != NULL && ev_is_active(coalesce_timer)) {
+        return false;
+    }
+
+    if (coalesce_timer != NULL) {
+        ev_timer_stop(main_loop, coalesce_timer);
+    }
+
+    while (!TAILQ_EMPTY(&pending_properties)) {
+        pending_property *current = TAILQ_FIRST(&pending_properties);
+        TAILQ_REMOVE(&pending_properties, current, pending);
+        property_dispatch(current->handler, current->state, current->window, current->atom);
+        free(current);
+    }
+
+    return true;
+}
+
+static void property_notify(uint8_t state, xcb_window_t window, xcb_atom_t atom) {
+    struct property_handler_t *handler = NULL;
+
+    for (size_t c = 0; c < NUM_HANDLERS; c++) {
+        if (property_handlers[c].atom != atom) {
+            continue;
+        }
+
+        handler = &property_handlers[c];
+        break;
+    }
+
+    if (handler == NULL) {
+        /* DLOG("Unhandled property notify for atom %d (0x%08x)\n", atom, atom); */
+        return;
+    }
+
+    if (handler->coalesce) {
+        queue_property_change(handler, state, window, atom);
+        return;
+    }
+
+    property_dispatch(handler, state, window, atom);
+}
+
 /*
  * Takes an xcb_generic_event_t and calls the appropriate handler, based on the
  * event type.
@@ -17,6 +17,7 @@
 #include <locale.h>
 #include <stdint.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/un.h>
 #include <unistd.h>
 
@@ -27,6 +28,34 @@ char *current_socketpath = NULL;
 
 TAILQ_HEAD(ipc_client_head, ipc_client) all_clients = TAILQ_HEAD_INITIALIZER(all_clients);
 
+/* The clients subscribed to each event type, so that sending an event only
+ * needs to look at its subscribers. */
+static struct ipc_client_head subscribers[IPC_EVENT_COUNT] = {
+    TAILQ_HEAD_INITIALIZER(subscribers[0]),
+    TAILQ_HEAD_INITIALIZER(subscribers[1]),
+    TAILQ_HEAD_INITIALIZER(subscribers[2]),
+    TAILQ_HEAD_INITIALIZER(subscribers[3]),
+    TAILQ_HEAD_INITIALIZER(subscribers[4]),
+    TAILQ_HEAD_INITIALIZER(subscribers[5]),
+    TAILQ_HEAD_INITIALIZER(subscribers[6]),
+    TAILQ_HEAD_INITIALIZER(subscribers[7]),
+    TAILQ_HEAD_INITIALIZER(subscribers[8]),
+};
+
+/* The names of the event types as used in SUBSCRIBE messages, indexed by
+ * event type. */
+static const char *event_names[IPC_EVENT_COUNT] = {
+    "workspace",
+    "output",
+    "mode",
+    "window",
+    "barconfig_update",
+    "binding",
+    "shutdown",
+    "tick",
+    "tree_delta",
+};
+
 static void ipc_client_timeout(EV_P_ ev_timer *w, int revents);
 static void ipc_socket_writeable_cb(EV_P_ struct ev_io *w, int revents);
 
@@ -36,23 +65,151 @@ void ipc_set_kill_timeout(ev_tstamp new) {
     kill_timeout = new;
 }
 
+/* Maximum number of chunks passed to a single writev() call. */
+#define IPC_MAX_IOV 64
+
+/*
+ * Allocates a chunk containing the header and payload of the given message,
+ * with a reference held by the caller.
+ *
+ */
+static ipc_chunk *ipc_chunk_new(size_t size, const uint32_t message_type, const uint8_t *payload) {
+    const i3_ipc_header_t header = {
+        .magic = {'i', '3', '-', 'i', 'p', 'c'},
+        .size = size,
+        .type = message_type};
+    const size_t header_size = sizeof(i3_ipc_header_t);
+
+    ipc_chunk *chunk = smalloc(sizeof(ipc_chunk) + header_size + size);
+    chunk->refcount = 1;
+    chunk->size = header_size + size;
+    memcpy(chunk->data, ((void *)&header), header_size);
+    memcpy(chunk->data + header_size, payload, size);
+    return chunk;
+}
+
 /*
- * Try to write the contents of the pending buffer to the client's subscription
+ * Allocates a chunk containing the message generated by gen, with a reference
+ * held by the caller. I3_IPC_MESSAGE_FLAG_CBOR is added to the message type
+ * if gen generated the CBOR encoding.
+ *
+ */
+static ipc_chunk *ipc_chunk_new_generated(const uint32_t message_type, ipc_gen *gen) {
+    const unsigned char *payload;
+    ylength length;
+    y(get_buf, &payload, &length);
+
+    const uint32_t type = (ipc_gen_is_cbor(gen) ? (message_type | I3_IPC_MESSAGE_FLAG_CBOR) : message_type);
+    return ipc_chunk_new(length, type, payload);
+}
+
+/*
+ * Allocates a chunk containing the event written by marshal in the given
+ * encoding, with a reference held by the caller.
+ *
+ */
+static ipc_chunk *ipc_chunk_new_event(const uint32_t message_type, ipc_event_marshaller marshal, void *data, bool cbor) {
+    setlocale(LC_NUMERIC, "C");
+    ipc_gen *gen = ipc_gen_alloc(cbor);
+    marshal(gen, data);
+    setlocale(LC_NUMERIC, "");
+
+    ipc_chunk *chunk = ipc_chunk_new_generated(message_type, gen);
+    y(free);
+    return chunk;
+}
+
+static void ipc_chunk_unref(ipc_chunk *chunk) {
+    if (--chunk->refcount == 0) {
+        free(chunk);
+    }
+}
+
+/*
+ * Removes the first chunk from the client's output queue.
+ *
+ */
+static void ipc_dequeue_chunk(ipc_client *client) {
+    ipc_queued_chunk *queued = TAILQ_FIRST(&(client->output_queue));
+    TAILQ_REMOVE(&(client->output_queue), queued, chunks);
+    ipc_chunk_unref(queued->chunk);
+    free(queued);
+}
+
+/*
+ * Writes as much of the client's output queue as possible without blocking,
+ * using one writev() call for up to IPC_MAX_IOV chunks. Completely written
+ * chunks are removed from the queue. Returns the number of bytes written or
+ * -1 on error.
+ *
+ */
+static ssize_t ipc_write_queue(ipc_client *client) {
+    size_t written = 0;
+
+    while (!TAILQ_EMPTY(&(client->output_queue))) {
+        struct iovec iov[IPC_MAX_IOV];
+        int iovcnt = 0;
+        size_t count = 0;
+
+        ipc_queued_chunk *queued;
+        TAILQ_FOREACH (queued, &(client->output_queue), chunks) {
+            if (iovcnt == IPC_MAX_IOV) {
+                break;
+            }
+            iov[iovcnt].iov_base = queued->chunk->data + queued->offset;
+            iov[iovcnt].iov_len = queued->chunk->size - queued->offset;
+            count += iov[iovcnt].iov_len;
+            iovcnt++;
+        }
+
+        const ssize_t n = writev(client->fd, iov, iovcnt);
+        if (n == -1) {
+            if (errno == EAGAIN) {
+                break;
+            } else if (errno == EINTR) {
+                continue;
+            } else {
+                return -1;
+            }
+        }
+        written += (size_t)n;
+
+        size_t remaining = (size_t)n;
+        while (remaining > 0) {
+            queued = TAILQ_FIRST(&(client->output_queue));
+            const size_t left = queued->chunk->size - queued->offset;
+            if (remaining < left) {
+                queued->offset += remaining;
+                break;
+            }
+            remaining -= left;
+            ipc_dequeue_chunk(client);
+        }
+
+        if ((size_t)n < count) {
+            /* Short write, the socket is full. */
+            break;
+        }
+    }
+
+    return written;
+}
+
+/*
+ * Try to write the contents of the output queue to the client's subscription
  * socket. Will set, reset or clear the timeout and io write callbacks depending
  * on the result of the write operation.
  *
  */
 static void ipc_push_pending(ipc_client *client) {
-    const ssize_t result = writeall_nonblock(client->fd, client->buffer, client->buffer_size);
+    const ssize_t result = ipc_write_queue(client);
     if (result < 0) {
         return;
     }
 
-    if ((size_t)result == client->buffer_size) {
+    if (TAILQ_EMPTY(&(client->output_queue))) {
         /* Everything was written successfully: clear the timer and stop the io
          * callback. */
-        FREE(client->buffer);
-        client->buffer_size = 0;
         if (client->timeout) {
             ev_timer_stop(main_loop, client->timeout);
             FREE(client->timeout);
@@ -79,39 +236,163 @@ static void ipc_push_pending(ipc_client *client) {
         ev_timer_set(client->timeout, kill_timeout, 0.0);
         ev_timer_start(main_loop, client->timeout);
     }
-    if (result == 0) {
-        return;
-    }
+}
 
-    /* Shift the buffer to the left and reduce the allocated space. */
-    client->buffer_size -= (size_t)result;
-    memmove(client->buffer, client->buffer + result, client->buffer_size);
-    client->buffer = srealloc(client->buffer, client->buffer_size);
+/*
+ * Appends the given chunk to the client's output queue, taking a reference.
+ * Also, sends it if the client's queue was empty.
+ *
+ */
+static void ipc_queue_chunk(ipc_client *client, ipc_chunk *chunk) {
+    const bool push_now = TAILQ_EMPTY(&(client->output_queue));
+
+    ipc_queued_chunk *queued = smalloc(sizeof(ipc_queued_chunk));
+    queued->chunk = chunk;
+    queued->offset = 0;
+    chunk->refcount++;
+    TAILQ_INSERT_TAIL(&(client->output_queue), queued, chunks);
+
+    if (push_now) {
+        ipc_push_pending(client);
+    }
 }
 
 /*
  * Given a message and a message type, create the corresponding header, merge it
- * with the message and append it to the given client's output buffer. Also,
- * send the message if the client's buffer was empty.
+ * with the message and append it to the given client's output queue. Also,
+ * send the message if the client's queue was empty.
  *
  */
 static void ipc_send_client_message(ipc_client *client, size_t size, const uint32_t message_type, const uint8_t *payload) {
-    const i3_ipc_header_t header = {
-        .magic = {'i', '3', '-', 'i', 'p', 'c'},
-        .size = size,
-        .type = message_type};
-    const size_t header_size = sizeof(i3_ipc_header_t);
-    const size_t message_size = header_size + size;
+    ipc_chunk *chunk = ipc_chunk_new(size, message_type, payload);
+    ipc_queue_chunk(client, chunk);
+    ipc_chunk_unref(chunk);
+}
 
-    const bool push_now = (client->buffer_size == 0);
-    client->buffer = srealloc(client->buffer, client->buffer_size + message_size);
-    memcpy(client->buffer + client->buffer_size, ((void *)&header), header_size);
-    memcpy(client->buffer + client->buffer_size + header_size, payload, size);
-    client->buffer_size += message_size;
+/*
+ * Allocates the generator for the reply to a request of the given type, which
+ * writes the CBOR encoding if the client set I3_IPC_MESSAGE_FLAG_CBOR in the
+ * request.
+ *
+ */
+static ipc_gen *ipc_reply_gen_alloc(const uint32_t request_type) {
+    return ipc_gen_alloc((request_type & I3_IPC_MESSAGE_FLAG_CBOR) != 0);
+}
 
-    if (push_now) {
-        ipc_push_pending(client);
+/*
+ * Sends the message generated by gen (see ipc_reply_gen_alloc()) as a reply
+ * of the given type.
+ *
+ */
+static void ipc_send_client_reply(ipc_client *client, const uint32_t reply_type, ipc_gen *gen) {
+    ipc_chunk *chunk = ipc_chunk_new_generated(reply_type, gen);
+    ipc_queue_chunk(client, chunk);
+    ipc_chunk_unref(chunk);
+}
+
+static void free_event_filter(ipc_event_filter *filter) {
+    for (int i = 0; i < filter->num_changes; i++) {
+        free(filter->changes[i]);
+    }
+    free(filter->changes);
+    if (filter->match != NULL) {
+        match_free(filter->match);
+        free(filter->match);
+    }
+    free(filter);
+}
+
+static void free_event_filters(ipc_client *client, int event) {
+    while (!TAILQ_EMPTY(&(client->filters[event]))) {
+        ipc_event_filter *filter = TAILQ_FIRST(&(client->filters[event]));
+        TAILQ_REMOVE(&(client->filters[event]), filter, filters);
+        free_event_filter(filter);
+    }
+}
+
+/*
+ * Returns whether the container matches the given criteria. Like for command
+ * criteria, containers without a window only match by con_id or con_mark.
+ *
+ */
+static bool con_matches_criteria(Match *match, Con *con) {
+    bool accept_match = false;
+
+    if (match->con_id != NULL) {
+        if (match->con_id != con) {
+            return false;
+        }
+        accept_match = true;
+    }
+
+    if (match->mark != NULL && !TAILQ_EMPTY(&(con->marks_head))) {
+        bool matched_by_mark = false;
+        mark_t *mark;
+        TAILQ_FOREACH (mark, &(con->marks_head), marks) {
+            if (regex_matches(match->mark, mark->name)) {
+                matched_by_mark = true;
+                break;
+            }
+        }
+        if (!matched_by_mark) {
+            return false;
+        }
+        accept_match = true;
+    }
+
+    if (con->window != NULL) {
+        if (!match_matches_window(match, con->window)) {
+            return false;
+        }
+        accept_match = true;
+    }
+
+    return accept_match;
+}
+
+/*
+ * Returns whether the given event matches the filter. Conditions which cannot
+ * be checked for this event (no change or no container given) match.
+ *
+ */
+static bool event_filter_matches(ipc_event_filter *filter, const char *change, Con *con) {
+    if (filter->num_changes > 0 && change != NULL) {
+        bool found = false;
+        for (int i = 0; i < filter->num_changes; i++) {
+            if (strcmp(filter->changes[i], change) == 0) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+    }
+
+    if (filter->match != NULL && con != NULL && !con_matches_criteria(filter->match, con)) {
+        return false;
     }
+
+    return true;
+}
+
+/*
+ * Returns whether the client wants to receive the given event, i.e. whether
+ * it subscribed to it without filters or one of its filters matches.
+ *
+ */
+static bool client_wants_event(ipc_client *client, uint32_t type, const char *change, Con *con) {
+    if (!(client->filtered_events & (1 << type))) {
+        return true;
+    }
+
+    ipc_event_filter *filter;
+    TAILQ_FOREACH (filter, &(client->filters[type]), filters) {
+        if (event_filter_matches(filter, change, con)) {
+            return true;
+        }
+    }
+    return false;
 }
 
 static void free_ipc_client(ipc_client *client, int exempt_fd) {
@@ -129,57 +410,187 @@ static void free_ipc_client(ipc_client *client, int exempt_fd) {
         FREE(client->timeout);
     }
 
-    free(client->buffer);
+    while (!TAILQ_EMPTY(&(client->output_queue))) {
+        ipc_dequeue_chunk(client);
+    }
 
-    for (int i = 0; i < client->num_events; i++) {
-        free(client->events[i]);
+    for (int i = 0; i < IPC_EVENT_COUNT; i++) {
+        if (client->events & (1 << i)) {
+            TAILQ_REMOVE(&subscribers[i], client, subscriptions[i]);
+        }
+        free_event_filters(client, i);
     }
-    free(client->events);
     TAILQ_REMOVE(&all_clients, client, clients);
     free(client);
 }
 
+/*
+ * Returns whether any IPC client is subscribed to the given kind of event with
+ * a filter (if any) which matches the given change. Criteria on containers are
+ * not checked. Sending events does not need this, as ipc_send_filtered_event()
+ * only generates events which are received by a client.
+ *
+ */
+bool ipc_has_event_subscribers(uint32_t message_type, const char *change) {
+    const uint32_t type = (message_type & ~I3_IPC_EVENT_MASK);
+    assert(type < IPC_EVENT_COUNT);
+
+    ipc_client *current;
+    TAILQ_FOREACH (current, &subscribers[type], subscriptions[type]) {
+        if (client_wants_event(current, type, change, NULL)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Sends the specified event to all IPC clients which are subscribed to this
+ * kind of event and whose subscription filters (if any) match the given
+ * change and container. change and con may be NULL if the event has no change
+ * field or is not about a window.
+ *
+ * The payload is written by marshal(gen, data) when the first receiving
+ * client is found, once per encoding, and shared by all receiving clients.
+ *
+ */
+void ipc_send_filtered_event(const char *event, uint32_t message_type, const char *change, Con *con, ipc_event_marshaller marshal, void *data) {
+    TRACE_SPAN(span, "ipc_event", event, -1);
+    const uint32_t type = (message_type & ~I3_IPC_EVENT_MASK);
+    assert(type < IPC_EVENT_COUNT);
+
+    ipc_chunk *json_chunk = NULL;
+    ipc_chunk *cbor_chunk = NULL;
+    ipc_client *current;
+    TAILQ_FOREACH (current, &subscribers[type], subscriptions[type]) {
+        if (!client_wants_event(current, type, change, con)) {
+            continue;
+        }
+        ipc_chunk **chunk = (current->cbor_events ? &cbor_chunk : &json_chunk);
+        if (*chunk == NULL) {
+            *chunk = ipc_chunk_new_event(message_type, marshal, data, current->cbor_events);
+        }
+        ipc_queue_chunk(current, *chunk);
+    }
+    if (json_chunk != NULL) {
+        ipc_chunk_unref(json_chunk);
+    }
+    if (cbor_chunk != NULL) {
+        ipc_chunk_unref(cbor_chunk);
+    }
+}
+
 /*
  * Sends the specified event to all IPC clients which are currently connected
  * and subscribed to this kind of event.
  *
  */
-void ipc_send_event(const char *event, uint32_t message_type, const char *payload) {
+void ipc_send_event(const char *event, uint32_t message_type, ipc_event_marshaller marshal, void *data) {
+    ipc_send_filtered_event(event, message_type, NULL, NULL, marshal, data);
+}
+
+/*
+ * An event which was generated in advance, see ipc_prepare_workspace_event().
+ *
+ */
+struct ipc_prepared_event {
+    const char *event;
+    uint32_t message_type;
+    char *change;
+
+    /* NULL if no subscriber receives the event in that encoding. */
+    ipc_chunk *json_chunk;
+    ipc_chunk *cbor_chunk;
+};
+
+/*
+ * Generates an event for all subscribers whose filters match the given change,
+ * to be sent later with ipc_send_prepared_event().
+ *
+ */
+static ipc_prepared_event *ipc_prepare_event(const char *event, uint32_t message_type, const char *change, ipc_event_marshaller marshal, void *data) {
+    const uint32_t type = (message_type & ~I3_IPC_EVENT_MASK);
+    assert(type < IPC_EVENT_COUNT);
+
+    ipc_prepared_event *prepared = scalloc(1, sizeof(ipc_prepared_event));
+    prepared->event = event;
+    prepared->message_type = message_type;
+    prepared->change = sstrdup(change);
+
     ipc_client *current;
-    TAILQ_FOREACH (current, &all_clients, clients) {
-        for (int i = 0; i < current->num_events; i++) {
-            if (strcasecmp(current->events[i], event) == 0) {
-                ipc_send_client_message(current, strlen(payload), message_type, (uint8_t *)payload);
-                break;
-            }
+    TAILQ_FOREACH (current, &subscribers[type], subscriptions[type]) {
+        if (!client_wants_event(current, type, change, NULL)) {
+            continue;
+        }
+        ipc_chunk **chunk = (current->cbor_events ? &(prepared->cbor_chunk) : &(prepared->json_chunk));
+        if (*chunk == NULL) {
+            *chunk = ipc_chunk_new_event(message_type, marshal, data, current->cbor_events);
         }
     }
+    return prepared;
 }
 
 /*
- * For shutdown events, we send the reason for the shutdown.
+ * Sends an event generated by ipc_prepare_workspace_event() (if there were
+ * any subscribers for it) and frees it.
+ *
  */
-static void ipc_send_shutdown_event(shutdown_reason_t reason) {
-    yajl_gen gen = ygenalloc();
+void ipc_send_prepared_event(ipc_prepared_event *prepared) {
+    TRACE_SPAN(span, "ipc_event", prepared->event, -1);
+    const uint32_t type = (prepared->message_type & ~I3_IPC_EVENT_MASK);
+
+    ipc_client *current;
+    TAILQ_FOREACH (current, &subscribers[type], subscriptions[type]) {
+        ipc_chunk *chunk = (current->cbor_events ? prepared->cbor_chunk : prepared->json_chunk);
+        if (chunk != NULL && client_wants_event(current, type, prepared->change, NULL)) {
+            ipc_queue_chunk(current, chunk);
+        }
+    }
+    if (prepared->json_chunk != NULL) {
+        ipc_chunk_unref(prepared->json_chunk);
+    }
+    if (prepared->cbor_chunk != NULL) {
+        ipc_chunk_unref(prepared->cbor_chunk);
+    }
+    free(prepared->change);
+    free(prepared);
+}
+
+static void marshal_change_event(ipc_gen *gen, void *data) {
     y(map_open);
 
     ystr("change");
-
-    if (reason == SHUTDOWN_REASON_RESTART) {
-        ystr("restart");
-    } else if (reason == SHUTDOWN_REASON_EXIT) {
-        ystr("exit");
-    }
+    ystr((const char *)data);
 
     y(map_close);
+}
 
+struct tick_event {
+    bool first;
     const unsigned char *payload;
-    ylength length;
+    size_t length;
+};
 
-    y(get_buf, &payload, &length);
-    ipc_send_event("shutdown", I3_IPC_EVENT_SHUTDOWN, (const char *)payload);
+static void marshal_tick_event(ipc_gen *gen, void *data) {
+    struct tick_event *tick = data;
 
-    y(free);
+    y(map_open);
+
+    ystr("first");
+    y(bool, tick->first);
+
+    ystr("payload");
+    y(string, tick->payload, tick->length);
+
+    y(map_close);
+}
+
+/*
+ * For shutdown events, we send the reason for the shutdown.
+ */
+static void ipc_send_shutdown_event(shutdown_reason_t reason) {
+    const char *change = (reason == SHUTDOWN_REASON_RESTART ? "restart" : "exit");
+    ipc_send_filtered_event("shutdown", I3_IPC_EVENT_SHUTDOWN, change, NULL, marshal_change_event, (void *)change);
 }
 
 /*
@@ -207,32 +618,207 @@ void ipc_shutdown(shutdown_reason_t reason, int exempt_fd) {
  *
  */
 IPC_HANDLER(run_command) {
+    const uint64_t start = trace_now();
     /* To get a properly terminated buffer, we copy
      * message_size bytes out of the buffer */
     char *command = sstrndup((const char *)message, message_size);
     LOG("IPC: received: *%.4000s*\n", command);
-    yajl_gen gen = yajl_gen_alloc(NULL);
+    ipc_gen *gen = ygenalloc();
+
+    /* With render_batching, renders requested in the middle of a command
+     * chain are deferred until the whole chain was run. */
+    const bool batching = config.render_batching;
+    if (batching) {
+        tree_render_set_batching(true);
+    }
 
     CommandResult *result = parse_command(command, gen, client);
-    free(command);
 
     if (result->needs_tree_render) {
         tree_render();
     }
+    if (batching) {
+        tree_render_set_batching(false);
+    }
+
+    /* Only valid commands get a histogram. Its name comes from the parser's
+     * token table, so arbitrary input cannot create more of them. */
+    if (!result->parse_error) {
+        latency_measure_command(result->command_name, start);
+    }
+    free(command);
 
     command_result_free(result);
 
     const unsigned char *reply;
     ylength length;
-    yajl_gen_get_buf(gen, &reply, &length);
+    y(get_buf, &reply, &length);
 
     ipc_send_client_message(client, length, I3_IPC_REPLY_TYPE_COMMAND,
                             (const uint8_t *)reply);
 
-    yajl_gen_free(gen);
+    y(free);
+}
+
+struct transaction_json_state {
+    int depth;
+    char **commands;
+    int num_commands;
+    int capacity;
+    char *error;
+};
+
+static int transaction_start_array_cb(void *extra) {
+    struct transaction_json_state *state = extra;
+    if (state->depth++ > 0) {
+        sasprintf(&(state->error), "expected an array of strings");
+        return 0;
+    }
+    return 1;
+}
+
+static int transaction_end_array_cb(void *extra) {
+    struct transaction_json_state *state = extra;
+    state->depth--;
+    return 1;
+}
+
+static int transaction_string_cb(void *extra, const unsigned char *s, ylength len) {
+    struct transaction_json_state *state = extra;
+    if (state->depth != 1) {
+        sasprintf(&(state->error), "expected an array of strings");
+        return 0;
+    }
+    if (state->num_commands == state->capacity) {
+        state->capacity = (state->capacity == 0 ? 8 : state->capacity * 2);
+        state->commands = srealloc(state->commands, state->capacity * sizeof(char *));
+    }
+    state->commands[state->num_commands++] = sstrndup((const char *)s, len);
+    return 1;
 }
 
-static void dump_rect(yajl_gen gen, const char *name, Rect r) {
+static int transaction_other_cb(void *extra) {
+    struct transaction_json_state *state = extra;
+    sasprintf(&(state->error), "expected an array of strings");
+    return 0;
+}
+
+static int transaction_other_bool_cb(void *extra, int val) {
+    return transaction_other_cb(extra);
+}
+
+static int transaction_other_number_cb(void *extra, const char *s, ylength len) {
+    return transaction_other_cb(extra);
+}
+
+/*
+ * Runs a list of commands as one transaction: no X11 event is handled and
+ * nothing is rendered between the commands, so that the criteria of every
+ * command are matched against the tree as the previous commands of the
+ * transaction left it. The tree is rendered (and pushed to X11) once
+ * afterwards.
+ *
+ */
+IPC_HANDLER(run_transaction) {
+    const uint64_t start = trace_now();
+    struct transaction_json_state state = {0};
+
+    static yajl_callbacks callbacks = {
+        .yajl_null = transaction_other_cb,
+        .yajl_boolean = transaction_other_bool_cb,
+        .yajl_number = transaction_other_number_cb,
+        .yajl_string = transaction_string_cb,
+        .yajl_start_map = transaction_other_cb,
+        .yajl_start_array = transaction_start_array_cb,
+        .yajl_end_array = transaction_end_array_cb,
+    };
+
+    yajl_handle p = yalloc(&callbacks, (void *)&state);
+    yajl_status stat = yajl_parse(p, (const unsigned char *)message, message_size);
+    if (stat == yajl_status_ok) {
+        stat = yajl_complete_parse(p);
+    }
+    if (stat != yajl_status_ok && state.error == NULL) {
+        unsigned char *err = yajl_get_error(p, false, (const unsigned char *)message, message_size);
+        state.error = sstrdup((const char *)err);
+        yajl_free_error(p, err);
+    }
+    yajl_free(p);
+
+    ipc_gen *gen = ygenalloc();
+
+    if (state.error != NULL) {
+        ELOG("Invalid RUN_TRANSACTION request: %s\n", state.error);
+        y(map_open);
+        ystr("success");
+        y(bool, false);
+        ystr("error");
+        ystr(state.error);
+        y(map_close);
+    } else {
+        TRACE_SPAN(span, "transaction", NULL, state.num_commands);
+        LOG("IPC: received transaction of %d commands\n", state.num_commands);
+
+        /* Renders requested by the commands (or by the functions they call)
+         * are deferred until the end of the transaction. */
+        tree_render_set_batching(true);
+
+        /* Property changes which are still being coalesced are applied first,
+         * so that the criteria see the current window titles. */
+        handle_coalesced_property_changes(true);
+
+        bool needs_tree_render = false;
+        bool parse_error = false;
+        y(array_open);
+        for (int i = 0; i < state.num_commands; i++) {
+            if (parse_error) {
+                /* Keep one reply per command even though the rest of the
+                 * transaction is skipped. */
+                y(array_open);
+                y(map_open);
+                ystr("success");
+                y(bool, false);
+                ystr("error");
+                ystr("Not run because a previous command could not be parsed");
+                y(map_close);
+                y(array_close);
+                continue;
+            }
+
+            CommandResult *result = parse_command(state.commands[i], gen, client);
+            needs_tree_render |= result->needs_tree_render;
+            parse_error = result->parse_error;
+            command_result_free(result);
+        }
+        y(array_close);
+
+        if (needs_tree_render) {
+            tree_render();
+        }
+        tree_render_set_batching(false);
+
+        if (!parse_error) {
+            latency_measure("transaction", start);
+        }
+    }
+
+    for (int i = 0; i < state.num_commands; i++) {
+        free(state.commands[i]);
+    }
+    free(state.commands);
+    free(state.error);
+
+    const unsigned char *reply;
+    ylength length;
+    y(get_buf, &reply, &length);
+
+    ipc_send_client_message(client, length, I3_IPC_REPLY_TYPE_TRANSACTION,
+                            (const uint8_t *)reply);
+
+    y(free);
+}
+
+static void dump_rect(ipc_gen *gen, const char *name, Rect r) {
     ystr(name);
     y(map_open);
     ystr("x");
@@ -246,7 +832,7 @@ static void dump_rect(yajl_gen gen, const char *name, Rect r) {
     y(map_close);
 }
 
-static void dump_gaps(yajl_gen gen, const char *name, gaps_t gaps) {
+static void dump_gaps(ipc_gen *gen, const char *name, gaps_t gaps) {
     ystr(name);
     y(map_open);
     ystr("inner");
@@ -268,7 +854,7 @@ static void dump_gaps(yajl_gen gen, const char *name, gaps_t gaps) {
     y(map_close);
 }
 
-static void dump_event_state_mask(yajl_gen gen, Binding *bind) {
+static void dump_event_state_mask(ipc_gen *gen, Binding *bind) {
     y(array_open);
     for (int i = 0; i < 20; i++) {
         if (bind->event_state_mask & (1 << i)) {
@@ -330,7 +916,7 @@ static void dump_event_state_mask(yajl_gen gen, Binding *bind) {
     y(array_close);
 }
 
-static void dump_binding(yajl_gen gen, Binding *bind) {
+static void dump_binding(ipc_gen *gen, Binding *bind) {
     y(map_open);
     ystr("input_code");
     y(integer, bind->keycode);
@@ -359,229 +945,366 @@ static void dump_binding(yajl_gen gen, Binding *bind) {
     y(map_close);
 }
 
-void dump_node(yajl_gen gen, struct Con *con, bool inplace_restart) {
+/* The fields of a container which can be selected in a GET_TREE request. The
+ * order needs to match dump_field_names. */
+typedef enum {
+    DUMP_ID,
+    DUMP_GENERATION,
+    DUMP_TYPE,
+    DUMP_ORIENTATION,
+    DUMP_SCRATCHPAD_STATE,
+    DUMP_PERCENT,
+    DUMP_URGENT,
+    DUMP_MARKS,
+    DUMP_FOCUSED,
+    DUMP_OUTPUT,
+    DUMP_LAYOUT,
+    DUMP_WORKSPACE_LAYOUT,
+    DUMP_LAST_SPLIT_LAYOUT,
+    DUMP_BORDER,
+    DUMP_CURRENT_BORDER_WIDTH,
+    DUMP_RECT,
+    DUMP_DECO_RECT,
+    DUMP_WINDOW_RECT,
+    DUMP_GEOMETRY,
+    DUMP_NAME,
+    DUMP_TITLE_FORMAT,
+    DUMP_WINDOW_ICON_PADDING,
+    DUMP_NUM,
+    DUMP_GAPS,
+    DUMP_WINDOW,
+    DUMP_WINDOW_TYPE,
+    DUMP_WINDOW_PROPERTIES,
+    DUMP_NODES,
+    DUMP_FLOATING_NODES,
+    DUMP_FOCUS,
+    DUMP_FULLSCREEN_MODE,
+    DUMP_STICKY,
+    DUMP_FLOATING,
+    DUMP_SWALLOWS,
+    DUMP_FIELD_COUNT
+} dump_field_t;
+
+static const char *dump_field_names[DUMP_FIELD_COUNT] = {
+    "id",
+    "generation",
+    "type",
+    "orientation",
+    "scratchpad_state",
+    "percent",
+    "urgent",
+    "marks",
+    "focused",
+    "output",
+    "layout",
+    "workspace_layout",
+    "last_split_layout",
+    "border",
+    "current_border_width",
+    "rect",
+    "deco_rect",
+    "window_rect",
+    "geometry",
+    "name",
+    "title_format",
+    "window_icon_padding",
+    "num",
+    "gaps",
+    "window",
+    "window_type",
+    "window_properties",
+    "nodes",
+    "floating_nodes",
+    "focus",
+    "fullscreen_mode",
+    "sticky",
+    "floating",
+    "swallows",
+};
+
+#define DUMP_ALL_FIELDS UINT64_MAX
+#define WANT(field) (fields & (1ULL << (field)))
+
+/*
+ * Dumps the given fields (a bitmask of (1 << dump_field_t)) of the container
+ * and, up to depth levels (-1 for all), its children.
+ *
+ */
+static void dump_node_fields(ipc_gen *gen, struct Con *con, bool inplace_restart, uint64_t fields, int depth) {
     y(map_open);
-    ystr("id");
-    y(integer, (uintptr_t)con);
+    if (WANT(DUMP_ID)) {
+        ystr("id");
+        y(integer, (uintptr_t)con);
+    }
 
-    ystr("type");
-    switch (con->type) {
-        case CT_ROOT:
-            ystr("root");
-            break;
-        case CT_OUTPUT:
-            ystr("output");
-            break;
-        case CT_CON:
-            ystr("con");
-            break;
-        case CT_FLOATING_CON:
-            ystr("floating_con");
-            break;
-        case CT_WORKSPACE:
-            ystr("workspace");
-            break;
-        case CT_DOCKAREA:
-            ystr("dockarea");
-            break;
+    if (con->type == CT_ROOT && !inplace_restart && WANT(DUMP_GENERATION)) {
+        /* Clients applying tree_delta events continue after this one. */
+        ystr("generation");
+        y(integer, tree_delta_generation());
     }
 
-    /* provided for backwards compatibility only. */
-    ystr("orientation");
-    if (!con_is_split(con)) {
-        ystr("none");
-    } else {
-        if (con_orientation(con) == HORIZ) {
-            ystr("horizontal");
-        } else {
-            ystr("vertical");
+    if (WANT(DUMP_TYPE)) {
+        ystr("type");
+        switch (con->type) {
+            case CT_ROOT:
+                ystr("root");
+                break;
+            case CT_OUTPUT:
+                ystr("output");
+                break;
+            case CT_CON:
+                ystr("con");
+                break;
+            case CT_FLOATING_CON:
+                ystr("floating_con");
+                break;
+            case CT_WORKSPACE:
+                ystr("workspace");
+                break;
+            case CT_DOCKAREA:
+                ystr("dockarea");
+                break;
         }
     }
 
-    ystr("scratchpad_state");
-    switch (con->scratchpad_state) {
-        case SCRATCHPAD_NONE:
+    if (WANT(DUMP_ORIENTATION)) {
+        /* provided for backwards compatibility only. */
+        ystr("orientation");
+        if (!con_is_split(con)) {
             ystr("none");
-            break;
-        case SCRATCHPAD_FRESH:
-            ystr("fresh");
-            break;
-        case SCRATCHPAD_CHANGED:
-            ystr("changed");
-            break;
+        } else {
+            if (con_orientation(con) == HORIZ) {
+                ystr("horizontal");
+            } else {
+                ystr("vertical");
+            }
+        }
     }
 
-    ystr("percent");
-    if (con->percent == 0.0) {
-        y(null);
-    } else {
-        y(double, con->percent);
+    if (WANT(DUMP_SCRATCHPAD_STATE)) {
+        ystr("scratchpad_state");
+        switch (con->scratchpad_state) {
+            case SCRATCHPAD_NONE:
+                ystr("none");
+                break;
+            case SCRATCHPAD_FRESH:
+                ystr("fresh");
+                break;
+            case SCRATCHPAD_CHANGED:
+                ystr("changed");
+                break;
+        }
+    }
+
+    if (WANT(DUMP_PERCENT)) {
+        ystr("percent");
+        if (con->percent == 0.0) {
+            y(null);
+        } else {
+            y(double, con->percent);
+        }
     }
 
-    ystr("urgent");
-    y(bool, con->urgent);
+    if (WANT(DUMP_URGENT)) {
+        ystr("urgent");
+        y(bool, con->urgent);
+    }
 
-    ystr("marks");
-    y(array_open);
-    mark_t *mark;
-    TAILQ_FOREACH (mark, &(con->marks_head), marks) {
-        ystr(mark->name);
+    if (WANT(DUMP_MARKS)) {
+        ystr("marks");
+        y(array_open);
+        mark_t *mark;
+        TAILQ_FOREACH (mark, &(con->marks_head), marks) {
+            ystr(mark->name);
+        }
+        y(array_close);
     }
-    y(array_close);
 
-    ystr("focused");
-    y(bool, (con == focused));
+    if (WANT(DUMP_FOCUSED)) {
+        ystr("focused");
+        y(bool, (con == focused));
+    }
 
-    if (con->type != CT_ROOT && con->type != CT_OUTPUT) {
+    if (con->type != CT_ROOT && con->type != CT_OUTPUT && WANT(DUMP_OUTPUT)) {
         ystr("output");
         ystr(con_get_output(con)->name);
     }
 
-    ystr("layout");
-    switch (con->layout) {
-        case L_DEFAULT:
-            DLOG("About to dump layout=default, this is a bug in the code.\n");
-            assert(false);
-            break;
-        case L_SPLITV:
-            ystr("splitv");
-            break;
-        case L_SPLITH:
-            ystr("splith");
-            break;
-        case L_STACKED:
-            ystr("stacked");
-            break;
-        case L_TABBED:
-            ystr("tabbed");
-            break;
-        case L_DOCKAREA:
-            ystr("dockarea");
-            break;
-        case L_OUTPUT:
-            ystr("output");
-            break;
+    if (WANT(DUMP_LAYOUT)) {
+        ystr("layout");
+        switch (con->layout) {
+            case L_DEFAULT:
+                DLOG("About to dump layout=default, this is a bug in the code.\n");
+                assert(false);
+                break;
+            case L_SPLITV:
+                ystr("splitv");
+                break;
+            case L_SPLITH:
+                ystr("splith");
+                break;
+            case L_STACKED:
+                ystr("stacked");
+                break;
+            case L_TABBED:
+                ystr("tabbed");
+                break;
+            case L_DOCKAREA:
+                ystr("dockarea");
+                break;
+            case L_OUTPUT:
+                ystr("output");
+                break;
+        }
     }
 
-    ystr("workspace_layout");
-    switch (con->workspace_layout) {
-        case L_DEFAULT:
-            ystr("default");
-            break;
-        case L_STACKED:
-            ystr("stacked");
-            break;
-        case L_TABBED:
-            ystr("tabbed");
-            break;
-        default:
-            DLOG("About to dump workspace_layout=%d (none of default/stacked/tabbed), this is a bug.\n", con->workspace_layout);
-            assert(false);
-            break;
+    if (WANT(DUMP_WORKSPACE_LAYOUT)) {
+        ystr("workspace_layout");
+        switch (con->workspace_layout) {
+            case L_DEFAULT:
+                ystr("default");
+                break;
+            case L_STACKED:
+                ystr("stacked");
+                break;
+            case L_TABBED:
+                ystr("tabbed");
+                break;
+            default:
+                DLOG("About to dump workspace_layout=%d (none of default/stacked/tabbed), this is a bug.\n", con->workspace_layout);
+                assert(false);
+                break;
+        }
     }
 
-    ystr("last_split_layout");
-    switch (con->layout) {
-        case L_SPLITV:
-            ystr("splitv");
-            break;
-        default:
-            ystr("splith");
-            break;
+    if (WANT(DUMP_LAST_SPLIT_LAYOUT)) {
+        ystr("last_split_layout");
+        switch (con->layout) {
+            case L_SPLITV:
+                ystr("splitv");
+                break;
+            default:
+                ystr("splith");
+                break;
+        }
     }
 
-    ystr("border");
-    switch (con->border_style) {
-        case BS_NORMAL:
-            ystr("normal");
-            break;
-        case BS_NONE:
-            ystr("none");
-            break;
-        case BS_PIXEL:
-            ystr("pixel");
-            break;
+    if (WANT(DUMP_BORDER)) {
+        ystr("border");
+        switch (con->border_style) {
+            case BS_NORMAL:
+                ystr("normal");
+                break;
+            case BS_NONE:
+                ystr("none");
+                break;
+            case BS_PIXEL:
+                ystr("pixel");
+                break;
+        }
     }
 
-    ystr("current_border_width");
-    y(integer, con->current_border_width);
+    if (WANT(DUMP_CURRENT_BORDER_WIDTH)) {
+        ystr("current_border_width");
+        y(integer, con->current_border_width);
+    }
 
-    dump_rect(gen, "rect", con->rect);
-    if (con_draw_decoration_into_frame(con)) {
-        Rect simulated_deco_rect = con->deco_rect;
-        simulated_deco_rect.x = con->rect.x - con->parent->rect.x;
-        simulated_deco_rect.y = con->rect.y - con->parent->rect.y;
-        dump_rect(gen, "deco_rect", simulated_deco_rect);
-        dump_rect(gen, "actual_deco_rect", con->deco_rect);
-    } else {
-        dump_rect(gen, "deco_rect", con->deco_rect);
+    if (WANT(DUMP_RECT)) {
+        dump_rect(gen, "rect", con->rect);
+    }
+    if (WANT(DUMP_DECO_RECT)) {
+        if (con_draw_decoration_into_frame(con)) {
+            Rect simulated_deco_rect = con->deco_rect;
+            simulated_deco_rect.x = con->rect.x - con->parent->rect.x;
+            simulated_deco_rect.y = con->rect.y - con->parent->rect.y;
+            dump_rect(gen, "deco_rect", simulated_deco_rect);
+            dump_rect(gen, "actual_deco_rect", con->deco_rect);
+        } else {
+            dump_rect(gen, "deco_rect", con->deco_rect);
+        }
+    }
+    if (WANT(DUMP_WINDOW_RECT)) {
+        dump_rect(gen, "window_rect", con->window_rect);
+    }
+    if (WANT(DUMP_GEOMETRY)) {
+        dump_rect(gen, "geometry", con->geometry);
     }
-    dump_rect(gen, "window_rect", con->window_rect);
-    dump_rect(gen, "geometry", con->geometry);
 
-    ystr("name");
-    if (con->window && con->window->name) {
-        ystr(i3string_as_utf8(con->window->name));
-    } else if (con->name != NULL) {
-        ystr(con->name);
-    } else {
-        y(null);
+    if (WANT(DUMP_NAME)) {
+        ystr("name");
+        if (con->window && con->window->name) {
+            ystr(i3string_as_utf8(con->window->name));
+        } else if (con->name != NULL) {
+            ystr(con->name);
+        } else {
+            y(null);
+        }
     }
 
-    if (con->title_format != NULL) {
+    if (con->title_format != NULL && WANT(DUMP_TITLE_FORMAT)) {
         ystr("title_format");
         ystr(con->title_format);
     }
 
-    ystr("window_icon_padding");
-    y(integer, con->window_icon_padding);
+    if (WANT(DUMP_WINDOW_ICON_PADDING)) {
+        ystr("window_icon_padding");
+        y(integer, con->window_icon_padding);
+    }
 
     if (con->type == CT_WORKSPACE) {
-        ystr("num");
-        y(integer, con->num);
+        if (WANT(DUMP_NUM)) {
+            ystr("num");
+            y(integer, con->num);
+        }
 
-        dump_gaps(gen, "gaps", con->gaps);
+        if (WANT(DUMP_GAPS)) {
+            dump_gaps(gen, "gaps", con->gaps);
+        }
     }
 
-    ystr("window");
-    if (con->window) {
-        y(integer, con->window->id);
-    } else {
-        y(null);
+    if (WANT(DUMP_WINDOW)) {
+        ystr("window");
+        if (con->window) {
+            y(integer, con->window->id);
+        } else {
+            y(null);
+        }
     }
 
-    ystr("window_type");
-    if (con->window) {
-        if (con->window->window_type == A__NET_WM_WINDOW_TYPE_NORMAL) {
-            ystr("normal");
-        } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_DOCK) {
-            ystr("dock");
-        } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_DIALOG) {
-            ystr("dialog");
-        } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_UTILITY) {
-            ystr("utility");
-        } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_TOOLBAR) {
-            ystr("toolbar");
-        } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_SPLASH) {
-            ystr("splash");
-        } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_MENU) {
-            ystr("menu");
-        } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_DROPDOWN_MENU) {
-            ystr("dropdown_menu");
-        } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_POPUP_MENU) {
-            ystr("popup_menu");
-        } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_TOOLTIP) {
-            ystr("tooltip");
-        } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_NOTIFICATION) {
-            ystr("notification");
+    if (WANT(DUMP_WINDOW_TYPE)) {
+        ystr("window_type");
+        if (con->window) {
+            if (con->window->window_type == A__NET_WM_WINDOW_TYPE_NORMAL) {
+                ystr("normal");
+            } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_DOCK) {
+                ystr("dock");
+            } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_DIALOG) {
+                ystr("dialog");
+            } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_UTILITY) {
+                ystr("utility");
+            } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_TOOLBAR) {
+                ystr("toolbar");
+            } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_SPLASH) {
+                ystr("splash");
+            } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_MENU) {
+                ystr("menu");
+            } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_DROPDOWN_MENU) {
+                ystr("dropdown_menu");
+            } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_POPUP_MENU) {
+                ystr("popup_menu");
+            } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_TOOLTIP) {
+                ystr("tooltip");
+            } else if (con->window->window_type == A__NET_WM_WINDOW_TYPE_NOTIFICATION) {
+                ystr("notification");
+            } else {
+                ystr("unknown");
+            }
         } else {
-            ystr("unknown");
+            y(null);
         }
-    } else {
-        y(null);
     }
 
-    if (con->window && !inplace_restart) {
+    if (con->window && !inplace_restart && WANT(DUMP_WINDOW_PROPERTIES)) {
         /* Window properties are useless to preserve when restarting because
          * they will be queried again anyway. However, for i3-save-tree(1),
          * they are very useful and save i3-save-tree dealing with X11. */
@@ -616,98 +1339,113 @@ void dump_node(yajl_gen gen, struct Con *con, bool inplace_restart) {
         y(map_close);
     }
 
-    ystr("nodes");
-    y(array_open);
+    /* Children beyond the maximum depth are left out entirely. */
     Con *node;
-    if (con->type != CT_DOCKAREA || !inplace_restart) {
-        TAILQ_FOREACH (node, &(con->nodes_head), nodes) {
-            dump_node(gen, node, inplace_restart);
+    if (WANT(DUMP_NODES) && depth != 0) {
+        ystr("nodes");
+        y(array_open);
+        if (con->type != CT_DOCKAREA || !inplace_restart) {
+            TAILQ_FOREACH (node, &(con->nodes_head), nodes) {
+                dump_node_fields(gen, node, inplace_restart, fields, depth - 1);
+            }
         }
+        y(array_close);
     }
-    y(array_close);
 
-    ystr("floating_nodes");
-    y(array_open);
-    TAILQ_FOREACH (node, &(con->floating_head), floating_windows) {
-        dump_node(gen, node, inplace_restart);
+    if (WANT(DUMP_FLOATING_NODES) && depth != 0) {
+        ystr("floating_nodes");
+        y(array_open);
+        TAILQ_FOREACH (node, &(con->floating_head), floating_windows) {
+            dump_node_fields(gen, node, inplace_restart, fields, depth - 1);
+        }
+        y(array_close);
     }
-    y(array_close);
 
-    ystr("focus");
-    y(array_open);
-    TAILQ_FOREACH (node, &(con->focus_head), focused) {
-        y(integer, (uintptr_t)node);
+    if (WANT(DUMP_FOCUS)) {
+        ystr("focus");
+        y(array_open);
+        TAILQ_FOREACH (node, &(con->focus_head), focused) {
+            y(integer, (uintptr_t)node);
+        }
+        y(array_close);
     }
-    y(array_close);
 
-    ystr("fullscreen_mode");
-    y(integer, con->fullscreen_mode);
-
-    ystr("sticky");
-    y(bool, con->sticky);
+    if (WANT(DUMP_FULLSCREEN_MODE)) {
+        ystr("fullscreen_mode");
+        y(integer, con->fullscreen_mode);
+    }
 
-    ystr("floating");
-    switch (con->floating) {
-        case FLOATING_AUTO_OFF:
-            ystr("auto_off");
-            break;
-        case FLOATING_AUTO_ON:
-            ystr("auto_on");
-            break;
-        case FLOATING_USER_OFF:
-            ystr("user_off");
-            break;
-        case FLOATING_USER_ON:
-            ystr("user_on");
-            break;
+    if (WANT(DUMP_STICKY)) {
+        ystr("sticky");
+        y(bool, con->sticky);
     }
 
-    ystr("swallows");
-    y(array_open);
-    Match *match;
-    TAILQ_FOREACH (match, &(con->swallow_head), matches) {
-        /* We will generate a new restart_mode match specification after this
-         * loop, so skip this one. */
-        if (match->restart_mode) {
-            continue;
-        }
-        y(map_open);
-        if (match->dock != M_DONTCHECK) {
-            ystr("dock");
-            y(integer, match->dock);
-            ystr("insert_where");
-            y(integer, match->insert_where);
+    if (WANT(DUMP_FLOATING)) {
+        ystr("floating");
+        switch (con->floating) {
+            case FLOATING_AUTO_OFF:
+                ystr("auto_off");
+                break;
+            case FLOATING_AUTO_ON:
+                ystr("auto_on");
+                break;
+            case FLOATING_USER_OFF:
+                ystr("user_off");
+                break;
+            case FLOATING_USER_ON:
+                ystr("user_on");
+                break;
         }
+    }
 
-#define DUMP_REGEX(re_name)                \
-    do {                                   \
-        if (match->re_name != NULL) {      \
-            ystr(#re_name);                \
-            ystr(match->re_name->pattern); \
-        }                                  \
-    } while (0)
+    if (WANT(DUMP_SWALLOWS)) {
+        ystr("swallows");
+        y(array_open);
+        Match *match;
+        TAILQ_FOREACH (match, &(con->swallow_head), matches) {
+            /* We will generate a new restart_mode match specification after this
+             * loop, so skip this one. */
+            if (match->restart_mode) {
+                continue;
+            }
+            y(map_open);
+            if (match->dock != M_DONTCHECK) {
+                ystr("dock");
+                y(integer, match->dock);
+                ystr("insert_where");
+                y(integer, match->insert_where);
+            }
 
-        DUMP_REGEX(class);
-        DUMP_REGEX(instance);
-        DUMP_REGEX(window_role);
-        DUMP_REGEX(title);
-        DUMP_REGEX(machine);
+#define DUMP_REGEX(re_name)                    \
+        do {                                   \
+            if (match->re_name != NULL) {      \
+                ystr(#re_name);                \
+                ystr(match->re_name->pattern); \
+            }                                  \
+        } while (0)
 
-#undef DUMP_REGEX
-        y(map_close);
-    }
+            DUMP_REGEX(class);
+            DUMP_REGEX(instance);
+            DUMP_REGEX(window_role);
+            DUMP_REGEX(title);
+            DUMP_REGEX(machine);
 
-    if (inplace_restart) {
-        if (con->window != NULL) {
-            y(map_open);
-            ystr("id");
-            y(integer, con->window->id);
-            ystr("restart_mode");
-            y(bool, true);
+#undef DUMP_REGEX
             y(map_close);
         }
+
+        if (inplace_restart) {
+            if (con->window != NULL) {
+                y(map_open);
+                ystr("id");
+                y(integer, con->window->id);
+                ystr("restart_mode");
+                y(bool, true);
+                y(map_close);
+            }
+        }
+        y(array_close);
     }
-    y(array_close);
 
     if (inplace_restart && con->window != NULL) {
         ystr("depth");
@@ -722,7 +1460,11 @@ void dump_node(yajl_gen gen, struct Con *con, bool inplace_restart) {
     y(map_close);
 }
 
-static void dump_bar_bindings(yajl_gen gen, Barconfig *config) {
+void dump_node(ipc_gen *gen, struct Con *con, bool inplace_restart) {
+    dump_node_fields(gen, con, inplace_restart, DUMP_ALL_FIELDS, -1);
+}
+
+static void dump_bar_bindings(ipc_gen *gen, Barconfig *config) {
     if (TAILQ_EMPTY(&(config->bar_bindings))) {
         return;
     }
@@ -756,7 +1498,7 @@ static char *canonicalize_output_name(char *name) {
     return output ? output_primary_name(output) : name;
 }
 
-static void dump_bar_config(yajl_gen gen, Barconfig *config) {
+static void dump_bar_config(ipc_gen *gen, Barconfig *config) {
     y(map_open);
 
     ystr("id");
@@ -859,12 +1601,26 @@ static void dump_bar_config(yajl_gen gen, Barconfig *config) {
     ystr("workspace_min_width");
     y(integer, config->workspace_min_width);
 
+    ystr("status_redraw_interval");
+    y(integer, config->status_redraw_interval);
+
     ystr("strip_workspace_numbers");
     y(bool, config->strip_workspace_numbers);
 
     ystr("strip_workspace_name");
     y(bool, config->strip_workspace_name);
 
+    ystr("gradients");
+    y(bool, config->gradients);
+
+    ystr("dithering");
+    y(bool, config->dithering);
+
+    ystr("dither_noise");
+    setlocale(LC_NUMERIC, "C");
+    y(double, config->dither_noise);
+    setlocale(LC_NUMERIC, "");
+
     ystr("binding_mode_indicator");
     y(bool, !config->hide_binding_mode_indicator);
 
@@ -888,38 +1644,236 @@ static void dump_bar_config(yajl_gen gen, Barconfig *config) {
     YSTR_IF_SET(focused_background);
     YSTR_IF_SET(focused_statusline);
     YSTR_IF_SET(focused_separator);
+    YSTR_IF_SET(gradient_start);
+    YSTR_IF_SET(gradient_end);
+    YSTR_IF_SET(focused_gradient_start);
+    YSTR_IF_SET(focused_gradient_end);
     YSTR_IF_SET(focused_workspace_border);
     YSTR_IF_SET(focused_workspace_bg);
     YSTR_IF_SET(focused_workspace_text);
+    YSTR_IF_SET(focused_workspace_gradient);
     YSTR_IF_SET(active_workspace_border);
     YSTR_IF_SET(active_workspace_bg);
     YSTR_IF_SET(active_workspace_text);
+    YSTR_IF_SET(active_workspace_gradient);
     YSTR_IF_SET(inactive_workspace_border);
     YSTR_IF_SET(inactive_workspace_bg);
     YSTR_IF_SET(inactive_workspace_text);
+    YSTR_IF_SET(inactive_workspace_gradient);
     YSTR_IF_SET(urgent_workspace_border);
     YSTR_IF_SET(urgent_workspace_bg);
     YSTR_IF_SET(urgent_workspace_text);
+    YSTR_IF_SET(urgent_workspace_gradient);
     YSTR_IF_SET(binding_mode_border);
     YSTR_IF_SET(binding_mode_bg);
     YSTR_IF_SET(binding_mode_text);
+    YSTR_IF_SET(binding_mode_gradient);
+    y(map_close);
+
     y(map_close);
+#undef YSTR_IF_SET
+}
+
+/* State of parsing a GET_TREE payload like
+ * {"con_id": 94251026143360, "max_depth": 2, "fields": ["id", "name"]}. */
+struct tree_json_state {
+    char *last_key;
+    int map_depth;
+    bool in_fields;
+    bool in_criteria;
+
+    long long con_id;
+    int max_depth;
+    uint64_t fields;
+    Match *match;
+
+    char *error;
+};
+
+static int tree_map_key_cb(void *extra, const unsigned char *s, ylength len) {
+    struct tree_json_state *state = extra;
+    FREE(state->last_key);
+    state->last_key = sstrndup((const char *)s, len);
+    return 1;
+}
+
+static int tree_start_map_cb(void *extra) {
+    struct tree_json_state *state = extra;
+    state->map_depth++;
+
+    if (state->map_depth == 1) {
+        return 1;
+    }
+    if (state->map_depth == 2 && strcmp(state->last_key, "criteria") == 0 && state->match == NULL) {
+        state->match = smalloc(sizeof(Match));
+        match_init(state->match);
+        state->in_criteria = true;
+        return 1;
+    }
+
+    sasprintf(&(state->error), "unexpected map");
+    return 0;
+}
+
+static int tree_end_map_cb(void *extra) {
+    struct tree_json_state *state = extra;
+    state->map_depth--;
+    state->in_criteria = false;
+    return 1;
+}
+
+static int tree_start_array_cb(void *extra) {
+    struct tree_json_state *state = extra;
+    if (state->map_depth == 1 && !state->in_fields && strcmp(state->last_key, "fields") == 0) {
+        state->in_fields = true;
+        return 1;
+    }
 
-    y(map_close);
-#undef YSTR_IF_SET
+    sasprintf(&(state->error), "unexpected array");
+    return 0;
+}
+
+static int tree_end_array_cb(void *extra) {
+    struct tree_json_state *state = extra;
+    state->in_fields = false;
+    return 1;
+}
+
+static int tree_integer_cb(void *extra, long long val) {
+    struct tree_json_state *state = extra;
+
+    if (state->map_depth == 1 && strcmp(state->last_key, "con_id") == 0) {
+        state->con_id = val;
+        return 1;
+    }
+    if (state->map_depth == 1 && strcmp(state->last_key, "max_depth") == 0 && val >= 0) {
+        state->max_depth = (val > INT_MAX ? INT_MAX : (int)val);
+        return 1;
+    }
+
+    sasprintf(&(state->error), "unexpected integer");
+    return 0;
+}
+
+static int tree_string_cb(void *extra, const unsigned char *s, ylength len) {
+    struct tree_json_state *state = extra;
+
+    if (state->in_criteria) {
+        char *value = sstrndup((const char *)s, len);
+        match_parse_property(state->match, state->last_key, value);
+        free(value);
+        return 1;
+    }
+
+    if (state->in_fields) {
+        for (int i = 0; i < DUMP_FIELD_COUNT; i++) {
+            if (strlen(dump_field_names[i]) == len && strncmp(dump_field_names[i], (const char *)s, len) == 0) {
+                state->fields |= (1ULL << i);
+                return 1;
+            }
+        }
+        sasprintf(&(state->error), "unknown field %.*s", (int)len, s);
+        return 0;
+    }
+
+    sasprintf(&(state->error), "unexpected string");
+    return 0;
 }
 
+/*
+ * Dumps the layout tree. The optional payload selects the containers (by
+ * con_id or criteria), the maximum depth and the fields to dump.
+ *
+ */
 IPC_HANDLER(tree) {
+    struct tree_json_state state = {
+        .max_depth = -1,
+    };
+
+    if (message_size > 0) {
+        static yajl_callbacks callbacks = {
+            .yajl_map_key = tree_map_key_cb,
+            .yajl_start_map = tree_start_map_cb,
+            .yajl_end_map = tree_end_map_cb,
+            .yajl_start_array = tree_start_array_cb,
+            .yajl_end_array = tree_end_array_cb,
+            .yajl_integer = tree_integer_cb,
+            .yajl_string = tree_string_cb,
+        };
+
+        yajl_handle p = yalloc(&callbacks, (void *)&state);
+        yajl_status stat = yajl_parse(p, (const unsigned char *)message, message_size);
+        if (stat == yajl_status_ok) {
+            stat = yajl_complete_parse(p);
+        }
+        if (stat != yajl_status_ok && state.error == NULL) {
+            unsigned char *err = yajl_get_error(p, false, (const unsigned char *)message, message_size);
+            state.error = sstrdup((const char *)err);
+            yajl_free_error(p, err);
+        }
+        yajl_free(p);
+
+        if (state.error == NULL && state.match != NULL) {
+            if (state.match->error != NULL) {
+                sasprintf(&(state.error), "invalid criteria: %s", state.match->error);
+            } else if (state.con_id != 0) {
+                sasprintf(&(state.error), "con_id and criteria cannot be combined");
+            }
+        }
+    }
+
+    Con *start = croot;
+    if (state.error == NULL && state.con_id != 0) {
+        start = con_by_con_id(state.con_id);
+        if (start == NULL) {
+            sasprintf(&(state.error), "no container with con_id %lld", state.con_id);
+        }
+    }
+
+    FREE(state.last_key);
+    if (state.error != NULL) {
+        ELOG("Invalid GET_TREE request: %s\n", state.error);
+        ipc_gen *gen = ipc_reply_gen_alloc(message_type);
+        y(map_open);
+        ystr("success");
+        y(bool, false);
+        ystr("error");
+        ystr(state.error);
+        y(map_close);
+
+        ipc_send_client_reply(client, I3_IPC_REPLY_TYPE_TREE, gen);
+        y(free);
+        free(state.error);
+        if (state.match != NULL) {
+            match_free(state.match);
+            free(state.match);
+        }
+        return;
+    }
+
+    const uint64_t fields = (state.fields == 0 ? DUMP_ALL_FIELDS : state.fields);
+
     setlocale(LC_NUMERIC, "C");
-    yajl_gen gen = ygenalloc();
-    dump_node(gen, croot, false);
-    setlocale(LC_NUMERIC, "");
+    ipc_gen *gen = ipc_reply_gen_alloc(message_type);
+    if (state.match != NULL) {
+        /* All matching containers, with their children. */
+        y(array_open);
+        Con *con;
+        TAILQ_FOREACH (con, &all_cons, all_cons) {
+            if (con_matches_criteria(state.match, con)) {
+                dump_node_fields(gen, con, false, fields, state.max_depth);
+            }
+        }
+        y(array_close);
 
-    const unsigned char *payload;
-    ylength length;
-    y(get_buf, &payload, &length);
+        match_free(state.match);
+        free(state.match);
+    } else {
+        dump_node_fields(gen, start, false, fields, state.max_depth);
+    }
+    setlocale(LC_NUMERIC, "");
 
-    ipc_send_client_message(client, length, I3_IPC_REPLY_TYPE_TREE, payload);
+    ipc_send_client_reply(client, I3_IPC_REPLY_TYPE_TREE, gen);
     y(free);
 }
 
@@ -929,7 +1883,7 @@ IPC_HANDLER(tree) {
  *
  */
 IPC_HANDLER(get_workspaces) {
-    yajl_gen gen = ygenalloc();
+    ipc_gen *gen = ipc_reply_gen_alloc(message_type);
     y(array_open);
 
     Con *focused_ws = con_get_workspace(focused);
@@ -983,11 +1937,7 @@ IPC_HANDLER(get_workspaces) {
 
     y(array_close);
 
-    const unsigned char *payload;
-    ylength length;
-    y(get_buf, &payload, &length);
-
-    ipc_send_client_message(client, length, I3_IPC_REPLY_TYPE_WORKSPACES, payload);
+    ipc_send_client_reply(client, I3_IPC_REPLY_TYPE_WORKSPACES, gen);
     y(free);
 }
 
@@ -997,7 +1947,7 @@ IPC_HANDLER(get_workspaces) {
  *
  */
 IPC_HANDLER(get_outputs) {
-    yajl_gen gen = ygenalloc();
+    ipc_gen *gen = ipc_reply_gen_alloc(message_type);
     y(array_open);
 
     Output *output;
@@ -1038,11 +1988,7 @@ IPC_HANDLER(get_outputs) {
 
     y(array_close);
 
-    const unsigned char *payload;
-    ylength length;
-    y(get_buf, &payload, &length);
-
-    ipc_send_client_message(client, length, I3_IPC_REPLY_TYPE_OUTPUTS, payload);
+    ipc_send_client_reply(client, I3_IPC_REPLY_TYPE_OUTPUTS, gen);
     y(free);
 }
 
@@ -1052,7 +1998,7 @@ IPC_HANDLER(get_outputs) {
  *
  */
 IPC_HANDLER(get_marks) {
-    yajl_gen gen = ygenalloc();
+    ipc_gen *gen = ygenalloc();
     y(array_open);
 
     Con *con;
@@ -1078,7 +2024,7 @@ IPC_HANDLER(get_marks) {
  *
  */
 IPC_HANDLER(get_version) {
-    yajl_gen gen = ygenalloc();
+    ipc_gen *gen = ygenalloc();
     y(map_open);
 
     ystr("major");
@@ -1123,7 +2069,7 @@ IPC_HANDLER(get_version) {
  *
  */
 IPC_HANDLER(get_bar_config) {
-    yajl_gen gen = ygenalloc();
+    ipc_gen *gen = ygenalloc();
 
     /* If no ID was passed, we return a JSON array with all IDs */
     if (message_size == 0) {
@@ -1185,7 +2131,7 @@ IPC_HANDLER(get_bar_config) {
  *
  */
 IPC_HANDLER(get_binding_modes) {
-    yajl_gen gen = ygenalloc();
+    ipc_gen *gen = ygenalloc();
 
     y(array_open);
     struct Mode *mode;
@@ -1203,29 +2149,202 @@ IPC_HANDLER(get_binding_modes) {
 }
 
 /*
- * Callback for the YAJL parser (will be called when a string is parsed).
+ * Returns the event type with the given name, or -1 if there is none.
+ *
+ */
+static int event_from_name(const unsigned char *s, ylength len) {
+    for (int i = 0; i < IPC_EVENT_COUNT; i++) {
+        if (strlen(event_names[i]) == len && strncasecmp(event_names[i], (const char *)s, len) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Subscribes the client to the given event. If filter is NULL, the client
+ * receives all events of this type, otherwise it is added to the filters of
+ * which one needs to match (unless the client already receives all events of
+ * this type). Takes ownership of the filter.
  *
  */
-static int add_subscription(void *extra, const unsigned char *s,
-                            ylength len) {
-    ipc_client *client = extra;
+static void add_subscription(ipc_client *client, int event, ipc_event_filter *filter) {
+    const uint32_t bit = (1 << event);
+
+    /* Event names are interned at this point, so that sending an event does
+     * not need to compare any strings. */
+    if (!(client->events & bit)) {
+        client->events |= bit;
+        TAILQ_INSERT_TAIL(&subscribers[event], client, subscriptions[event]);
+        if (filter != NULL) {
+            client->filtered_events |= bit;
+        }
+    }
 
-    DLOG("should add subscription to extra %p, sub %.*s\n", client, (int)len, s);
-    int event = client->num_events;
+    if (event == (I3_IPC_EVENT_TREE_DELTA & ~I3_IPC_EVENT_MASK)) {
+        tree_delta_start();
+    }
 
-    client->num_events++;
-    client->events = srealloc(client->events, client->num_events * sizeof(char *));
-    /* We copy the string because it is not null-terminated and strndup()
-     * is missing on some BSD systems */
-    client->events[event] = scalloc(len + 1, 1);
-    memcpy(client->events[event], s, len);
+    if (filter == NULL) {
+        client->filtered_events &= ~bit;
+        free_event_filters(client, event);
+    } else if (client->filtered_events & bit) {
+        TAILQ_INSERT_TAIL(&(client->filters[event]), filter, filters);
+    } else {
+        free_event_filter(filter);
+    }
 
     DLOG("client is now subscribed to:\n");
-    for (int i = 0; i < client->num_events; i++) {
-        DLOG("event %s\n", client->events[i]);
+    for (int i = 0; i < IPC_EVENT_COUNT; i++) {
+        if (client->events & (1 << i)) {
+            DLOG("event %s%s\n", event_names[i], (client->filtered_events & (1 << i) ? " (filtered)" : ""));
+        }
     }
     DLOG("(done)\n");
+}
+
+/* State of parsing a SUBSCRIBE payload. Each element of the array is either
+ * the name of an event or a filter object like
+ * {"event": "window", "change": ["focus"], "criteria": {"class": "^URxvt$"}}. */
+struct subscribe_json_state {
+    ipc_client *client;
+
+    /* The filter object which is being parsed, if any. */
+    ipc_event_filter *filter;
+    int filter_event;
+    char *last_key;
+    bool in_changes;
+    bool in_criteria;
+};
+
+static int subscribe_string_cb(void *extra, const unsigned char *s, ylength len) {
+    struct subscribe_json_state *state = extra;
+
+    if (state->filter == NULL) {
+        DLOG("should add subscription to client %p, sub %.*s\n", state->client, (int)len, s);
+        const int event = event_from_name(s, len);
+        if (event == -1) {
+            DLOG("Ignoring subscription to unknown event %.*s\n", (int)len, s);
+            return 1;
+        }
+        add_subscription(state->client, event, NULL);
+        return 1;
+    }
+
+    if (state->last_key == NULL) {
+        return 0;
+    }
+
+    char *value = sstrndup((const char *)s, len);
+    if (state->in_criteria) {
+        match_parse_property(state->filter->match, state->last_key, value);
+        free(value);
+    } else if (strcmp(state->last_key, "event") == 0) {
+        state->filter_event = event_from_name(s, len);
+        free(value);
+        if (state->filter_event == -1) {
+            ELOG("Cannot filter unknown event %.*s\n", (int)len, s);
+            return 0;
+        }
+    } else if (strcmp(state->last_key, "change") == 0) {
+        ipc_event_filter *filter = state->filter;
+        filter->changes = srealloc(filter->changes, (filter->num_changes + 1) * sizeof(char *));
+        filter->changes[filter->num_changes++] = value;
+    } else {
+        ELOG("Unknown subscription filter key %s\n", state->last_key);
+        free(value);
+        return 0;
+    }
+
+    return 1;
+}
+
+static int subscribe_map_key_cb(void *extra, const unsigned char *s, ylength len) {
+    struct subscribe_json_state *state = extra;
+    FREE(state->last_key);
+    state->last_key = sstrndup((const char *)s, len);
+    return 1;
+}
+
+static int subscribe_start_map_cb(void *extra) {
+    struct subscribe_json_state *state = extra;
+
+    if (state->filter == NULL) {
+        state->filter = scalloc(1, sizeof(ipc_event_filter));
+        state->filter_event = -1;
+        return 1;
+    }
+
+    if (!state->in_criteria && state->last_key != NULL && strcmp(state->last_key, "criteria") == 0 &&
+        state->filter->match == NULL) {
+        state->filter->match = smalloc(sizeof(Match));
+        match_init(state->filter->match);
+        state->in_criteria = true;
+        FREE(state->last_key);
+        return 1;
+    }
+
+    return 0;
+}
+
+static int subscribe_end_map_cb(void *extra) {
+    struct subscribe_json_state *state = extra;
+
+    if (state->in_criteria) {
+        state->in_criteria = false;
+        return 1;
+    }
+
+    ipc_event_filter *filter = state->filter;
+    state->filter = NULL;
+    FREE(state->last_key);
+
+    if (state->filter_event == -1) {
+        ELOG("Subscription filter without an event\n");
+        free_event_filter(filter);
+        return 0;
+    }
+
+    if (filter->match != NULL) {
+        if (filter->match->error != NULL) {
+            ELOG("Invalid criteria in subscription filter: %s\n", filter->match->error);
+            free_event_filter(filter);
+            return 0;
+        }
+        if (state->filter_event != (I3_IPC_EVENT_WINDOW & ~I3_IPC_EVENT_MASK)) {
+            ELOG("Criteria can only be used to filter window events\n");
+            free_event_filter(filter);
+            return 0;
+        }
+    }
+
+    if (filter->num_changes == 0 && filter->match == NULL) {
+        /* Nothing to filter. */
+        free_event_filter(filter);
+        filter = NULL;
+    }
+
+    add_subscription(state->client, state->filter_event, filter);
+    return 1;
+}
+
+static int subscribe_start_array_cb(void *extra) {
+    struct subscribe_json_state *state = extra;
+
+    if (state->filter == NULL) {
+        return 1;
+    }
+    if (!state->in_criteria && !state->in_changes &&
+        state->last_key != NULL && strcmp(state->last_key, "change") == 0) {
+        state->in_changes = true;
+        return 1;
+    }
+    return 0;
+}
 
+static int subscribe_end_array_cb(void *extra) {
+    struct subscribe_json_state *state = extra;
+    state->in_changes = false;
     return 1;
 }
 
@@ -1240,11 +2359,22 @@ IPC_HANDLER(subscribe) {
 
     /* Setup the JSON parser */
     static yajl_callbacks callbacks = {
-        .yajl_string = add_subscription,
+        .yajl_string = subscribe_string_cb,
+        .yajl_map_key = subscribe_map_key_cb,
+        .yajl_start_map = subscribe_start_map_cb,
+        .yajl_end_map = subscribe_end_map_cb,
+        .yajl_start_array = subscribe_start_array_cb,
+        .yajl_end_array = subscribe_end_array_cb,
     };
 
-    p = yalloc(&callbacks, (void *)client);
+    struct subscribe_json_state state = {.client = client};
+    p = yalloc(&callbacks, (void *)&state);
     stat = yajl_parse(p, (const unsigned char *)message, message_size);
+    /* Only set if parsing stopped within a filter object. */
+    if (state.filter != NULL) {
+        free_event_filter(state.filter);
+    }
+    FREE(state.last_key);
     if (stat != yajl_status_ok) {
         unsigned char *err;
         err = yajl_get_error(p, true, (const unsigned char *)message,
@@ -1258,6 +2388,7 @@ IPC_HANDLER(subscribe) {
         return;
     }
     yajl_free(p);
+    client->cbor_events = (message_type & I3_IPC_MESSAGE_FLAG_CBOR);
     const char *reply = "{\"success\":true}";
     ipc_send_client_message(client, strlen(reply), I3_IPC_REPLY_TYPE_SUBSCRIBE, (const uint8_t *)reply);
 
@@ -1265,27 +2396,26 @@ IPC_HANDLER(subscribe) {
         return;
     }
 
-    bool is_tick = false;
-    for (int i = 0; i < client->num_events; i++) {
-        if (strcmp(client->events[i], "tick") == 0) {
-            is_tick = true;
-            break;
-        }
-    }
+    const bool is_tick = (client->events & (1 << (I3_IPC_EVENT_TICK & ~I3_IPC_EVENT_MASK)));
     if (!is_tick) {
         return;
     }
 
     client->first_tick_sent = true;
-    const char *payload = "{\"first\":true,\"payload\":\"\"}";
-    ipc_send_client_message(client, strlen(payload), I3_IPC_EVENT_TICK, (const uint8_t *)payload);
+    struct tick_event tick = {
+        .first = true,
+        .payload = (const unsigned char *)"",
+        .length = 0};
+    ipc_chunk *chunk = ipc_chunk_new_event(I3_IPC_EVENT_TICK, marshal_tick_event, &tick, client->cbor_events);
+    ipc_queue_chunk(client, chunk);
+    ipc_chunk_unref(chunk);
 }
 
 /*
  * Returns the raw last loaded i3 configuration file contents.
  */
 IPC_HANDLER(get_config) {
-    yajl_gen gen = ygenalloc();
+    ipc_gen *gen = ygenalloc();
 
     y(map_open);
 
@@ -1322,24 +2452,11 @@ IPC_HANDLER(get_config) {
  * synchronization point in event-related tests.
  */
 IPC_HANDLER(send_tick) {
-    yajl_gen gen = ygenalloc();
-
-    y(map_open);
-
-    ystr("first");
-    y(bool, false);
-
-    ystr("payload");
-    yajl_gen_string(gen, (unsigned char *)message, message_size);
-
-    y(map_close);
-
-    const unsigned char *payload;
-    ylength length;
-    y(get_buf, &payload, &length);
-
-    ipc_send_event("tick", I3_IPC_EVENT_TICK, (const char *)payload);
-    y(free);
+    struct tick_event tick = {
+        .first = false,
+        .payload = message,
+        .length = message_size};
+    ipc_send_event("tick", I3_IPC_EVENT_TICK, marshal_tick_event, &tick);
 
     const char *reply = "{\"success\":true}";
     ipc_send_client_message(client, strlen(reply), I3_IPC_REPLY_TYPE_TICK, (const uint8_t *)reply);
@@ -1400,13 +2517,14 @@ IPC_HANDLER(sync) {
     yajl_free(p);
 
     DLOG("received IPC sync request (rnd = %d, window = 0x%08x)\n", state.rnd, state.window);
+    handle_coalesced_property_changes(true);
     sync_respond(state.window, state.rnd);
     const char *reply = "{\"success\":true}";
     ipc_send_client_message(client, strlen(reply), I3_IPC_REPLY_TYPE_SYNC, (const uint8_t *)reply);
 }
 
 IPC_HANDLER(get_binding_state) {
-    yajl_gen gen = ygenalloc();
+    ipc_gen *gen = ygenalloc();
 
     y(map_open);
 
@@ -1423,9 +2541,47 @@ IPC_HANDLER(get_binding_state) {
     y(free);
 }
 
+/*
+ * Returns the spans recorded while tracing was enabled (see the trace command
+ * and the --trace flag) in Chrome trace format.
+ *
+ */
+IPC_HANDLER(get_trace) {
+    setlocale(LC_NUMERIC, "C");
+    ipc_gen *gen = ygenalloc();
+    trace_dump_json(gen);
+    setlocale(LC_NUMERIC, "");
+
+    const unsigned char *payload;
+    ylength length;
+    y(get_buf, &payload, &length);
+
+    ipc_send_client_message(client, length, I3_IPC_REPLY_TYPE_GET_TRACE, payload);
+    y(free);
+}
+
+/*
+ * Returns the histograms of the latency from handling a binding or an IPC
+ * command until the changes were flushed to X11.
+ *
+ */
+IPC_HANDLER(get_latency) {
+    setlocale(LC_NUMERIC, "C");
+    ipc_gen *gen = ygenalloc();
+    latency_dump_json(gen);
+    setlocale(LC_NUMERIC, "");
+
+    const unsigned char *payload;
+    ylength length;
+    y(get_buf, &payload, &length);
+
+    ipc_send_client_message(client, length, I3_IPC_REPLY_TYPE_GET_LATENCY, payload);
+    y(free);
+}
+
 /* The index of each callback function corresponds to the numeric
  * value of the message type (see include/i3/ipc.h) */
-handler_t handlers[13] = {
+handler_t handlers[16] = {
     handle_run_command,
     handle_get_workspaces,
     handle_subscribe,
@@ -1439,6 +2595,9 @@ handler_t handlers[13] = {
     handle_send_tick,
     handle_sync,
     handle_get_binding_state,
+    handle_get_trace,
+    handle_get_latency,
+    handle_run_transaction,
 };
 
 /*
@@ -1474,10 +2633,13 @@ static void ipc_receive_message(EV_P_ struct ev_io *w, int revents) {
         return;
     }
 
-    if (message_type >= (sizeof(handlers) / sizeof(handler_t))) {
+    /* Handlers which support other encodings check the flags themselves. */
+    const uint32_t type = (message_type & ~I3_IPC_MESSAGE_FLAG_CBOR);
+    if (type >= (sizeof(handlers) / sizeof(handler_t))) {
         DLOG("Unhandled message type: %d\n", message_type);
     } else {
-        handler_t h = handlers[message_type];
+        TRACE_SPAN(span, "ipc_message", NULL, type);
+        handler_t h = handlers[type];
         h(client, message, 0, message_length, message_type);
     }
 
@@ -1577,6 +2739,10 @@ ipc_client *ipc_new_client_on_fd(EV_P_ int fd) {
 
     ipc_client *client = scalloc(1, sizeof(ipc_client));
     client->fd = fd;
+    TAILQ_INIT(&(client->output_queue));
+    for (int i = 0; i < IPC_EVENT_COUNT; i++) {
+        TAILQ_INIT(&(client->filters[i]));
+    }
 
     client->read_callback = scalloc(1, sizeof(struct ev_io));
     client->read_callback->data = client;
@@ -1592,38 +2758,48 @@ ipc_client *ipc_new_client_on_fd(EV_P_ int fd) {
     return client;
 }
 
-/*
- * Generates a json workspace event. Returns a dynamically allocated yajl
- * generator. Free with yajl_gen_free().
- */
-yajl_gen ipc_marshal_workspace_event(const char *change, Con *current, Con *old) {
-    setlocale(LC_NUMERIC, "C");
-    yajl_gen gen = ygenalloc();
+struct workspace_event {
+    const char *change;
+    Con *current;
+    Con *old;
+};
+
+static void marshal_workspace_event(ipc_gen *gen, void *data) {
+    struct workspace_event *event = data;
 
     y(map_open);
 
     ystr("change");
-    ystr(change);
+    ystr(event->change);
 
     ystr("current");
-    if (current == NULL) {
+    if (event->current == NULL) {
         y(null);
     } else {
-        dump_node(gen, current, false);
+        dump_node(gen, event->current, false);
     }
 
     ystr("old");
-    if (old == NULL) {
+    if (event->old == NULL) {
         y(null);
     } else {
-        dump_node(gen, old, false);
+        dump_node(gen, event->old, false);
     }
 
     y(map_close);
+}
 
-    setlocale(LC_NUMERIC, "");
-
-    return gen;
+/*
+ * Generates a workspace event (see ipc_send_workspace_event()) to be sent
+ * with ipc_send_prepared_event() later, e.g. after current was closed.
+ *
+ */
+ipc_prepared_event *ipc_prepare_workspace_event(const char *change, Con *current, Con *old) {
+    struct workspace_event event = {
+        .change = change,
+        .current = current,
+        .old = old};
+    return ipc_prepare_event("workspace", I3_IPC_EVENT_WORKSPACE, change, marshal_workspace_event, &event);
 }
 
 /*
@@ -1632,15 +2808,30 @@ yajl_gen ipc_marshal_workspace_event(const char *change, Con *current, Con *old)
  * previously focused workspace in "old".
  */
 void ipc_send_workspace_event(const char *change, Con *current, Con *old) {
-    yajl_gen gen = ipc_marshal_workspace_event(change, current, old);
+    struct workspace_event event = {
+        .change = change,
+        .current = current,
+        .old = old};
+    ipc_send_filtered_event("workspace", I3_IPC_EVENT_WORKSPACE, change, NULL, marshal_workspace_event, &event);
+}
 
-    const unsigned char *payload;
-    ylength length;
-    y(get_buf, &payload, &length);
+struct window_event {
+    const char *property;
+    Con *con;
+};
 
-    ipc_send_event("workspace", I3_IPC_EVENT_WORKSPACE, (const char *)payload);
+static void marshal_window_event(ipc_gen *gen, void *data) {
+    struct window_event *event = data;
 
-    y(free);
+    y(map_open);
+
+    ystr("change");
+    ystr(event->property);
+
+    ystr("container");
+    dump_node(gen, event->con, false);
+
+    y(map_close);
 }
 
 /*
@@ -1651,26 +2842,14 @@ void ipc_send_window_event(const char *property, Con *con) {
     DLOG("Issue IPC window %s event (con = %p, window = 0x%08x)\n",
          property, con, (con->window ? con->window->id : XCB_WINDOW_NONE));
 
-    setlocale(LC_NUMERIC, "C");
-    yajl_gen gen = ygenalloc();
-
-    y(map_open);
-
-    ystr("change");
-    ystr(property);
-
-    ystr("container");
-    dump_node(gen, con, false);
-
-    y(map_close);
-
-    const unsigned char *payload;
-    ylength length;
-    y(get_buf, &payload, &length);
+    struct window_event event = {
+        .property = property,
+        .con = con};
+    ipc_send_filtered_event("window", I3_IPC_EVENT_WINDOW, property, con, marshal_window_event, &event);
+}
 
-    ipc_send_event("window", I3_IPC_EVENT_WINDOW, (const char *)payload);
-    y(free);
-    setlocale(LC_NUMERIC, "");
+static void marshal_barconfig_update_event(ipc_gen *gen, void *data) {
+    dump_bar_config(gen, data);
 }
 
 /*
@@ -1678,18 +2857,34 @@ void ipc_send_window_event(const char *property, Con *con) {
  */
 void ipc_send_barconfig_update_event(Barconfig *barconfig) {
     DLOG("Issue barconfig_update event for id = %s\n", barconfig->id);
-    setlocale(LC_NUMERIC, "C");
-    yajl_gen gen = ygenalloc();
+    ipc_send_event("barconfig_update", I3_IPC_EVENT_BARCONFIG_UPDATE, marshal_barconfig_update_event, barconfig);
+}
 
-    dump_bar_config(gen, barconfig);
+struct binding_event {
+    const char *event_type;
+    Binding *bind;
+    const char *modename;
+};
 
-    const unsigned char *payload;
-    ylength length;
-    y(get_buf, &payload, &length);
+static void marshal_binding_event(ipc_gen *gen, void *data) {
+    struct binding_event *event = data;
 
-    ipc_send_event("barconfig_update", I3_IPC_EVENT_BARCONFIG_UPDATE, (const char *)payload);
-    y(free);
-    setlocale(LC_NUMERIC, "");
+    y(map_open);
+
+    ystr("change");
+    ystr(event->event_type);
+
+    ystr("mode");
+    if (event->modename == NULL) {
+        ystr("default");
+    } else {
+        ystr(event->modename);
+    }
+
+    ystr("binding");
+    dump_binding(gen, event->bind);
+
+    y(map_close);
 }
 
 /*
@@ -1698,35 +2893,40 @@ void ipc_send_barconfig_update_event(Barconfig *barconfig) {
 void ipc_send_binding_event(const char *event_type, Binding *bind, const char *modename) {
     DLOG("Issue IPC binding %s event (sym = %s, code = %d)\n", event_type, bind->symbol, bind->keycode);
 
-    setlocale(LC_NUMERIC, "C");
+    struct binding_event event = {
+        .event_type = event_type,
+        .bind = bind,
+        .modename = modename};
+    ipc_send_filtered_event("binding", I3_IPC_EVENT_BINDING, event_type, NULL, marshal_binding_event, &event);
+}
 
-    yajl_gen gen = ygenalloc();
+static void marshal_mode_event(ipc_gen *gen, void *data) {
+    struct Mode *mode = data;
 
     y(map_open);
 
     ystr("change");
-    ystr(event_type);
-
-    ystr("mode");
-    if (modename == NULL) {
-        ystr("default");
-    } else {
-        ystr(modename);
-    }
+    ystr(mode->name);
 
-    ystr("binding");
-    dump_binding(gen, bind);
+    ystr("pango_markup");
+    y(bool, mode->pango_markup);
 
     y(map_close);
+}
 
-    const unsigned char *payload;
-    ylength length;
-    y(get_buf, &payload, &length);
-
-    ipc_send_event("binding", I3_IPC_EVENT_BINDING, (const char *)payload);
+/*
+ * For the mode events, we send the name of the new binding mode in "change".
+ */
+void ipc_send_mode_event(struct Mode *mode) {
+    ipc_send_filtered_event("mode", I3_IPC_EVENT_MODE, mode->name, NULL, marshal_mode_event, mode);
+}
 
-    y(free);
-    setlocale(LC_NUMERIC, "");
+/*
+ * Sends the output event, which only says that the outputs changed in some
+ * way.
+ */
+void ipc_send_output_event(void) {
+    ipc_send_filtered_event("output", I3_IPC_EVENT_OUTPUT, "unspecified", NULL, marshal_change_event, (void *)"unspecified");
 }
 
 /*
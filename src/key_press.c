@@ -16,6 +16,7 @@
  *
  */
 void handle_key_press(xcb_key_press_event_t *event) {
+    const uint64_t start = trace_now();
     const bool key_release = (event->response_type == XCB_KEY_RELEASE);
 
     last_timestamp = event->time;
@@ -29,6 +30,9 @@ void handle_key_press(xcb_key_press_event_t *event) {
         return;
     }
 
+    const char *latency_class = latency_binding_class(bind);
     CommandResult *result = run_binding(bind, NULL);
     command_result_free(result);
+
+    latency_measure(latency_class, start);
 }
@@ -0,0 +1,246 @@
+/*
+ * vim:ts=4:sw=4:expandtab
+ *
+ * i3 - an improved tiling window manager
+ * © 2009 Michael Stapelberg and contributors (see also: LICENSE)
+ *
+ * latency.c: Measures the latency from receiving input (a binding or an IPC
+ *            command) to flushing the resulting changes to X11.
+ *
+ * Latencies are stored in microseconds in HDR-style histograms: values below
+ * LATENCY_SUB_BUCKETS get one bucket each, larger values are grouped into
+ * buckets of exponentially growing width, so that each bucket covers less
+ * than 1/LATENCY_HALF_BUCKETS (about 6%) of its value. This keeps the
+ * histograms small and recording cheap while still giving precise
+ * percentiles across all magnitudes.
+ *
+ */
+#include "all.h"
+#include "yajl_utils.h"
+
+#define LATENCY_SUB_BUCKET_BITS 5
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BUCKET_BITS)
+#define LATENCY_HALF_BUCKETS (LATENCY_SUB_BUCKETS / 2)
+/* Values are clamped to 32 bit (about 71 minutes), so the highest shift is
+ * 32 - LATENCY_SUB_BUCKET_BITS. */
+#define LATENCY_BUCKETS ((32 - LATENCY_SUB_BUCKET_BITS + 2) * LATENCY_HALF_BUCKETS)
+
+typedef struct latency_histogram {
+    char *name;
+    uint64_t count;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+    uint64_t buckets[LATENCY_BUCKETS];
+
+    TAILQ_ENTRY(latency_histogram) histograms;
+} latency_histogram;
+
+typedef struct pending_measurement {
+    latency_histogram *histogram;
+    uint64_t start;
+
+    TAILQ_ENTRY(pending_measurement) measurements;
+} pending_measurement;
+
+static TAILQ_HEAD(histograms_head, latency_histogram) histograms =
+    TAILQ_HEAD_INITIALIZER(histograms);
+
+static TAILQ_HEAD(measurements_head, pending_measurement) pending =
+    TAILQ_HEAD_INITIALIZER(pending);
+
+static int bucket_index(uint64_t value) {
+    if (value > UINT32_MAX) {
+        value = UINT32_MAX;
+    }
+    if (value < LATENCY_SUB_BUCKETS) {
+        return (int)value;
+    }
+    const int msb = 63 - __builtin_clzll(value);
+    const int shift = msb - (LATENCY_SUB_BUCKET_BITS - 1);
+    return shift * LATENCY_HALF_BUCKETS + (int)(value >> shift);
+}
+
+/* Returns the highest value which is stored in the given bucket. */
+static uint64_t bucket_max(int index) {
+    if (index < LATENCY_SUB_BUCKETS) {
+        return index;
+    }
+    const int shift = index / LATENCY_HALF_BUCKETS - 1;
+    const uint64_t lowest = (uint64_t)(index - shift * LATENCY_HALF_BUCKETS) << shift;
+    return lowest + (1ULL << shift) - 1;
+}
+
+static latency_histogram *histogram_get(const char *name) {
+    latency_histogram *histogram;
+    TAILQ_FOREACH (histogram, &histograms, histograms) {
+        if (strcmp(histogram->name, name) == 0) {
+            return histogram;
+        }
+    }
+
+    histogram = scalloc(1, sizeof(latency_histogram));
+    histogram->name = sstrdup(name);
+    TAILQ_INSERT_TAIL(&histograms, histogram, histograms);
+    return histogram;
+}
+
+static void histogram_add(latency_histogram *histogram, uint64_t value) {
+    if (histogram->count == 0 || value < histogram->min) {
+        histogram->min = value;
+    }
+    if (value > histogram->max) {
+        histogram->max = value;
+    }
+    histogram->count++;
+    histogram->sum += value;
+    histogram->buckets[bucket_index(value)]++;
+}
+
+/* Returns the (upper bound of the) value below which the given percentage of
+ * measurements lie. */
+static uint64_t histogram_percentile(latency_histogram *histogram, double percentile) {
+    uint64_t wanted = (uint64_t)((percentile / 100.0) * histogram->count + 0.5);
+    if (wanted == 0) {
+        wanted = 1;
+    }
+
+    uint64_t seen = 0;
+    for (int i = 0; i < LATENCY_BUCKETS; i++) {
+        seen += histogram->buckets[i];
+        if (seen >= wanted) {
+            const uint64_t value = bucket_max(i);
+            return (value < histogram->max ? value : histogram->max);
+        }
+    }
+    return histogram->max;
+}
+
+/*
+ * Returns the histogram name for the class of the given binding (key or
+ * button, press or release).
+ *
+ * Needs to be called before running the binding, as running it might free
+ * the binding (reload).
+ *
+ */
+const char *latency_binding_class(Binding *bind) {
+    const bool release = (bind->release != B_UPON_KEYPRESS);
+    if (bind->input_type == B_MOUSE) {
+        return (release ? "binding:button_release" : "binding:button_press");
+    }
+    return (release ? "binding:key_release" : "binding:key_press");
+}
+
+/*
+ * Queues a latency measurement which started at start (see trace_now()). It
+ * will be stored in the histogram called name once the changes caused by the
+ * input were flushed to X11 (see latency_record_pending()).
+ *
+ */
+void latency_measure(const char *name, uint64_t start) {
+    pending_measurement *measurement = smalloc(sizeof(pending_measurement));
+    measurement->histogram = histogram_get(name);
+    measurement->start = start;
+    TAILQ_INSERT_TAIL(&pending, measurement, measurements);
+}
+
+/*
+ * Queues a latency measurement for an IPC command (see latency_measure()).
+ * The histogram is named after the command name recorded by the parser
+ * (CommandResult.command_name), so there is at most one per command of the
+ * parser spec.
+ *
+ */
+void latency_measure_command(const char *command_name, uint64_t start) {
+    if (command_name == NULL) {
+        return;
+    }
+
+    char *name;
+    sasprintf(&name, "command:%s", command_name);
+    latency_measure(name, start);
+    free(name);
+}
+
+/*
+ * Stores all queued measurements in their histograms. Called after flushing
+ * the connection to X11 at the end of each event loop iteration.
+ *
+ */
+void latency_record_pending(void) {
+    if (TAILQ_EMPTY(&pending)) {
+        return;
+    }
+
+    const uint64_t now = trace_now();
+    while (!TAILQ_EMPTY(&pending)) {
+        pending_measurement *measurement = TAILQ_FIRST(&pending);
+        histogram_add(measurement->histogram, (now - measurement->start) / 1000);
+        TAILQ_REMOVE(&pending, measurement, measurements);
+        free(measurement);
+    }
+}
+
+static void dump_histogram(ipc_gen *gen, latency_histogram *histogram) {
+    y(map_open);
+
+    ystr("name");
+    ystr(histogram->name);
+
+    ystr("count");
+    y(integer, histogram->count);
+
+    ystr("min");
+    y(integer, histogram->min);
+
+    ystr("max");
+    y(integer, histogram->max);
+
+    ystr("mean");
+    y(double, (double)histogram->sum / histogram->count);
+
+    ystr("p50");
+    y(integer, histogram_percentile(histogram, 50));
+
+    ystr("p90");
+    y(integer, histogram_percentile(histogram, 90));
+
+    ystr("p99");
+    y(integer, histogram_percentile(histogram, 99));
+
+    ystr("p999");
+    y(integer, histogram_percentile(histogram, 99.9));
+
+    /* Only non-empty buckets, as [highest value, count] pairs. */
+    ystr("buckets");
+    y(array_open);
+    for (int i = 0; i < LATENCY_BUCKETS; i++) {
+        if (histogram->buckets[i] == 0) {
+            continue;
+        }
+        y(array_open);
+        y(integer, bucket_max(i));
+        y(integer, histogram->buckets[i]);
+        y(array_close);
+    }
+    y(array_close);
+
+    y(map_close);
+}
+
+/*
+ * Dumps all histograms as a JSON array.
+ *
+ */
+void latency_dump_json(ipc_gen *gen) {
+    y(array_open);
+    latency_histogram *histogram;
+    TAILQ_FOREACH (histogram, &histograms, histograms) {
+        /* Histograms are created when queueing a measurement. */
+        if (histogram->count > 0) {
+            dump_histogram(gen, histogram);
+        }
+    }
+    y(array_close);
+}
@@ -132,29 +132,54 @@ static void xcb_prepare_cb(EV_P_ ev_prepare *w, int revents) {
        sleeps. */
     xcb_generic_event_t *event;
 
-    while ((event = xcb_poll_for_event(conn)) != NULL) {
-        if (event->response_type == 0) {
-            if (event_is_ignored(event->sequence, 0)) {
-                DLOG("Expected X11 Error received for sequence %x\n", event->sequence);
-            } else {
-                xcb_generic_error_t *error = (xcb_generic_error_t *)event;
-                DLOG("X11 Error received (probably harmless)! sequence 0x%x, error_code = %d\n",
-                     error->sequence, error->error_code);
+    /* With render_batching, handlers only request a render, and the tree is
+     * rendered once after all queued events were handled. */
+    const bool batching = config.render_batching;
+    if (batching) {
+        tree_render_set_batching(true);
+    }
+
+    do {
+        while ((event = xcb_poll_for_event(conn)) != NULL) {
+            if (event->response_type == 0) {
+                if (event_is_ignored(event->sequence, 0)) {
+                    DLOG("Expected X11 Error received for sequence %x\n", event->sequence);
+                } else {
+                    xcb_generic_error_t *error = (xcb_generic_error_t *)event;
+                    DLOG("X11 Error received (probably harmless)! sequence 0x%x, error_code = %d\n",
+                         error->sequence, error->error_code);
+                }
+                free(event);
+                continue;
             }
-            free(event);
-            continue;
-        }
 
-        /* Strip off the highest bit (set if the event is generated) */
-        int type = (event->response_type & 0x7F);
+            /* Strip off the highest bit (set if the event is generated) */
+            int type = (event->response_type & 0x7F);
+
+            {
+                TRACE_SPAN(span, "x_event", NULL, type);
+                handle_event(type, event);
+            }
 
-        handle_event(type, event);
+            free(event);
+        }
+        /* Property notifies (e.g. title changes) received during this
+         * iteration are handled only once, with their final value. Handling
+         * them might queue new events, so we need to check again. */
+    } while (handle_coalesced_property_changes(false));
 
-        free(event);
+    if (batching) {
+        tree_render_set_batching(false);
     }
 
+    /* Send all EWMH properties changed during this iteration at once. */
+    ewmh_flush_properties();
+
     /* Flush all queued events to X11. */
     xcb_flush(conn);
+
+    /* The input handled since the last flush is now on its way to X11. */
+    latency_record_pending();
 }
 
 /*
@@ -164,14 +189,22 @@ static void xcb_prepare_cb(EV_P_ ev_prepare *w, int revents) {
  *
  */
 void main_set_x11_cb(bool enable) {
+    /* The render batching depth of the interrupted xcb_prepare_cb. */
+    static int batching_depth = 0;
+
     DLOG("Setting main X11 callback to enabled=%d\n", enable);
     if (enable) {
+        tree_render_resume_batching(batching_depth);
+        batching_depth = 0;
         ev_prepare_start(main_loop, xcb_prepare);
         /* Trigger the watcher explicitly to handle all remaining X11 events.
          * drag_pointer()’s event handler exits in the middle of the loop. */
         ev_feed_event(main_loop, xcb_prepare, 0);
     } else {
         ev_prepare_stop(main_loop, xcb_prepare);
+        /* The modal event handler needs its renders to take effect. Batching
+         * is restored for the rest of the interrupted iteration afterwards. */
+        batching_depth = tree_render_suspend_batching();
     }
 }
 
@@ -185,6 +218,7 @@ static void i3_exit(void) {
         fflush(stderr);
         shm_unlink(shmlogname);
     }
+    state_snapshot_close();
     ipc_shutdown(SHUTDOWN_REASON_EXIT, -1);
     unlink(config.ipc_socket_path);
     if (current_log_stream_socket_path != NULL) {
@@ -218,6 +252,9 @@ static void handle_core_signal(int sig, siginfo_t *info, void *data) {
     if (*shmlogname != '\0') {
         shm_unlink(shmlogname);
     }
+    if (state_snapshot_path != NULL) {
+        shm_unlink(state_snapshot_path);
+    }
     raise(sig);
 }
 
@@ -312,6 +349,7 @@ int main(int argc, char *argv[]) {
         {"fake-outputs", required_argument, 0, 0},
         {"force-old-config-parser-v4.4-only", no_argument, 0, 0},
         {"replace", no_argument, 0, 'r'},
+        {"trace", no_argument, 0, 0},
         {0, 0, 0, 0}};
     int option_index = 0, opt;
 
@@ -395,6 +433,9 @@ int main(int argc, char *argv[]) {
                 } else if (strcmp(long_options[option_index].name, "disable-signalhandler") == 0) {
                     disable_signalhandler = true;
                     break;
+                } else if (strcmp(long_options[option_index].name, "trace") == 0) {
+                    trace_set_enabled(true);
+                    break;
                 } else if (strcmp(long_options[option_index].name, "get-socketpath") == 0 ||
                            strcmp(long_options[option_index].name, "get_socketpath") == 0) {
                     char *socket_path = root_atom_contents("I3_SOCKET_PATH", NULL, 0);
@@ -1010,6 +1051,7 @@ int main(int argc, char *argv[]) {
     con_activate(con_descend_focused(output_get_content(output->con)));
     free(pointerreply);
 
+    state_snapshot_open();
     tree_render();
 
     /* Listen to the IPC socket for clients */
@@ -41,6 +41,7 @@ int render_deco_height(void) {
  *
  */
 void render_con(Con *con) {
+    TRACE_SPAN(span, "render_con", con->name, con->type);
     render_params params = {
         .rect = con->rect,
         .x = con->rect.x,
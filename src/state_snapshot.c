@@ -0,0 +1,289 @@
+/*
+ * vim:ts=4:sw=4:expandtab
+ *
+ * i3 - an improved tiling window manager
+ * © 2009 Michael Stapelberg and contributors (see also: LICENSE)
+ *
+ * state_snapshot.c: Publishes a snapshot of the container tree in shared
+ *                   memory after rendering (see shmstate.h for the format).
+ *
+ */
+#include "all.h"
+#include "shmstate.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* The name of the SHM segment (/i3-state-%pid), or NULL if there is none. */
+char *state_snapshot_path = NULL;
+
+static int snapshot_shm = -1;
+static uint8_t *snapshot = NULL;
+static size_t snapshot_size = 0;
+
+/* The snapshot is assembled in these buffers first and only copied to the SHM
+ * segment if it differs from the one published last. */
+static i3_shmstate_con *cons = NULL;
+static uint32_t num_cons = 0;
+static uint32_t cons_capacity = 0;
+static char *strings = NULL;
+static size_t strings_size = 0;
+static size_t strings_capacity = 0;
+
+/* Initial size of the SHM segment, enough for a few hundred containers. */
+#define SNAPSHOT_INITIAL_SIZE (64 * 1024)
+
+/*
+ * Makes sure that the SHM segment (and the file backing it) has at least the
+ * given size.
+ *
+ */
+static bool reserve_snapshot(size_t size) {
+    if (size <= snapshot_size) {
+        return true;
+    }
+
+    size_t new_size = (snapshot_size == 0 ? SNAPSHOT_INITIAL_SIZE : snapshot_size);
+    while (new_size < size) {
+        new_size *= 2;
+    }
+    if (new_size > UINT32_MAX) {
+        ELOG("State snapshot too large (%zu bytes)\n", size);
+        return false;
+    }
+
+#if defined(__OpenBSD__) || defined(__APPLE__)
+    if (ftruncate(snapshot_shm, new_size) == -1) {
+        ELOG("Could not ftruncate SHM segment for the state snapshot: %s\n", strerror(errno));
+#else
+    int ret;
+    if ((ret = posix_fallocate(snapshot_shm, 0, new_size)) != 0) {
+        ELOG("Could not ftruncate SHM segment for the state snapshot: %s\n", strerror(ret));
+#endif
+        return false;
+    }
+
+    if (snapshot != NULL) {
+        munmap(snapshot, snapshot_size);
+    }
+    snapshot = mmap(NULL, new_size, PROT_READ | PROT_WRITE, MAP_SHARED, snapshot_shm, 0);
+    if (snapshot == MAP_FAILED) {
+        ELOG("Could not mmap SHM segment for the state snapshot: %s\n", strerror(errno));
+        snapshot = NULL;
+        snapshot_size = 0;
+        state_snapshot_close();
+        return false;
+    }
+    snapshot_size = new_size;
+    return true;
+}
+
+/*
+ * Marks the start of a change of the snapshot for readers (see the sequence
+ * lock description in shmstate.h).
+ *
+ */
+static uint32_t begin_write(i3_shmstate_header *header) {
+    /* A sequence left odd by a previous i3 process is made even again. */
+    const uint32_t sequence = (__atomic_load_n(&(header->sequence), __ATOMIC_RELAXED) + 1) & ~1U;
+    __atomic_store_n(&(header->sequence), sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    return sequence + 2;
+}
+
+static void end_write(i3_shmstate_header *header, uint32_t sequence) {
+    __atomic_store_n(&(header->sequence), sequence, __ATOMIC_RELEASE);
+}
+
+/*
+ * Creates the SHM segment for the state snapshot. On failure, the snapshot
+ * stays disabled.
+ *
+ */
+void state_snapshot_open(void) {
+#if defined(__FreeBSD__)
+    sasprintf(&state_snapshot_path, "/tmp/i3-state-%d", getpid());
+#else
+    sasprintf(&state_snapshot_path, "/i3-state-%d", getpid());
+#endif
+    /* After an in-place restart, the segment of the previous process (which
+     * had the same pid) is reused, so that readers do not have to reopen it. */
+    snapshot_shm = shm_open(state_snapshot_path, O_RDWR | O_CREAT, S_IREAD | S_IWRITE);
+    if (snapshot_shm == -1) {
+        ELOG("Could not shm_open SHM segment for the state snapshot: %s\n", strerror(errno));
+        FREE(state_snapshot_path);
+        return;
+    }
+
+    struct stat st;
+    const size_t size = (fstat(snapshot_shm, &st) == 0 && st.st_size > SNAPSHOT_INITIAL_SIZE ? (size_t)st.st_size : SNAPSHOT_INITIAL_SIZE);
+    if (!reserve_snapshot(size)) {
+        state_snapshot_close();
+        return;
+    }
+
+    i3_shmstate_header *header = (i3_shmstate_header *)snapshot;
+    const uint32_t sequence = begin_write(header);
+    header->magic = I3_SHMSTATE_MAGIC;
+    header->version = I3_SHMSTATE_VERSION;
+    header->size = snapshot_size;
+    header->num_cons = 0;
+    header->cons_offset = sizeof(i3_shmstate_header);
+    header->strings_offset = sizeof(i3_shmstate_header);
+    header->strings_size = 0;
+    end_write(header, sequence);
+}
+
+/*
+ * Unmaps and removes the SHM segment of the state snapshot.
+ *
+ */
+void state_snapshot_close(void) {
+    if (state_snapshot_path == NULL) {
+        return;
+    }
+    if (snapshot != NULL) {
+        munmap(snapshot, snapshot_size);
+        snapshot = NULL;
+        snapshot_size = 0;
+    }
+    close(snapshot_shm);
+    snapshot_shm = -1;
+    shm_unlink(state_snapshot_path);
+    FREE(state_snapshot_path);
+}
+
+/*
+ * Appends a NUL-terminated string to the string buffer and returns its offset.
+ *
+ */
+static uint32_t append_string(const char *str, size_t length) {
+    if (strings_size + length + 1 > strings_capacity) {
+        strings_capacity = (strings_capacity == 0 ? 4096 : strings_capacity);
+        while (strings_size + length + 1 > strings_capacity) {
+            strings_capacity *= 2;
+        }
+        strings = srealloc(strings, strings_capacity);
+    }
+    const uint32_t offset = strings_size;
+    memcpy(strings + strings_size, str, length);
+    strings[strings_size + length] = '\0';
+    strings_size += length + 1;
+    return offset;
+}
+
+static void collect_cons(Con *con, Con *workspace) {
+    if (con->type == CT_WORKSPACE) {
+        workspace = con;
+    }
+
+    if (num_cons == cons_capacity) {
+        cons_capacity = (cons_capacity == 0 ? 64 : cons_capacity * 2);
+        cons = srealloc(cons, cons_capacity * sizeof(i3_shmstate_con));
+    }
+
+    uint32_t flags = 0;
+    if (con == focused) {
+        flags |= I3_SHMSTATE_FOCUSED;
+    }
+    if (con->parent != NULL && TAILQ_FIRST(&(con->parent->focus_head)) == con) {
+        flags |= I3_SHMSTATE_ACTIVE;
+    }
+    if (con->urgent) {
+        flags |= I3_SHMSTATE_URGENT;
+    }
+    if (con->type == CT_FLOATING_CON || con->floating >= FLOATING_AUTO_ON) {
+        flags |= I3_SHMSTATE_FLOATING;
+    }
+    if (con->fullscreen_mode != CF_NONE) {
+        flags |= I3_SHMSTATE_FULLSCREEN;
+    }
+    if (con->sticky) {
+        flags |= I3_SHMSTATE_STICKY;
+    }
+
+    /* Like the "name" in the IPC interface. */
+    const char *name = NULL;
+    if (con->window && con->window->name) {
+        name = i3string_as_utf8(con->window->name);
+    } else {
+        name = con->name;
+    }
+    /* Offset 0 is the empty string (see state_snapshot_update). */
+    const size_t name_length = (name == NULL ? 0 : strlen(name));
+    const uint32_t name_offset = (name_length == 0 ? 0 : append_string(name, name_length));
+
+    cons[num_cons++] = (i3_shmstate_con){
+        .id = (uintptr_t)con,
+        .parent = (uintptr_t)con->parent,
+        .workspace = (uintptr_t)workspace,
+        .window = (con->window ? con->window->id : 0),
+        .type = con->type,
+        .x = con->rect.x,
+        .y = con->rect.y,
+        .width = con->rect.width,
+        .height = con->rect.height,
+        .flags = flags,
+        .name_offset = name_offset,
+        .name_length = name_length,
+        .num = (con->type == CT_WORKSPACE ? con->num : -1)};
+
+    Con *child;
+    TAILQ_FOREACH (child, &(con->nodes_head), nodes) {
+        collect_cons(child, workspace);
+    }
+    TAILQ_FOREACH (child, &(con->floating_head), floating_windows) {
+        collect_cons(child, workspace);
+    }
+}
+
+/*
+ * Updates the state snapshot if the tree changed. Called after rendering the
+ * tree.
+ *
+ */
+void state_snapshot_update(void) {
+    if (snapshot == NULL) {
+        return;
+    }
+
+    TRACE_SPAN(span, "state_snapshot_update", NULL, -1);
+
+    num_cons = 0;
+    strings_size = 0;
+    append_string("", 0);
+    collect_cons(croot, NULL);
+
+    const size_t cons_offset = sizeof(i3_shmstate_header);
+    const size_t cons_bytes = num_cons * sizeof(i3_shmstate_con);
+    const size_t strings_offset = cons_offset + cons_bytes;
+
+    /* Readers only need to copy the snapshot again when the sequence changed,
+     * so it is not touched if nothing changed. */
+    i3_shmstate_header *header = (i3_shmstate_header *)snapshot;
+    if (header->num_cons == num_cons &&
+        header->strings_size == strings_size &&
+        memcmp(snapshot + cons_offset, cons, cons_bytes) == 0 &&
+        memcmp(snapshot + strings_offset, strings, strings_size) == 0) {
+        return;
+    }
+
+    if (!reserve_snapshot(strings_offset + strings_size)) {
+        return;
+    }
+
+    header = (i3_shmstate_header *)snapshot;
+    const uint32_t sequence = begin_write(header);
+    header->size = snapshot_size;
+    header->num_cons = num_cons;
+    header->cons_offset = cons_offset;
+    header->strings_offset = strings_offset;
+    header->strings_size = strings_size;
+    memcpy(snapshot + cons_offset, cons, cons_bytes);
+    memcpy(snapshot + strings_offset, strings, strings_size);
+    end_write(header, sequence);
+}
@@ -0,0 +1,225 @@
+/*
+ * vim:ts=4:sw=4:expandtab
+ *
+ * i3 - an improved tiling window manager
+ * © 2009 Michael Stapelberg and contributors (see also: LICENSE)
+ *
+ * trace.c: Records spans of the event loop (X11 event dispatch, commands,
+ *          rendering, IPC) into a ring buffer, dumped in Chrome trace format.
+ *
+ */
+#include "all.h"
+#include "trace.h"
+#include "yajl_utils.h"
+
+#include <time.h>
+#include <unistd.h>
+
+/* Number of spans kept in the ring buffer. Older spans are overwritten. */
+#define TRACE_BUFFER_SIZE 32768
+
+/* Length of the detail copied into each record (including the NUL byte). */
+#define TRACE_DETAIL_LEN 64
+
+typedef struct trace_record_t {
+    const char *name;
+    int64_t arg;
+    uint64_t start;
+    uint64_t duration;
+    char detail[TRACE_DETAIL_LEN];
+} trace_record_t;
+
+bool trace_enabled = false;
+
+static trace_record_t *records = NULL;
+/* Index where the next record will be written to. */
+static size_t next_record = 0;
+/* Whether the ring buffer wrapped, i.e. all records are valid. */
+static bool wrapped = false;
+
+/*
+ * Returns the current CLOCK_MONOTONIC time in nanoseconds.
+ *
+ */
+uint64_t trace_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * Stores the given span (ending now) in the ring buffer.
+ *
+ */
+void trace_record(trace_span *span) {
+    if (records == NULL) {
+        return;
+    }
+
+    trace_record_t *record = &records[next_record];
+    record->name = span->name;
+    record->arg = span->arg;
+    record->start = span->start;
+    record->duration = trace_now() - span->start;
+    if (span->detail != NULL) {
+        size_t length = strnlen(span->detail, TRACE_DETAIL_LEN);
+        if (length == TRACE_DETAIL_LEN) {
+            /* Truncated, so the detail must not end in the middle of a UTF-8
+             * sequence: back up over its continuation bytes and its lead
+             * byte. */
+            length = TRACE_DETAIL_LEN - 1;
+            while (length > 0 && (span->detail[length] & 0xC0) == 0x80) {
+                length--;
+            }
+        }
+        memcpy(record->detail, span->detail, length);
+        record->detail[length] = '\0';
+    } else {
+        record->detail[0] = '\0';
+    }
+
+    if (++next_record == TRACE_BUFFER_SIZE) {
+        next_record = 0;
+        wrapped = true;
+    }
+}
+
+/*
+ * Enables or disables tracing. The ring buffer is allocated when tracing is
+ * enabled for the first time and kept (with its contents) afterwards.
+ *
+ */
+void trace_set_enabled(bool enabled) {
+    if (enabled && records == NULL) {
+        records = scalloc(TRACE_BUFFER_SIZE, sizeof(trace_record_t));
+    }
+    LOG("%s tracing\n", enabled ? "Enabling" : "Disabling");
+    trace_enabled = enabled;
+}
+
+/*
+ * Returns a human readable name for the given X11 event type.
+ *
+ */
+const char *trace_x_event_name(int type) {
+    static const char *names[] = {
+        [XCB_KEY_PRESS] = "KeyPress",
+        [XCB_KEY_RELEASE] = "KeyRelease",
+        [XCB_BUTTON_PRESS] = "ButtonPress",
+        [XCB_BUTTON_RELEASE] = "ButtonRelease",
+        [XCB_MOTION_NOTIFY] = "MotionNotify",
+        [XCB_ENTER_NOTIFY] = "EnterNotify",
+        [XCB_LEAVE_NOTIFY] = "LeaveNotify",
+        [XCB_FOCUS_IN] = "FocusIn",
+        [XCB_FOCUS_OUT] = "FocusOut",
+        [XCB_KEYMAP_NOTIFY] = "KeymapNotify",
+        [XCB_EXPOSE] = "Expose",
+        [XCB_GRAPHICS_EXPOSURE] = "GraphicsExposure",
+        [XCB_NO_EXPOSURE] = "NoExposure",
+        [XCB_VISIBILITY_NOTIFY] = "VisibilityNotify",
+        [XCB_CREATE_NOTIFY] = "CreateNotify",
+        [XCB_DESTROY_NOTIFY] = "DestroyNotify",
+        [XCB_UNMAP_NOTIFY] = "UnmapNotify",
+        [XCB_MAP_NOTIFY] = "MapNotify",
+        [XCB_MAP_REQUEST] = "MapRequest",
+        [XCB_REPARENT_NOTIFY] = "ReparentNotify",
+        [XCB_CONFIGURE_NOTIFY] = "ConfigureNotify",
+        [XCB_CONFIGURE_REQUEST] = "ConfigureRequest",
+        [XCB_GRAVITY_NOTIFY] = "GravityNotify",
+        [XCB_RESIZE_REQUEST] = "ResizeRequest",
+        [XCB_CIRCULATE_NOTIFY] = "CirculateNotify",
+        [XCB_CIRCULATE_REQUEST] = "CirculateRequest",
+        [XCB_PROPERTY_NOTIFY] = "PropertyNotify",
+        [XCB_SELECTION_CLEAR] = "SelectionClear",
+        [XCB_SELECTION_REQUEST] = "SelectionRequest",
+        [XCB_SELECTION_NOTIFY] = "SelectionNotify",
+        [XCB_COLORMAP_NOTIFY] = "ColormapNotify",
+        [XCB_CLIENT_MESSAGE] = "ClientMessage",
+        [XCB_MAPPING_NOTIFY] = "MappingNotify",
+    };
+
+    if (type < 0 || (size_t)type >= sizeof(names) / sizeof(names[0]) || names[type] == NULL) {
+        return "extension event";
+    }
+    return names[type];
+}
+
+static void dump_record(ipc_gen *gen, trace_record_t *record, int pid) {
+    y(map_open);
+
+    ystr("name");
+    if (strcmp(record->name, "x_event") == 0) {
+        /* Show X11 events by type, e.g. "x_event: MapRequest". The name is
+         * only looked up here to keep recording cheap. */
+        char *name;
+        sasprintf(&name, "%s: %s", record->name, trace_x_event_name(record->arg));
+        ystr(name);
+        free(name);
+    } else {
+        ystr(record->name);
+    }
+
+    ystr("cat");
+    ystr("i3");
+
+    /* Complete events, see the Trace Event Format document. */
+    ystr("ph");
+    ystr("X");
+
+    /* Timestamps are in microseconds. */
+    ystr("ts");
+    y(double, record->start / 1000.0);
+    ystr("dur");
+    y(double, record->duration / 1000.0);
+
+    ystr("pid");
+    y(integer, pid);
+    ystr("tid");
+    y(integer, pid);
+
+    if (record->detail[0] != '\0' || record->arg != -1) {
+        ystr("args");
+        y(map_open);
+        if (record->detail[0] != '\0') {
+            ystr("detail");
+            ystr(record->detail);
+        }
+        if (record->arg != -1) {
+            ystr("arg");
+            y(integer, record->arg);
+        }
+        y(map_close);
+    }
+
+    y(map_close);
+}
+
+/*
+ * Dumps all recorded spans, oldest first, as a Chrome trace format JSON object
+ * (viewable in chrome://tracing or Perfetto).
+ *
+ */
+void trace_dump_json(ipc_gen *gen) {
+    const int pid = getpid();
+
+    y(map_open);
+
+    ystr("displayTimeUnit");
+    ystr("ns");
+
+    ystr("traceEvents");
+    y(array_open);
+    if (records != NULL) {
+        if (wrapped) {
+            for (size_t i = next_record; i < TRACE_BUFFER_SIZE; i++) {
+                dump_record(gen, &records[i], pid);
+            }
+        }
+        for (size_t i = 0; i < next_record; i++) {
+            dump_record(gen, &records[i], pid);
+        }
+    }
+    y(array_close);
+
+    y(map_close);
+}
@@ -14,6 +14,11 @@ struct Con *focused;
 
 struct all_cons_head all_cons = TAILQ_HEAD_INITIALIZER(all_cons);
 
+/* See tree_render_set_batching(). Batching is enabled while the depth is
+ * greater than zero, so that nested enable/disable pairs compose. */
+static int render_batching = 0;
+static bool render_pending = false;
+
 /*
  * Create the pseudo-output __i3. Output-independent workspaces such as
  * __i3_scratch will live there.
@@ -457,6 +462,13 @@ void tree_render(void) {
         return;
     }
 
+    if (render_batching > 0) {
+        render_pending = true;
+        return;
+    }
+
+    TRACE_SPAN(span, "tree_render", NULL, -1);
+
     DLOG("-- BEGIN RENDERING --\n");
     /* Reset map state for all nodes in tree */
     /* TODO: a nicer method to walk all nodes would be good, maybe? */
@@ -467,6 +479,84 @@ void tree_render(void) {
 
     x_push_changes(croot);
     DLOG("-- END RENDERING --\n");
+
+    tree_delta_send();
+    state_snapshot_update();
+}
+
+/*
+ * Enables or disables render batching. While batching is enabled,
+ * tree_render() only records that the tree needs to be rendered. Calls nest:
+ * every enable has to be paired with a disable, and the last disable renders
+ * the tree once if it was requested in the meantime.
+ *
+ */
+void tree_render_set_batching(bool enable) {
+    if (enable) {
+        render_batching++;
+        return;
+    }
+
+    if (render_batching == 0) {
+        ELOG("Render batching disabled more often than enabled\n");
+        return;
+    }
+    if (--render_batching == 0 && render_pending) {
+        render_pending = false;
+        tree_render();
+    }
+}
+
+/*
+ * Turns render batching off entirely (rendering a pending tree) until
+ * tree_render_resume_batching() is called with the returned depth. Used by
+ * modal event loops, whose renders need to take effect right away.
+ *
+ */
+int tree_render_suspend_batching(void) {
+    const int depth = render_batching;
+    render_batching = 0;
+    if (render_pending) {
+        render_pending = false;
+        tree_render();
+    }
+    return depth;
+}
+
+/*
+ * Restores the render batching depth returned by
+ * tree_render_suspend_batching().
+ *
+ */
+void tree_render_resume_batching(int depth) {
+    render_batching = depth;
+}
+
+/*
+ * Renders the tree right away if a render was requested while batching. Used
+ * when a client must observe the rendered state, e.g. before replying to a
+ * sync request.
+ *
+ */
+void tree_render_flush(void) {
+    if (!render_pending) {
+        return;
+    }
+
+    const int depth = render_batching;
+    render_batching = 0;
+    render_pending = false;
+    tree_render();
+    render_batching = depth;
+}
+
+/*
+ * Returns true if a render was requested while batching, i.e. the changes
+ * will be pushed to X11 once batching is disabled.
+ *
+ */
+bool tree_render_is_pending(void) {
+    return render_pending;
 }
 
 static Con *get_tree_next_workspace(Con *con, direction_t direction) {
@@ -0,0 +1,479 @@
+/*
+ * vim:ts=4:sw=4:expandtab
+ *
+ * i3 - an improved tiling window manager
+ * © 2009 Michael Stapelberg and contributors (see also: LICENSE)
+ *
+ * tree_delta.c: Sends the changes of the container tree since the last
+ *               rendering to clients subscribed to the tree_delta event.
+ *
+ * Each container which was part of the last event keeps a copy of the fields
+ * it was sent with (Con.delta_state). After rendering, these are compared
+ * with the current fields, so that only changed fields are sent.
+ *
+ */
+#include "all.h"
+#include "yajl_utils.h"
+
+
+struct tree_delta_state {
+    Con *parent;
+    int type;
+    char *name;
+    layout_t layout;
+    bool focused;
+    bool urgent;
+    fullscreen_mode_t fullscreen_mode;
+    bool floating;
+    Rect rect;
+    xcb_window_t window;
+    int num;
+
+    int num_nodes;
+    Con **nodes;
+    int num_floating_nodes;
+    Con **floating_nodes;
+    int num_focus;
+    Con **focus;
+};
+
+typedef struct removed_con {
+    uintptr_t id;
+
+    TAILQ_ENTRY(removed_con) removed;
+} removed_con;
+
+static TAILQ_HEAD(removed_head, removed_con) removed_cons =
+    TAILQ_HEAD_INITIALIZER(removed_cons);
+
+/* Whether containers are being tracked, i.e. there were subscribers when the
+ * tree was rendered last. */
+static bool tracking = false;
+
+static uint64_t generation = 0;
+
+static const char *type_to_string(int type) {
+    switch (type) {
+        case CT_ROOT:
+            return "root";
+        case CT_OUTPUT:
+            return "output";
+        case CT_CON:
+            return "con";
+        case CT_FLOATING_CON:
+            return "floating_con";
+        case CT_WORKSPACE:
+            return "workspace";
+        case CT_DOCKAREA:
+            return "dockarea";
+    }
+    return "invalid";
+}
+
+static const char *layout_to_string(layout_t layout) {
+    switch (layout) {
+        case L_DEFAULT:
+            return "default";
+        case L_SPLITV:
+            return "splitv";
+        case L_SPLITH:
+            return "splith";
+        case L_STACKED:
+            return "stacked";
+        case L_TABBED:
+            return "tabbed";
+        case L_DOCKAREA:
+            return "dockarea";
+        case L_OUTPUT:
+            return "output";
+    }
+    return "invalid";
+}
+
+/* Copies the containers of the given list into a newly allocated array. */
+#define LIST_TO_ARRAY(head, field, array, num)                            \
+    do {                                                                  \
+        Con *child;                                                       \
+        (num) = 0;                                                        \
+        TAILQ_FOREACH (child, (head), field) {                            \
+            (num)++;                                                      \
+        }                                                                 \
+        (array) = ((num) > 0 ? smalloc((num) * sizeof(Con *)) : NULL);    \
+        int i = 0;                                                        \
+        TAILQ_FOREACH (child, (head), field) {                            \
+            (array)[i++] = child;                                         \
+        }                                                                 \
+    } while (0)
+
+/* Returns the name which is sent for the container (may be NULL). */
+static const char *con_delta_name(Con *con) {
+    if (con->window && con->window->name) {
+        return i3string_as_utf8(con->window->name);
+    }
+    return con->name;
+}
+
+static void state_fill(struct tree_delta_state *state, Con *con) {
+    state->parent = con->parent;
+    state->type = con->type;
+    const char *name = con_delta_name(con);
+    state->name = (name ? sstrdup(name) : NULL);
+    state->layout = con->layout;
+    state->focused = (con == focused);
+    state->urgent = con->urgent;
+    state->fullscreen_mode = con->fullscreen_mode;
+    state->floating = (con->floating >= FLOATING_AUTO_ON);
+    state->rect = con->rect;
+    state->window = (con->window ? con->window->id : XCB_WINDOW_NONE);
+    state->num = con->num;
+    LIST_TO_ARRAY(&(con->nodes_head), nodes, state->nodes, state->num_nodes);
+    LIST_TO_ARRAY(&(con->floating_head), floating_windows, state->floating_nodes, state->num_floating_nodes);
+    LIST_TO_ARRAY(&(con->focus_head), focused, state->focus, state->num_focus);
+}
+
+static void state_free(struct tree_delta_state *state) {
+    free(state->name);
+    free(state->nodes);
+    free(state->floating_nodes);
+    free(state->focus);
+    free(state);
+}
+
+static bool ids_equal(Con **a, int num_a, Con **b, int num_b) {
+    return (num_a == num_b && (num_a == 0 || memcmp(a, b, num_a * sizeof(Con *)) == 0));
+}
+
+static void dump_ids(ipc_gen *gen, Con **cons, int num) {
+    y(array_open);
+    for (int i = 0; i < num; i++) {
+        y(integer, (uintptr_t)cons[i]);
+    }
+    y(array_close);
+}
+
+/*
+ * Dumps all fields of state which differ from old (all fields if old is NULL)
+ * into the currently open map.
+ *
+ */
+static void dump_changed_fields(ipc_gen *gen, struct tree_delta_state *state, struct tree_delta_state *old) {
+#define CHANGED(field) (old == NULL || old->field != state->field)
+    if (CHANGED(parent)) {
+        ystr("parent");
+        y(integer, (uintptr_t)state->parent);
+    }
+
+    if (CHANGED(type)) {
+        ystr("type");
+        ystr(type_to_string(state->type));
+    }
+
+    if (old == NULL || (old->name == NULL) != (state->name == NULL) ||
+        (state->name != NULL && strcmp(old->name, state->name) != 0)) {
+        ystr("name");
+        if (state->name == NULL) {
+            y(null);
+        } else {
+            ystr(state->name);
+        }
+    }
+
+    if (CHANGED(layout)) {
+        ystr("layout");
+        ystr(layout_to_string(state->layout));
+    }
+
+    if (CHANGED(focused)) {
+        ystr("focused");
+        y(bool, state->focused);
+    }
+
+    if (CHANGED(urgent)) {
+        ystr("urgent");
+        y(bool, state->urgent);
+    }
+
+    if (CHANGED(fullscreen_mode)) {
+        ystr("fullscreen_mode");
+        y(integer, state->fullscreen_mode);
+    }
+
+    if (CHANGED(floating)) {
+        ystr("floating");
+        y(bool, state->floating);
+    }
+
+    if (old == NULL || memcmp(&(old->rect), &(state->rect), sizeof(Rect)) != 0) {
+        ystr("rect");
+        y(map_open);
+        ystr("x");
+        y(integer, state->rect.x);
+        ystr("y");
+        y(integer, state->rect.y);
+        ystr("width");
+        y(integer, state->rect.width);
+        ystr("height");
+        y(integer, state->rect.height);
+        y(map_close);
+    }
+
+    if (CHANGED(window)) {
+        ystr("window");
+        if (state->window == XCB_WINDOW_NONE) {
+            y(null);
+        } else {
+            y(integer, state->window);
+        }
+    }
+
+    if (CHANGED(num)) {
+        ystr("num");
+        y(integer, state->num);
+    }
+#undef CHANGED
+
+    if (old == NULL || !ids_equal(old->nodes, old->num_nodes, state->nodes, state->num_nodes)) {
+        ystr("nodes");
+        dump_ids(gen, state->nodes, state->num_nodes);
+    }
+
+    if (old == NULL || !ids_equal(old->floating_nodes, old->num_floating_nodes, state->floating_nodes, state->num_floating_nodes)) {
+        ystr("floating_nodes");
+        dump_ids(gen, state->floating_nodes, state->num_floating_nodes);
+    }
+
+    if (old == NULL || !ids_equal(old->focus, old->num_focus, state->focus, state->num_focus)) {
+        ystr("focus");
+        dump_ids(gen, state->focus, state->num_focus);
+    }
+}
+
+/* Sets differs to whether the containers of the given list differ from the
+ * ids in array, without copying the list. */
+#define LIST_DIFFERS(head, field, array, num, differs)   \
+    do {                                                 \
+        Con *child;                                      \
+        int i = 0;                                       \
+        (differs) = false;                               \
+        TAILQ_FOREACH (child, (head), field) {           \
+            if (i == (num) || (array)[i] != child) {     \
+                (differs) = true;                        \
+                break;                                   \
+            }                                            \
+            i++;                                         \
+        }                                                \
+        (differs) = ((differs) || i != (num));           \
+    } while (0)
+
+/*
+ * Returns whether any field of the container differs from the state it was
+ * last sent with. The container is compared in place, so that unchanged
+ * containers cost no allocations.
+ *
+ */
+static bool con_changed(Con *con, struct tree_delta_state *old) {
+    const char *name = con_delta_name(con);
+    if (old->parent != con->parent ||
+        old->type != (int)con->type ||
+        (old->name == NULL) != (name == NULL) ||
+        (name != NULL && strcmp(old->name, name) != 0) ||
+        old->layout != con->layout ||
+        old->focused != (con == focused) ||
+        old->urgent != con->urgent ||
+        old->fullscreen_mode != con->fullscreen_mode ||
+        old->floating != (con->floating >= FLOATING_AUTO_ON) ||
+        memcmp(&(old->rect), &(con->rect), sizeof(Rect)) != 0 ||
+        old->window != (con->window ? con->window->id : XCB_WINDOW_NONE) ||
+        old->num != con->num) {
+        return true;
+    }
+
+    bool differs;
+    LIST_DIFFERS(&(con->nodes_head), nodes, old->nodes, old->num_nodes, differs);
+    if (differs) {
+        return true;
+    }
+    LIST_DIFFERS(&(con->floating_head), floating_windows, old->floating_nodes, old->num_floating_nodes, differs);
+    if (differs) {
+        return true;
+    }
+    LIST_DIFFERS(&(con->focus_head), focused, old->focus, old->num_focus, differs);
+    return differs;
+}
+
+static void stop_tracking(void) {
+    Con *con;
+    TAILQ_FOREACH (con, &all_cons, all_cons) {
+        if (con->delta_state != NULL) {
+            state_free(con->delta_state);
+            con->delta_state = NULL;
+        }
+    }
+    while (!TAILQ_EMPTY(&removed_cons)) {
+        removed_con *removed = TAILQ_FIRST(&removed_cons);
+        TAILQ_REMOVE(&removed_cons, removed, removed);
+        free(removed);
+    }
+    tracking = false;
+}
+
+/*
+ * Starts tracking the containers (unless they are tracked already), so that
+ * the next tree_delta event contains the changes from now on. Called when a
+ * client subscribes to the tree_delta event.
+ *
+ */
+void tree_delta_start(void) {
+    if (tracking) {
+        return;
+    }
+
+    /* Subscribers get the current state with GET_TREE, so we only take a
+     * snapshot to compare against. */
+    Con *con;
+    TAILQ_FOREACH (con, &all_cons, all_cons) {
+        con->delta_state = scalloc(1, sizeof(struct tree_delta_state));
+        state_fill(con->delta_state, con);
+    }
+    tracking = true;
+}
+
+/* A container which was added or changed since the last event. */
+struct changed_con {
+    Con *con;
+    struct tree_delta_state *state;
+    /* NULL for added containers */
+    struct tree_delta_state *old;
+};
+
+struct tree_delta_event {
+    struct changed_con *changed;
+    int num_changed;
+};
+
+static void marshal_tree_delta_event(ipc_gen *gen, void *data) {
+    struct tree_delta_event *event = data;
+
+    y(map_open);
+    ystr("change");
+    ystr("delta");
+    ystr("generation");
+    y(integer, generation);
+    ystr("records");
+    y(array_open);
+
+    removed_con *removed;
+    TAILQ_FOREACH (removed, &removed_cons, removed) {
+        y(map_open);
+        ystr("op");
+        ystr("remove");
+        ystr("id");
+        y(integer, removed->id);
+        y(map_close);
+    }
+
+    for (int i = 0; i < event->num_changed; i++) {
+        struct changed_con *changed = &(event->changed[i]);
+        y(map_open);
+        ystr("op");
+        ystr(changed->old == NULL ? "add" : "update");
+        ystr("id");
+        y(integer, (uintptr_t)changed->con);
+        dump_changed_fields(gen, changed->state, changed->old);
+        y(map_close);
+    }
+
+    y(array_close);
+    y(map_close);
+}
+
+/*
+ * Sends a tree_delta event with the containers which were added, removed or
+ * changed since the last call (if any). Called after rendering the tree.
+ *
+ * Containers are only tracked while there are subscribers to the tree_delta
+ * event.
+ *
+ */
+void tree_delta_send(void) {
+    if (!ipc_has_event_subscribers(I3_IPC_EVENT_TREE_DELTA, "delta")) {
+        if (tracking) {
+            stop_tracking();
+        }
+        return;
+    }
+
+    if (!tracking) {
+        tree_delta_start();
+        return;
+    }
+
+    /* The changes are collected first, as the event may be generated once
+     * per encoding. */
+    struct tree_delta_event event = {0};
+    int capacity = 0;
+    Con *con;
+    TAILQ_FOREACH (con, &all_cons, all_cons) {
+        struct tree_delta_state *old = con->delta_state;
+        if (old != NULL && !con_changed(con, old)) {
+            continue;
+        }
+
+        struct tree_delta_state *state = scalloc(1, sizeof(struct tree_delta_state));
+        state_fill(state, con);
+
+        if (event.num_changed == capacity) {
+            capacity = (capacity == 0 ? 16 : capacity * 2);
+            event.changed = srealloc(event.changed, capacity * sizeof(struct changed_con));
+        }
+        event.changed[event.num_changed++] = (struct changed_con){
+            .con = con,
+            .state = state,
+            .old = old};
+    }
+
+    if (event.num_changed > 0 || !TAILQ_EMPTY(&removed_cons)) {
+        generation++;
+        ipc_send_filtered_event("tree_delta", I3_IPC_EVENT_TREE_DELTA, "delta", NULL, marshal_tree_delta_event, &event);
+    }
+
+    while (!TAILQ_EMPTY(&removed_cons)) {
+        removed_con *removed = TAILQ_FIRST(&removed_cons);
+        TAILQ_REMOVE(&removed_cons, removed, removed);
+        free(removed);
+    }
+    for (int i = 0; i < event.num_changed; i++) {
+        struct changed_con *changed = &(event.changed[i]);
+        if (changed->old != NULL) {
+            state_free(changed->old);
+        }
+        changed->con->delta_state = changed->state;
+    }
+    free(event.changed);
+}
+
+/*
+ * Needs to be called when a container is freed, so that its removal is
+ * included in the next tree_delta event.
+ *
+ */
+void tree_delta_con_freed(Con *con) {
+    if (con->delta_state == NULL) {
+        return;
+    }
+
+    state_free(con->delta_state);
+    con->delta_state = NULL;
+
+    removed_con *removed = smalloc(sizeof(removed_con));
+    removed->id = (uintptr_t)con;
+    TAILQ_INSERT_TAIL(&removed_cons, removed, removed);
+}
+
+/*
+ * Returns the generation of the last tree_delta event.
+ *
+ */
+uint64_t tree_delta_generation(void) {
+    return generation;
+}
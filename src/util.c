@@ -213,12 +213,12 @@ static char **add_argument(char **original, char *opt_char, char *opt_arg, char
     return result;
 }
 
-#define y(x, ...) yajl_gen_##x(gen, ##__VA_ARGS__)
-#define ystr(str) yajl_gen_string(gen, (unsigned char *)str, strlen(str))
+#define y(x, ...) ipc_gen_##x(gen, ##__VA_ARGS__)
+#define ystr(str) ipc_gen_string(gen, (unsigned char *)str, strlen(str))
 
 static char *store_restart_layout(void) {
     setlocale(LC_NUMERIC, "C");
-    yajl_gen gen = yajl_gen_alloc(NULL);
+    ipc_gen *gen = ipc_gen_alloc(false);
 
     dump_node(gen, croot, true);
 
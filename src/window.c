@@ -22,6 +22,7 @@ void window_free(i3Window *win) {
     FREE(win->machine);
     i3string_free(win->name);
     cairo_surface_destroy(win->icon);
+    cairo_surface_destroy(win->scaled_icon);
     FREE(win->ran_assignments);
     FREE(win);
 }
@@ -614,6 +615,10 @@ void window_update_icon(i3Window *win, xcb_get_property_reply_t *prop) {
     if (win->icon != NULL) {
         cairo_surface_destroy(win->icon);
     }
+    if (win->scaled_icon != NULL) {
+        cairo_surface_destroy(win->scaled_icon);
+        win->scaled_icon = NULL;
+    }
     win->icon = cairo_image_surface_create_for_data(
         (unsigned char *)icon,
         CAIRO_FORMAT_ARGB32,
@@ -625,3 +630,45 @@ void window_update_icon(i3Window *win, xcb_get_property_reply_t *prop) {
 
     FREE(prop);
 }
+
+/*
+ * Returns the window icon scaled to fit into a square of the given size. The
+ * scaled icon is cached until the icon or the size changes.
+ *
+ */
+cairo_surface_t *window_get_scaled_icon(i3Window *win, int size) {
+    if (win->scaled_icon != NULL && win->scaled_icon_size == size) {
+        return win->scaled_icon;
+    }
+
+    if (win->scaled_icon != NULL) {
+        cairo_surface_destroy(win->scaled_icon);
+    }
+    win->scaled_icon_size = size;
+
+    const int src_width = cairo_image_surface_get_width(win->icon);
+    const int src_height = cairo_image_surface_get_height(win->icon);
+    const double scale = MIN((double)size / src_width, (double)size / src_height);
+    const int width = max(1, (int)(src_width * scale + 0.5));
+    const int height = max(1, (int)(src_height * scale + 0.5));
+
+    if (width == src_width && height == src_height) {
+        win->scaled_icon = cairo_surface_reference(win->icon);
+        return win->scaled_icon;
+    }
+
+    /* Scale once with a good filter, so that drawing the decoration is a
+     * plain copy. */
+    win->scaled_icon = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    cairo_t *cr = cairo_create(win->scaled_icon);
+    cairo_scale(cr, (double)width / src_width, (double)height / src_height);
+    cairo_set_source_surface(cr, win->icon, 0, 0);
+    cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_BEST);
+    /* Do not fade the edges of the icon into transparency. */
+    cairo_pattern_set_extend(cairo_get_source(cr), CAIRO_EXTEND_PAD);
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    cairo_paint(cr);
+    cairo_destroy(cr);
+
+    return win->scaled_icon;
+}
@@ -531,15 +531,10 @@ void workspace_show(Con *workspace) {
         /* check if this workspace is currently visible */
         if (!workspace_is_visible(old)) {
             LOG("Closing old workspace (%p / %s), it is empty\n", old, old->name);
-            yajl_gen gen = ipc_marshal_workspace_event("empty", old, NULL);
+            /* The event needs to be serialized before closing the workspace. */
+            ipc_prepared_event *event = ipc_prepare_workspace_event("empty", old, NULL);
             tree_close_internal(old, DONT_KILL_WINDOW, false);
-
-            const unsigned char *payload;
-            ylength length;
-            y(get_buf, &payload, &length);
-            ipc_send_event("workspace", I3_IPC_EVENT_WORKSPACE, (const char *)payload);
-
-            y(free);
+            ipc_send_prepared_event(event);
 
             /* Avoid calling output_push_sticky_windows later with a freed container. */
             if (old == old_focus) {
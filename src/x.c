@@ -460,6 +460,7 @@ static size_t x_get_border_rectangles(Con *con, xcb_rectangle_t rectangles[4]) {
  *
  */
 void x_draw_decoration(Con *con) {
+    TRACE_SPAN(span, "x_draw_decoration", con->name, -1);
     Con *parent = con->parent;
     bool leaf = con_is_leaf(con);
 
@@ -792,7 +793,7 @@ void x_draw_decoration(Con *con) {
                    deco_width - mark_width - 2 * title_padding - total_icon_space);
     if (has_icon) {
         draw_util_image(
-            win->icon,
+            window_get_scaled_icon(win, icon_size),
             dest_surface,
             con->deco_rect.x + icon_offset_x,
             con->deco_rect.y + logical_px(1),
@@ -1305,9 +1306,16 @@ static bool is_con_attached(Con *con) {
  *
  */
 void x_push_changes(Con *con) {
+    TRACE_SPAN(span, "x_push_changes", NULL, -1);
     con_state *state;
     xcb_query_pointer_cookie_t pointercookie;
 
+    /* A batched render is pending, which will push all changes anyway. Pushing
+     * now would send state which was not rendered yet. */
+    if (tree_render_is_pending()) {
+        return;
+    }
+
     /* If we need to warp later, we request the pointer position as soon as possible */
     if (warp_to) {
         pointercookie = xcb_query_pointer(conn, root);
@@ -1388,6 +1396,8 @@ void x_push_changes(Con *con) {
         ewmh_update_client_list(client_list_windows, client_list_count);
     }
 
+    ewmh_flush_properties();
+
     DLOG("PUSHING CHANGES\n");
     x_push_node(con);
 
@@ -1572,6 +1582,12 @@ void x_set_i3_atoms(void) {
     xcb_change_property(conn, XCB_PROP_MODE_REPLACE, root, A_I3_LOG_STREAM_SOCKET_PATH, A_UTF8_STRING, 8,
                         strlen(current_log_stream_socket_path), current_log_stream_socket_path);
     update_shmlog_atom();
+    if (state_snapshot_path == NULL) {
+        xcb_delete_property(conn, root, A_I3_STATE_PATH);
+    } else {
+        xcb_change_property(conn, XCB_PROP_MODE_REPLACE, root, A_I3_STATE_PATH, A_UTF8_STRING, 8,
+                            strlen(state_snapshot_path), state_snapshot_path);
+    }
 }
 
 /*
@@ -0,0 +1,120 @@
+/*
+ * vim:ts=4:sw=4:expandtab
+ *
+ * i3 - an improved tiling window manager
+ * © 2009 Michael Stapelberg and contributors (see also: LICENSE)
+ *
+ * cbor_to_json.c: Parses a CBOR-encoded IPC message (see
+ * I3_IPC_MESSAGE_FLAG_CBOR) from the given file with ipc_cbor_parse() and
+ * prints it as JSON, so that the tests can compare it with the JSON encoding.
+ *
+ */
+#include "libi3.h"
+
+#include <err.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "yajl_utils.h"
+
+static int null_cb(void *gen) {
+    y(null);
+    return 1;
+}
+
+static int boolean_cb(void *gen, int val) {
+    y(bool, val);
+    return 1;
+}
+
+static int integer_cb(void *gen, long long val) {
+    y(integer, val);
+    return 1;
+}
+
+static int double_cb(void *gen, double val) {
+    y(double, val);
+    return 1;
+}
+
+static int string_cb(void *gen, const unsigned char *val, size_t len) {
+    y(string, val, len);
+    return 1;
+}
+
+static int start_map_cb(void *gen) {
+    y(map_open);
+    return 1;
+}
+
+static int end_map_cb(void *gen) {
+    y(map_close);
+    return 1;
+}
+
+static int start_array_cb(void *gen) {
+    y(array_open);
+    return 1;
+}
+
+static int end_array_cb(void *gen) {
+    y(array_close);
+    return 1;
+}
+
+static const yajl_callbacks callbacks = {
+    .yajl_null = null_cb,
+    .yajl_boolean = boolean_cb,
+    .yajl_integer = integer_cb,
+    .yajl_double = double_cb,
+    .yajl_string = string_cb,
+    .yajl_start_map = start_map_cb,
+    .yajl_map_key = string_cb,
+    .yajl_end_map = end_map_cb,
+    .yajl_start_array = start_array_cb,
+    .yajl_end_array = end_array_cb,
+};
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "Syntax: %s <file>\n", argv[0]);
+        return 1;
+    }
+
+    FILE *file = fopen(argv[1], "r");
+    if (file == NULL) {
+        err(EXIT_FAILURE, "fopen(%s)", argv[1]);
+    }
+    size_t size = 4096;
+    size_t length = 0;
+    uint8_t *cbor = smalloc(size);
+    size_t n;
+    while ((n = fread(cbor + length, 1, size - length, file)) > 0) {
+        length += n;
+        if (length == size) {
+            size *= 2;
+            cbor = srealloc(cbor, size);
+        }
+    }
+    if (ferror(file)) {
+        err(EXIT_FAILURE, "fread(%s)", argv[1]);
+    }
+    fclose(file);
+
+    ipc_gen *gen = ipc_gen_alloc(false);
+    if (!ipc_cbor_parse(cbor, length, &callbacks, gen)) {
+        errx(EXIT_FAILURE, "Could not parse the CBOR in %s", argv[1]);
+    }
+
+    const unsigned char *json;
+    size_t json_length;
+    y(get_buf, &json, &json_length);
+    fwrite(json, 1, json_length, stdout);
+    fputc('\n', stdout);
+
+    y(free);
+    free(cbor);
+    return 0;
+}
@@ -62,6 +62,10 @@ is($bar_config->{status_command}, 'i3status --foo', 'status_command correct');
 ok(!$bar_config->{verbose}, 'verbose off by default');
 ok($bar_config->{workspace_buttons}, 'workspace buttons enabled per default');
 is($bar_config->{workspace_min_width}, 0, 'workspace_min_width ok');
+is($bar_config->{status_redraw_interval}, 0, 'status_redraw_interval 0 by default');
+ok(!$bar_config->{gradients}, 'gradients off by default');
+ok(!$bar_config->{dithering}, 'dithering off by default');
+is($bar_config->{dither_noise}, 0.5, 'dither_noise 0.5 by default');
 ok($bar_config->{binding_mode_indicator}, 'mode indicator enabled per default');
 is($bar_config->{mode}, 'dock', 'dock mode by default');
 is($bar_config->{position}, 'bottom', 'position bottom by default');
@@ -101,7 +105,11 @@ bar {
     font Terminus
     workspace_buttons no
     workspace_min_width 30
+    status_redraw_interval 33 ms
     binding_mode_indicator no
+    gradients yes
+    dithering yes
+    dither_noise 0.25
     verbose yes
     socket_path /tmp/foobar
 
@@ -111,8 +119,10 @@ bar {
         focused_background #cc0000
         focused_statusline #cccc00
         focused_separator  #0000cc
+        gradient_start #1f1947
+        gradient_end   #2e9ef4
 
-        focused_workspace   #4c7899 #285577 #ffffff
+        focused_workspace   #4c7899 #285577 #ffffff #1f1947
         active_workspace    #333333 #222222 #888888
         inactive_workspace  #333333 #222222 #888888
         urgent_workspace    #2f343a #900000 #ffffff
@@ -140,6 +150,10 @@ is($bar_config->{status_command}, 'i3status --bar', 'status_command correct');
 ok($bar_config->{verbose}, 'verbose on');
 ok(!$bar_config->{workspace_buttons}, 'workspace buttons disabled');
 is($bar_config->{workspace_min_width}, 30, 'workspace_min_width ok');
+is($bar_config->{status_redraw_interval}, 33, 'status_redraw_interval ok');
+ok($bar_config->{gradients}, 'gradients on');
+ok($bar_config->{dithering}, 'dithering on');
+is($bar_config->{dither_noise}, 0.25, 'dither_noise ok');
 ok(!$bar_config->{binding_mode_indicator}, 'mode indicator disabled');
 is($bar_config->{mode}, 'dock', 'dock mode');
 is($bar_config->{position}, 'top', 'position top');
@@ -163,9 +177,12 @@ is_deeply($bar_config->{colors},
         focused_background => '#cc0000',
         focused_statusline=> '#cccc00',
         focused_separator => '#0000cc',
+        gradient_start => '#1f1947',
+        gradient_end => '#2e9ef4',
         focused_workspace_border => '#4c7899',
         focused_workspace_text => '#ffffff',
         focused_workspace_bg => '#285577',
+        focused_workspace_gradient => '#1f1947',
         active_workspace_border => '#333333',
         active_workspace_text => '#888888',
         active_workspace_bg => '#222222',
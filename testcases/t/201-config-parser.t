@@ -429,6 +429,44 @@ is(parser_calls($config),
    $expected,
    'force_display_urgency_hint ok');
 
+################################################################################
+# property_coalesce_interval
+################################################################################
+
+$config = <<'EOT';
+property_coalesce_interval 0
+property_coalesce_interval 50 ms
+property_coalesce_interval 100ms
+EOT
+
+$expected = <<'EOT';
+cfg_property_coalesce_interval(0)
+cfg_property_coalesce_interval(50)
+cfg_property_coalesce_interval(100)
+EOT
+
+is(parser_calls($config),
+   $expected,
+   'property_coalesce_interval ok');
+
+################################################################################
+# render_batching
+################################################################################
+
+$config = <<'EOT';
+render_batching yes
+render_batching no
+EOT
+
+$expected = <<'EOT';
+cfg_render_batching(yes)
+cfg_render_batching(no)
+EOT
+
+is(parser_calls($config),
+   $expected,
+   'render_batching ok');
+
 ################################################################################
 # workspace
 ################################################################################
@@ -554,6 +592,8 @@ my $expected_all_tokens = "ERROR: CONFIG: Expected one of these tokens: <end>, '
         ipc_kill_timeout
         restart_state
         popup_during_fullscreen
+        property_coalesce_interval
+        render_batching
 	tiling_drag
         exec_always
         exec
@@ -774,7 +814,7 @@ EOT
 $expected = <<'EOT';
 cfg_bar_start()
 cfg_bar_output(LVDS-1)
-ERROR: CONFIG: Expected one of these tokens: <end>, '#', 'set', 'i3bar_command', 'status_command', 'workspace_command', 'socket_path', 'mode', 'hidden_state', 'id', 'modifier', 'wheel_up_cmd', 'wheel_down_cmd', 'bindsym', 'position', 'output', 'tray_output', 'tray_padding', 'font', 'separator_symbol', 'binding_mode_indicator', 'workspace_buttons', 'workspace_min_width', 'strip_workspace_numbers', 'strip_workspace_name', 'verbose', 'height', 'padding', 'colors', '}'
+ERROR: CONFIG: Expected one of these tokens: <end>, '#', 'set', 'i3bar_command', 'status_command', 'workspace_command', 'socket_path', 'mode', 'hidden_state', 'id', 'modifier', 'wheel_up_cmd', 'wheel_down_cmd', 'bindsym', 'position', 'output', 'tray_output', 'tray_padding', 'font', 'separator_symbol', 'binding_mode_indicator', 'workspace_buttons', 'workspace_min_width', 'status_redraw_interval', 'strip_workspace_numbers', 'strip_workspace_name', 'gradients', 'dithering', 'dither_noise', 'verbose', 'height', 'padding', 'colors', '}'
 ERROR: CONFIG: (in file <stdin>)
 ERROR: CONFIG: Line   1: bar {
 ERROR: CONFIG: Line   2:     output LVDS-1
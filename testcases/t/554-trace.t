@@ -0,0 +1,55 @@
+#!perl
+# vim:ts=4:sw=4:expandtab
+#
+# Please read the following documents before working on tests:
+# • https://build.i3wm.org/docs/testsuite.html
+#   (or docs/testsuite)
+#
+# • https://build.i3wm.org/docs/lib-i3test.html
+#   (alternatively: perldoc ./testcases/lib/i3test.pm)
+#
+# • https://build.i3wm.org/docs/ipc.html
+#   (or docs/ipc)
+#
+# • https://i3wm.org/downloads/modern_perl_a4.pdf
+#   (unless you are already familiar with Perl)
+#
+# Verifies the trace command and the GET_TRACE IPC message.
+use i3test;
+
+my $i3 = i3(get_socket_path());
+$i3->connect->recv;
+
+# TODO: use the symbolic name for the command/reply type instead of the
+# numerical 13:
+my $trace = $i3->message(13, "")->recv;
+is_deeply($trace->{traceEvents}, [], 'nothing recorded while tracing is disabled');
+
+cmd 'trace on';
+
+my $tmp = fresh_workspace;
+open_window;
+cmd 'split v';
+
+cmd 'trace off';
+
+$trace = $i3->message(13, "")->recv;
+my @events = @{$trace->{traceEvents}};
+ok(@events > 0, 'spans recorded');
+
+my %names = map { ($_->{name} => 1) } @events;
+ok($names{tree_render}, 'tree_render span recorded');
+ok($names{x_push_changes}, 'x_push_changes span recorded');
+ok($names{'x_event: MapRequest'}, 'MapRequest event span recorded');
+
+my ($command) = grep { $_->{name} eq 'command' && $_->{args}->{detail} eq 'split v' } @events;
+ok(defined($command), 'command span recorded with the command as detail');
+is($command->{ph}, 'X', 'spans are complete events');
+ok($command->{dur} >= 0, 'span has a duration');
+
+my $count = scalar @events;
+cmd 'nop';
+$trace = $i3->message(13, "")->recv;
+is(scalar @{$trace->{traceEvents}}, $count, 'nothing recorded after disabling tracing');
+
+done_testing;
@@ -0,0 +1,56 @@
+#!perl
+# vim:ts=4:sw=4:expandtab
+#
+# Please read the following documents before working on tests:
+# • https://build.i3wm.org/docs/testsuite.html
+#   (or docs/testsuite)
+#
+# • https://build.i3wm.org/docs/lib-i3test.html
+#   (alternatively: perldoc ./testcases/lib/i3test.pm)
+#
+# • https://build.i3wm.org/docs/ipc.html
+#   (or docs/ipc)
+#
+# • https://i3wm.org/downloads/modern_perl_a4.pdf
+#   (unless you are already familiar with Perl)
+#
+# Verifies the latency histograms of the GET_LATENCY IPC message.
+use i3test;
+
+my $i3 = i3(get_socket_path());
+$i3->connect->recv;
+
+sub get_histogram {
+    my ($name) = @_;
+    # TODO: use the symbolic name for the command/reply type instead of the
+    # numerical 14:
+    my $histograms = $i3->message(14, "")->recv;
+    my ($histogram) = grep { $_->{name} eq $name } @$histograms;
+    return $histogram;
+}
+
+my $tmp = fresh_workspace;
+
+cmd 'nop first';
+cmd '[con_mark="foo"] nop second';
+cmd '[title="]anything"] nop third';
+cmd 'this-is-not-a-command';
+sync_with_i3;
+
+my $nop = get_histogram('command:nop');
+ok(defined($nop), 'histogram for the nop command exists');
+is($nop->{count}, 3, 'all nop commands measured, criteria skipped');
+ok($nop->{min} <= $nop->{p50}, 'median is at least the minimum');
+ok($nop->{p50} <= $nop->{p99}, 'percentiles are ordered');
+ok($nop->{p999} <= $nop->{max}, '99.9th percentile is at most the maximum');
+
+my $total = 0;
+$total += $_->[1] for @{$nop->{buckets}};
+is($total, 3, 'buckets contain all measurements');
+
+ok(!defined(get_histogram('command:this-is-not-a-command')),
+   'invalid commands are not measured');
+ok(!defined(get_histogram('command:anything"]')),
+   'quoted brackets in criteria do not name a histogram');
+
+done_testing;
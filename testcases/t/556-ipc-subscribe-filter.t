@@ -0,0 +1,97 @@
+#!perl
+# vim:ts=4:sw=4:expandtab
+#
+# Please read the following documents before working on tests:
+# • https://build.i3wm.org/docs/testsuite.html
+#   (or docs/testsuite)
+#
+# • https://build.i3wm.org/docs/lib-i3test.html
+#   (alternatively: perldoc ./testcases/lib/i3test.pm)
+#
+# • https://build.i3wm.org/docs/ipc.html
+#   (or docs/ipc)
+#
+# • https://i3wm.org/downloads/modern_perl_a4.pdf
+#   (unless you are already familiar with Perl)
+#
+# Verifies that window events are filtered by the change and criteria given in
+# the SUBSCRIBE message.
+use i3test;
+
+# Returns the window events received while $cb was running, subscribed with
+# the given window event filter.
+sub filtered_window_events {
+    my ($filter, $cb) = @_;
+
+    my @events;
+    my $subscribed = AnyEvent->condvar;
+    my $flushed = AnyEvent->condvar;
+
+    my $i3 = i3(get_socket_path(0));
+    $i3->connect->recv;
+    my $reply = $i3->subscribe({
+        window => sub { push @events, shift },
+        tick => sub {
+            my ($event) = @_;
+            if ($event->{first}) {
+                $subscribed->send($event);
+            } else {
+                $flushed->send($event);
+            }
+        },
+    }, { window => $filter })->recv;
+    ok($reply->{success}, 'subscription successful');
+    $subscribed->recv;
+
+    $cb->();
+
+    $i3->send_tick('flush');
+    $flushed->recv;
+    return @events;
+}
+
+fresh_workspace;
+
+################################################################################
+# Filter by change.
+################################################################################
+
+my $window;
+my @events = filtered_window_events({ change => [ 'title' ] }, sub {
+    $window = open_window(name => 'before');
+    $window->name('after');
+    sync_with_i3;
+});
+
+is(scalar @events, 1, 'only one window event received');
+is($events[0]->{change}, 'title', 'title event received');
+is($events[0]->{container}->{name}, 'after', 'title event has the new title');
+
+################################################################################
+# Filter by criteria.
+################################################################################
+
+@events = filtered_window_events({ criteria => { title => '^wanted$' } }, sub {
+    open_window(name => 'wanted');
+    open_window(name => 'unwanted');
+});
+
+ok(@events > 0, 'window events received');
+is_deeply([ grep { $_->{container}->{name} ne 'wanted' } @events ], [],
+          'only events of the matching window received');
+is_deeply([ map { $_->{change} } grep { $_->{change} eq 'new' } @events ], [ 'new' ],
+          'new event of the matching window received');
+
+################################################################################
+# Invalid filters are rejected.
+################################################################################
+
+my $i3 = i3(get_socket_path(0));
+$i3->connect->recv;
+my $reply = $i3->message(2, [ { event => 'workspace', criteria => { class => 'foo' } } ])->recv;
+ok(!$reply->{success}, 'criteria on workspace events rejected');
+
+$reply = $i3->message(2, [ { event => 'nonexistent', change => 'foo' } ])->recv;
+ok(!$reply->{success}, 'filter for an unknown event rejected');
+
+done_testing;
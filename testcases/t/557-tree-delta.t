@@ -0,0 +1,86 @@
+#!perl
+# vim:ts=4:sw=4:expandtab
+#
+# Please read the following documents before working on tests:
+# • https://build.i3wm.org/docs/testsuite.html
+#   (or docs/testsuite)
+#
+# • https://build.i3wm.org/docs/lib-i3test.html
+#   (alternatively: perldoc ./testcases/lib/i3test.pm)
+#
+# • https://build.i3wm.org/docs/ipc.html
+#   (or docs/ipc)
+#
+# • https://i3wm.org/downloads/modern_perl_a4.pdf
+#   (unless you are already familiar with Perl)
+#
+# Verifies the records of the tree_delta event.
+use i3test;
+
+my $i3 = i3(get_socket_path());
+$i3->connect->recv;
+
+my $ws = fresh_workspace;
+
+################################################################################
+# Opening a window adds its container.
+################################################################################
+
+my $window;
+my @events = events_for(
+    sub {
+        $window = open_window;
+    },
+    'tree_delta');
+
+ok(@events > 0, 'tree_delta events received');
+is($events[0]->{change}, 'delta', 'change is delta');
+
+my @records = map { @{$_->{records}} } @events;
+my ($added) = grep { $_->{op} eq 'add' && defined($_->{window}) && $_->{window} == $window->id } @records;
+ok(defined($added), 'container of the window added');
+is($added->{type}, 'con', 'added container has its type');
+ok(exists($added->{rect}), 'added container has its rect');
+
+my $con_id = get_focused($ws);
+is($added->{id}, $con_id, 'added container has the id of the focused container');
+
+my $tree = $i3->get_tree->recv;
+is($tree->{generation}, $events[-1]->{generation}, 'GET_TREE contains the generation of the last event');
+
+for my $i (1 .. $#events) {
+    is($events[$i]->{generation}, $events[$i - 1]->{generation} + 1, 'generations are consecutive');
+}
+
+################################################################################
+# Renaming a window only updates its name.
+################################################################################
+
+@events = events_for(
+    sub {
+        $window->name('new title');
+        sync_with_i3;
+    },
+    'tree_delta');
+
+@records = grep { $_->{id} == $con_id } map { @{$_->{records}} } @events;
+is(scalar @records, 1, 'one record for the renamed container');
+is_deeply($records[0], { op => 'update', id => $con_id, name => 'new title' },
+          'only the name is updated');
+
+################################################################################
+# Closing a window removes its container.
+################################################################################
+
+@events = events_for(
+    sub {
+        cmd 'kill';
+        wait_for_unmap $window;
+        sync_with_i3;
+    },
+    'tree_delta');
+
+@records = grep { $_->{id} == $con_id } map { @{$_->{records}} } @events;
+is_deeply(\@records, [ { op => 'remove', id => $con_id } ], 'container removed');
+
+done_testing;
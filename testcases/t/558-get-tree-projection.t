@@ -0,0 +1,68 @@
+#!perl
+# vim:ts=4:sw=4:expandtab
+#
+# Please read the following documents before working on tests:
+# • https://build.i3wm.org/docs/testsuite.html
+#   (or docs/testsuite)
+#
+# • https://build.i3wm.org/docs/lib-i3test.html
+#   (alternatively: perldoc ./testcases/lib/i3test.pm)
+#
+# • https://build.i3wm.org/docs/ipc.html
+#   (or docs/ipc)
+#
+# • https://i3wm.org/downloads/modern_perl_a4.pdf
+#   (unless you are already familiar with Perl)
+#
+# Verifies that GET_TREE only dumps the requested containers and fields.
+use i3test;
+
+my $i3 = i3(get_socket_path());
+$i3->connect->recv;
+
+my $ws = fresh_workspace;
+my $first = open_window(name => 'first');
+my $second = open_window(name => 'second');
+
+################################################################################
+# Selecting fields.
+################################################################################
+
+my $tree = $i3->get_tree({ fields => [ 'id', 'name' ] })->recv;
+is_deeply([ sort keys %$tree ], [ 'id', 'name' ], 'only the requested fields are dumped');
+
+$tree = $i3->get_tree({ fields => [ 'id', 'name', 'nodes' ] })->recv;
+ok(@{$tree->{nodes}} > 0, 'children dumped with nodes');
+is_deeply([ sort keys %{$tree->{nodes}->[0]} ], [ 'id', 'name', 'nodes' ],
+          'children only contain the requested fields');
+
+$tree = $i3->get_tree({ fields => [ 'nonexistent' ] })->recv;
+ok(!$tree->{success}, 'unknown field rejected');
+
+################################################################################
+# Starting container and maximum depth.
+################################################################################
+
+my $ws_con = get_ws($ws);
+
+$tree = $i3->get_tree({ con_id => $ws_con->{id}, max_depth => 1, fields => [ 'id', 'type', 'name', 'nodes' ] })->recv;
+is($tree->{id}, $ws_con->{id}, 'dump starts at the given container');
+is($tree->{type}, 'workspace', 'starting container is the workspace');
+is_deeply([ map { $_->{name} } @{$tree->{nodes}} ], [ 'first', 'second' ], 'children dumped');
+ok(!exists($tree->{nodes}->[0]->{nodes}), 'no nodes beyond the maximum depth');
+
+$tree = $i3->get_tree({ con_id => $ws_con->{id}, max_depth => 0 })->recv;
+ok(!exists($tree->{nodes}), 'no children with a maximum depth of 0');
+is($tree->{name}, $ws, 'all fields dumped by default');
+
+$tree = $i3->get_tree({ con_id => 1 })->recv;
+ok(!$tree->{success}, 'nonexistent con_id rejected');
+
+################################################################################
+# Criteria.
+################################################################################
+
+my $matches = $i3->get_tree({ criteria => { title => '^second$' }, fields => [ 'window', 'name' ] })->recv;
+is_deeply($matches, [ { window => $second->id, name => 'second' } ], 'matching container dumped');
+
+done_testing;
@@ -0,0 +1,165 @@
+#!perl
+# vim:ts=4:sw=4:expandtab
+#
+# Please read the following documents before working on tests:
+# • https://build.i3wm.org/docs/testsuite.html
+#   (or docs/testsuite)
+#
+# • https://build.i3wm.org/docs/lib-i3test.html
+#   (alternatively: perldoc ./testcases/lib/i3test.pm)
+#
+# • https://build.i3wm.org/docs/ipc.html
+#   (or docs/ipc)
+#
+# • https://i3wm.org/downloads/modern_perl_a4.pdf
+#   (unless you are already familiar with Perl)
+#
+# Verifies that replies and events are encoded as CBOR when the client sets
+# I3_IPC_MESSAGE_FLAG_CBOR and that they contain the same data as the JSON.
+use i3test;
+use File::Temp qw(tempfile);
+use IO::Socket::UNIX;
+use JSON::XS;
+
+my $flag_cbor = 1 << 30;
+
+sub send_message {
+    my ($sock, $type, $payload) = @_;
+    print $sock 'i3-ipc' . pack('LL', length($payload), $type) . $payload;
+}
+
+sub recv_message {
+    my ($sock) = @_;
+    read($sock, my $header, 14) == 14 or die 'could not read header';
+    my ($magic, $length, $type) = unpack('a6LL', $header);
+    my $payload = '';
+    read($sock, $payload, $length) == $length or die 'could not read payload' if $length > 0;
+    return ($type, $payload);
+}
+
+# Decodes the subset of CBOR which i3 generates.
+sub decode_cbor {
+    my ($data) = @_;
+    my $pos = 0;
+    my $decode;
+    $decode = sub {
+        my ($strings) = @_;
+        my $initial = ord(substr($data, $pos++, 1));
+        my ($major, $info) = ($initial >> 5, $initial & 0x1f);
+        my $value = $info;
+        if ($info >= 24 && $info <= 27) {
+            my $size = 1 << ($info - 24);
+            $value = 0;
+            $value = $value * 256 + ord(substr($data, $pos++, 1)) for 1 .. $size;
+        }
+        return $value if $major == 0;
+        return -1 - $value if $major == 1;
+        if ($major == 3) {
+            my $str = substr($data, $pos, $value);
+            $pos += $value;
+            my $min = (@$strings < 24 ? 3 : @$strings < 256 ? 4 : 5);
+            push @$strings, $str if defined($strings) && $value >= $min;
+            utf8::decode($str);
+            return $str;
+        }
+        if ($major == 4 || $major == 5) {
+            my @items;
+            while (ord(substr($data, $pos, 1)) != 0xff) {
+                push @items, $decode->($strings);
+            }
+            $pos++;
+            return ($major == 4 ? \@items : { @items });
+        }
+        if ($major == 6) {
+            return $decode->([]) if $value == 256;
+            my $index = $decode->($strings);
+            my $str = $strings->[$index];
+            utf8::decode($str);
+            return $str;
+        }
+        return JSON::XS::false if $info == 20;
+        return JSON::XS::true if $info == 21;
+        return undef if $info == 22;
+        if ($info == 27) {
+            my $double = unpack('d>', substr($data, $pos - 8, 8));
+            return $double;
+        }
+        die "unexpected CBOR item $initial";
+    };
+    my $result = $decode->(undef);
+    is($pos, length($data), 'whole CBOR message decoded');
+    return $result;
+}
+
+my $sock = IO::Socket::UNIX->new(Peer => get_socket_path());
+
+fresh_workspace;
+open_window(name => 'cbor test window');
+
+################################################################################
+# Replies
+################################################################################
+
+for my $request ([ 1, 'GET_WORKSPACES' ], [ 3, 'GET_OUTPUTS' ], [ 4, 'GET_TREE' ]) {
+    my ($type, $name) = @$request;
+
+    send_message($sock, $type, '');
+    my ($json_type, $json) = recv_message($sock);
+    send_message($sock, $type | $flag_cbor, '');
+    my ($cbor_type, $cbor) = recv_message($sock);
+
+    is($json_type, $type, "$name reply without flag");
+    is($cbor_type, $type | $flag_cbor, "$name reply has the CBOR flag");
+    is(substr($cbor, 0, 3), "\xd9\x01\x00", "$name reply is a stringref namespace");
+    ok(length($cbor) < length($json), "$name reply is smaller than the JSON");
+    is_deeply(decode_cbor($cbor), decode_json($json), "$name reply contains the same data");
+}
+
+################################################################################
+# ipc_cbor_parse() from libi3 reads the string references in the CBOR which i3
+# generates.
+################################################################################
+
+send_message($sock, 4, '');
+my (undef, $json_tree) = recv_message($sock);
+send_message($sock, 4 | $flag_cbor, '');
+my (undef, $cbor_tree) = recv_message($sock);
+like($cbor_tree, qr/\xd8\x19/, 'GET_TREE reply contains string references');
+
+my ($fh, $tmpfile) = tempfile('/tmp/i3-test-cbor.XXXXXX', UNLINK => 1);
+binmode($fh);
+print $fh $cbor_tree;
+close($fh);
+
+my $converted = qx(test.cbor_to_json $tmpfile);
+is($?, 0, 'test.cbor_to_json parsed the GET_TREE reply');
+is_deeply(decode_json($converted), decode_json($json_tree), 'GET_TREE reply parsed by ipc_cbor_parse contains the same data');
+
+send_message($sock, 7 | $flag_cbor, '');
+my ($type, $payload) = recv_message($sock);
+is($type, 7, 'GET_VERSION reply stays JSON');
+ok(decode_json($payload)->{human_readable}, 'GET_VERSION reply is valid JSON');
+
+################################################################################
+# Events
+################################################################################
+
+send_message($sock, 2 | $flag_cbor, '["tick"]');
+($type, $payload) = recv_message($sock);
+is($type, 2, 'SUBSCRIBE reply stays JSON');
+ok(decode_json($payload)->{success}, 'subscribed');
+
+($type, $payload) = recv_message($sock);
+is($type, (1 << 31) | 7 | $flag_cbor, 'first tick event has the CBOR flag');
+is_deeply(decode_cbor($payload), { first => JSON::XS::true, payload => '' }, 'first tick event decoded');
+
+send_message($sock, 10, 'cbor tick');
+($type, $payload) = recv_message($sock);
+is($type, (1 << 31) | 7 | $flag_cbor, 'tick event has the CBOR flag');
+is_deeply(decode_cbor($payload), { first => JSON::XS::false, payload => 'cbor tick' }, 'tick event decoded');
+($type, $payload) = recv_message($sock);
+is($type, 10, 'SEND_TICK reply received');
+
+close($sock);
+
+done_testing;
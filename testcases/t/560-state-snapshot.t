@@ -0,0 +1,94 @@
+#!perl
+# vim:ts=4:sw=4:expandtab
+#
+# Please read the following documents before working on tests:
+# • https://build.i3wm.org/docs/testsuite.html
+#   (or docs/testsuite)
+#
+# • https://build.i3wm.org/docs/lib-i3test.html
+#   (alternatively: perldoc ./testcases/lib/i3test.pm)
+#
+# • https://build.i3wm.org/docs/ipc.html
+#   (or docs/ipc)
+#
+# • https://i3wm.org/downloads/modern_perl_a4.pdf
+#   (unless you are already familiar with Perl)
+#
+# Verifies that the shared memory snapshot of the tree (I3_STATE_PATH) is
+# updated after rendering.
+use i3test;
+
+sub get_state_path {
+    my $cookie = $x->get_property(
+        0,
+        $x->get_root_window(),
+        $x->atom(name => 'I3_STATE_PATH')->id,
+        $x->atom(name => 'UTF8_STRING')->id,
+        0,
+        4096,
+    );
+    my $reply = $x->get_property_reply($cookie->{sequence});
+    return $reply->{value};
+}
+
+my $path = get_state_path;
+like($path, qr/^\/i3-state-\d+$/, 'I3_STATE_PATH set');
+
+SKIP: {
+    skip 'POSIX shared memory not in /dev/shm', 1 unless -e "/dev/shm$path";
+
+    # Returns the header and the containers of the snapshot.
+    sub read_snapshot {
+        open(my $fh, '<:raw', "/dev/shm$path") or die "Could not open snapshot: $!";
+        local $/;
+        my $data = <$fh>;
+        close($fh);
+
+        my %header;
+        @header{qw(magic version sequence size num_cons cons_offset strings_offset strings_size)} =
+            unpack('L8', $data);
+
+        my @cons;
+        for my $i (0 .. $header{num_cons} - 1) {
+            my %con;
+            @con{qw(id parent workspace window type x y width height flags name_offset name_length num)} =
+                unpack('Q3 L2 l2 L2 L3 l', substr($data, $header{cons_offset} + $i * 64, 64));
+            $con{name} = substr($data, $header{strings_offset} + $con{name_offset}, $con{name_length});
+            push @cons, \%con;
+        }
+        return (\%header, \@cons);
+    }
+
+    my $ws = fresh_workspace;
+    my $window = open_window(name => 'snapshot window');
+    sync_with_i3;
+
+    my ($header, $cons) = read_snapshot;
+    is($header->{magic}, 0x74733369, 'magic correct');
+    is($header->{sequence} % 2, 0, 'snapshot not being written');
+
+    my ($con) = grep { $_->{window} == $window->id } @$cons;
+    ok(defined($con), 'window in snapshot');
+    is($con->{name}, 'snapshot window', 'window name correct');
+    is($con->{id}, get_focused($ws), 'container id matches IPC');
+    ok($con->{flags} & 1, 'window focused');
+
+    my ($ws_con) = grep { $_->{id} == $con->{workspace} } @$cons;
+    is($ws_con->{name}, $ws, 'workspace correct');
+    is($ws_con->{type}, 4, 'workspace type correct');
+
+    # Without changes, the snapshot stays the same.
+    my $sequence = $header->{sequence};
+    cmd 'nop';
+    ($header, $cons) = read_snapshot;
+    is($header->{sequence}, $sequence, 'sequence unchanged without changes');
+
+    cmd 'rename workspace to snapshot_renamed';
+    sync_with_i3;
+    ($header, $cons) = read_snapshot;
+    isnt($header->{sequence}, $sequence, 'sequence changed');
+    ($ws_con) = grep { $_->{id} == $con->{workspace} } @$cons;
+    is($ws_con->{name}, 'snapshot_renamed', 'renamed workspace in snapshot');
+}
+
+done_testing;
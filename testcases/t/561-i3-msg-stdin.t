@@ -0,0 +1,51 @@
+#!perl
+# vim:ts=4:sw=4:expandtab
+#
+# Please read the following documents before working on tests:
+# • https://build.i3wm.org/docs/testsuite.html
+#   (or docs/testsuite)
+#
+# • https://build.i3wm.org/docs/lib-i3test.html
+#   (alternatively: perldoc ./testcases/lib/i3test.pm)
+#
+# • https://build.i3wm.org/docs/ipc.html
+#   (or docs/ipc)
+#
+# • https://i3wm.org/downloads/modern_perl_a4.pdf
+#   (unless you are already familiar with Perl)
+#
+# Verifies that i3-msg --stdin sends one message per line and prints the
+# replies in order.
+use i3test;
+use File::Temp qw(tempfile);
+use JSON::XS;
+
+sub i3_msg_stdin {
+    my ($input, @args) = @_;
+    my ($fh, $filename) = tempfile(UNLINK => 1);
+    print $fh $input;
+    close($fh);
+    my $socket = get_socket_path();
+    my @lines = split(/\n/, qx(i3-msg -s $socket @args --stdin < $filename 2>/dev/null));
+    return ($? >> 8, map { decode_json($_) } @lines);
+}
+
+my $ws = fresh_workspace;
+
+my ($status, @replies) = i3_msg_stdin("mark first\nmark --add second\nnonexistent_command\nmark --add last");
+is($status, 2, 'exit status 2 for the failed command');
+is(scalar @replies, 4, 'one reply per line, including the unterminated last one');
+ok($replies[0]->[0]->{success}, 'first command succeeded');
+ok($replies[1]->[0]->{success}, 'second command succeeded');
+ok(!$replies[2]->[0]->{success}, 'invalid command failed');
+ok($replies[3]->[0]->{success}, 'last command succeeded');
+
+is_deeply(get_ws($ws)->{marks}, [ 'first', 'second', 'last' ], 'commands ran in order');
+
+# 100 messages are sent before the first reply is read.
+($status, @replies) = i3_msg_stdin("\n" x 100, '-t', 'get_workspaces');
+is($status, 0, 'exit status 0');
+is(scalar @replies, 100, 'all replies received');
+ok((grep { $_->{name} eq $ws } @{$replies[99]}), 'reply contains the workspace');
+
+done_testing;
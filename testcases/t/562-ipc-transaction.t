@@ -0,0 +1,81 @@
+#!perl
+# vim:ts=4:sw=4:expandtab
+#
+# Please read the following documents before working on tests:
+# • https://build.i3wm.org/docs/testsuite.html
+#   (or docs/testsuite)
+#
+# • https://build.i3wm.org/docs/lib-i3test.html
+#   (alternatively: perldoc ./testcases/lib/i3test.pm)
+#
+# • https://build.i3wm.org/docs/ipc.html
+#   (or docs/ipc)
+#
+# • https://i3wm.org/downloads/modern_perl_a4.pdf
+#   (unless you are already familiar with Perl)
+# Verifies that RUN_TRANSACTION runs all commands and renders only once.
+use i3test;
+
+my $i3 = i3(get_socket_path());
+$i3->connect->recv;
+
+my $tmp = fresh_workspace;
+my $first = open_window;
+my $second = open_window;
+my $target = get_unused_workspace;
+
+cmd 'trace on';
+
+# TODO: use the symbolic name for the command/reply type instead of the
+# numerical 15:
+my $reply = $i3->message(15, [
+    '[id="' . $first->id . '"] move to workspace ' . $target,
+    '[id="' . $second->id . '"] move to workspace ' . $target,
+    'workspace ' . $target,
+    'layout tabbed',
+])->recv;
+
+cmd 'trace off';
+
+is(scalar @$reply, 4, 'one reply per command');
+ok((!grep { !$_->[0]->{success} } @$reply), 'all commands succeeded');
+
+is(focused_ws, $target, 'switched to the target workspace');
+my ($nodes) = get_ws_content($target);
+is(scalar @$nodes, 1, 'one container on the target workspace');
+is($nodes->[0]->{layout}, 'tabbed', 'container is tabbed');
+is(scalar @{$nodes->[0]->{nodes}}, 2, 'both windows moved');
+
+my @events = @{$i3->message(13, "")->recv->{traceEvents}};
+my ($transaction) = grep { $_->{name} eq 'transaction' } @events;
+ok(defined($transaction), 'transaction span recorded');
+my @renders = grep {
+    $_->{name} eq 'tree_render' &&
+    $_->{ts} >= $transaction->{ts} &&
+    $_->{ts} <= $transaction->{ts} + $transaction->{dur}
+} @events;
+is(scalar @renders, 1, 'rendered once');
+
+################################################################################
+# A parse error stops the transaction.
+################################################################################
+
+$tmp = fresh_workspace;
+$reply = $i3->message(15, [ 'mark first', 'nonexistent_command', 'mark --add last' ])->recv;
+is(scalar @$reply, 3, 'one reply per command');
+ok($reply->[0]->[0]->{success}, 'first command succeeded');
+ok($reply->[1]->[0]->{parse_error}, 'parse error reported');
+ok(!$reply->[2]->[0]->{success}, 'command after the parse error not run');
+is_deeply(get_ws($tmp)->{marks}, [ 'first' ], 'only the first command ran');
+
+################################################################################
+# Invalid payloads are rejected without running anything.
+################################################################################
+
+$reply = $i3->message(15, '"mark --add invalid"')->recv;
+ok(!$reply->{success}, 'non-array payload rejected');
+$reply = $i3->message(15, [ 'mark --add invalid', 42 ])->recv;
+ok(!$reply->{success}, 'non-string command rejected');
+is_deeply(get_ws($tmp)->{marks}, [ 'first' ], 'no command ran');
+
+done_testing;
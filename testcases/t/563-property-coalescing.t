@@ -0,0 +1,132 @@
+#!perl
+# vim:ts=4:sw=4:expandtab
+#
+# Please read the following documents before working on tests:
+# • https://build.i3wm.org/docs/testsuite.html
+#   (or docs/testsuite)
+#
+# • https://build.i3wm.org/docs/lib-i3test.html
+#   (alternatively: perldoc ./testcases/lib/i3test.pm)
+#
+# • https://build.i3wm.org/docs/ipc.html
+#   (or docs/ipc)
+#
+# • https://i3wm.org/downloads/modern_perl_a4.pdf
+#   (unless you are already familiar with Perl)
+#
+# Verifies that title changes are coalesced when property_coalesce_interval
+# is set, and that a sync or a RUN_TRANSACTION applies the pending change
+# right away.
+#
+# The interval is long enough to never expire during the test, so the title
+# only changes when one of these flushes it.
+use i3test i3_config => <<EOT;
+font -misc-fixed-medium-r-normal--13-120-75-75-C-70-iso10646-1
+
+property_coalesce_interval 60000ms
+EOT
+
+my $i3 = i3(get_socket_path(0));
+$i3->connect->recv;
+
+my @title_events;
+my $urgent;
+my $tick;
+$i3->subscribe({
+    window => sub {
+        my ($event) = @_;
+        if ($event->{change} eq 'title') {
+            push @title_events, $event;
+        } elsif ($event->{change} eq 'urgent' && defined($urgent)) {
+            $urgent->send($event);
+        }
+    },
+    tick => sub {
+        my ($event) = @_;
+        $tick->send($event) if defined($tick);
+    },
+})->recv;
+
+# Returns the title events received so far. Events are received in order, so
+# all events sent before the tick have arrived once the tick is received.
+sub received_title_events {
+    $tick = AnyEvent->condvar;
+    $i3->send_tick('property-coalescing');
+    $tick->recv;
+    undef $tick;
+    my @events = @title_events;
+    @title_events = ();
+    return @events;
+}
+
+# Sets the urgency hint of the given (unfocused) window and waits for i3 to
+# report it. X11 events are handled in order, so all property changes done
+# before have been queued by then.
+sub wait_until_handled {
+    my ($marker) = @_;
+    $urgent = AnyEvent->condvar;
+    my $timer = AnyEvent->timer(after => 2, cb => sub { $urgent->send(undef) });
+    $marker->add_hint('urgency');
+    $x->flush;
+    my $event = $urgent->recv;
+    undef $urgent;
+    ok(defined($event), 'urgency hint handled');
+}
+
+sub window_name {
+    my ($window) = @_;
+    my ($node) = grep { $_->{window} == $window->id } @{get_ws_content(focused_ws)};
+    return $node->{name};
+}
+
+fresh_workspace;
+my $first_marker = open_window;
+my $second_marker = open_window;
+my $window = open_window(name => 'Title 0');
+
+################################################################################
+# A burst of title changes results in a single event for the last title, which
+# a sync delivers right away.
+################################################################################
+
+$window->name('Title 1');
+$window->name('Title 2');
+$window->name('Title 3');
+wait_until_handled($first_marker);
+
+is(scalar received_title_events(), 0, 'no title event while coalescing');
+is(window_name($window), 'Title 0', 'title not updated while coalescing');
+
+sync_with_i3;
+
+my @events = received_title_events();
+is(scalar @events, 1, 'received one title event after the sync');
+is($events[0]->{container}->{name}, 'Title 3', 'event carries the last title');
+is(window_name($window), 'Title 3', 'title updated by the sync');
+
+################################################################################
+# RUN_TRANSACTION applies the pending change before running its commands, so
+# that criteria match the current title.
+################################################################################
+
+$window->name('Transaction title');
+wait_until_handled($second_marker);
+
+is(scalar received_title_events(), 0, 'no title event while coalescing');
+
+my $i3_cmd = i3(get_socket_path(0));
+$i3_cmd->connect->recv;
+
+# TODO: use the symbolic name for the command/reply type instead of the
+# numerical 15:
+my $reply = $i3_cmd->message(15, [ '[title="^Transaction title$"] mark coalesced' ])->recv;
+ok($reply->[0]->[0]->{success}, 'transaction succeeded');
+
+@events = received_title_events();
+is(scalar @events, 1, 'received one title event from the transaction');
+is($events[0]->{container}->{name}, 'Transaction title', 'event carries the new title');
+
+my ($node) = grep { $_->{window} == $window->id } @{get_ws_content(focused_ws)};
+is_deeply($node->{marks}, [ 'coalesced' ], 'criteria matched the new title');
+
+done_testing;